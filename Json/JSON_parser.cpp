@@ -521,6 +521,26 @@ new_JSON_parser(JSON_config* config)
 	return jc;
 }
 
+void JSON_parser_reset(JSON_parser jc, void* callback_ctx)
+{
+	/* keep configuration and current (static or grown) stack and parse buffers */
+	jc->ctx = callback_ctx;
+	jc->state = GO;
+	jc->before_comment_state = 0;
+	jc->type = JSON_T_NONE;
+	jc->escaped = 0;
+	jc->comment = 0;
+	jc->error = JSON_E_NONE;
+	jc->utf16_high_surrogate = 0;
+	jc->current_char = 0;
+
+	/* set parser to start, the stack always has room for one mode */
+	jc->top = 0;
+	jc->stack[0] = MODE_DONE;
+
+	parse_buffer_clear(jc);
+}
+
 static int parse_buffer_grow(JSON_parser jc)
 {
 	const size_t bytes_to_copy = jc->parse_buffer_count * sizeof(jc->parse_buffer[0]);
@@ -141,6 +141,15 @@ JSON_PARSER_DLL_API extern JSON_parser new_JSON_parser(JSON_config* config);
 /*! @brief Destroy a previously created JSON parser object. */
 JSON_PARSER_DLL_API extern void delete_JSON_parser(JSON_parser jc);
 
+/*! @brief Reset a parser to parse a new JSON text.
+
+	The configuration and the buffers already allocated are kept, so a parser
+	can be reused without any memory allocation.
+
+	@param callback_ctx The pointer passed to the callback for the new text.
+*/
+JSON_PARSER_DLL_API extern void JSON_parser_reset(JSON_parser jc, void* callback_ctx);
+
 /*! @brief Parse a character.
 
 	@return Non-zero, if all characters passed to this function are part of are valid JSON.
@@ -19,6 +19,11 @@ namespace json_spirit
 	//
 	bool read( const std::string& s, Value& value );
 	bool read( std::istream& is,     Value& value );
+
+	// same as read but overwrites value in place: strings and containers of value
+	// are reused, parsing texts with the same shape does not allocate memory
+	//
+	bool read_reusing( const char* s, size_t length, Value& value );
 }
 
 #endif
@@ -36,6 +36,11 @@ namespace json_spirit
 		Value( double             value );
 
 		Value( const Value &val); // copy constructor
+		Value( Value &&val );     // move constructor
+
+		// copy and move assignment, val may be a part of this value
+		Value& operator=( Value val );
+		void swap( Value& val );
 
 		bool operator==( const Value& lhs ) const;
 
@@ -59,10 +64,24 @@ namespace json_spirit
 		Object& get_obj();
 		Array&  get_array();
 
+		// in place modifiers, the internal string and containers keep their
+		// capacity (and their content for set_obj_type/set_array_type) to be
+		// overwritten without memory allocation, the content of the previous
+		// type is cleared when the type changes
+		void set_str( const char* value, size_t length );
+		void set_bool( bool value );
+		void set_int( int value );
+		void set_real( double value );
+		void set_null();
+		Object& set_obj_type();
+		Array&  set_array_type();
+
 		static const Value null;
 
 	private:
 
+		void set_type( Value_type type );
+
 		Value_type type_;
 
 		std::string str_;
@@ -364,6 +364,12 @@ bool json_spirit::read( std::istream& is, Value& value )
 	return read( s, value );
 }
 
+bool json_spirit::read_reusing( const char* s, size_t length, Value& value )
+{
+	// no in place parsing with spirit
+	return read( std::string( s, length ), value );
+}
+
 #else // USE_BOOST_SPIRIT
 
 #include <Json/JSON_parser.h>
@@ -474,6 +480,209 @@ int json_calback(void* ctx, int type, const JSON_value* value)
   return 1;
 }
 
+namespace
+{
+	// this class's methods get called by the JSON_parser, the value
+	// is overwritten in place instead of being rebuilt
+	//
+	class Reuse_semantic_actions
+	{
+	public:
+
+		Reuse_semantic_actions()
+		:   value_p( 0 )
+		{
+		}
+
+		void start( Value& value )
+		{
+			value_p = &value;
+			stack_.clear();
+		}
+
+		void begin_compound( Value_type type );
+		void end_compound();
+		void new_name( const char* str, size_t length ) { name_.assign( str, length ); }
+		Value& next_value();
+
+	private:
+
+		struct Compound
+		{
+			Value* value_p;
+			size_t count_;      // number of values already set in this compound
+		};
+
+		Value* value_p;             // the root value
+		vector< Compound > stack_;  // compounds being overwritten
+		string name_;               // of current name/value pair
+	};
+
+	Value& Reuse_semantic_actions::next_value()
+	{
+		if( stack_.empty() )
+		{
+			return *value_p;
+		}
+
+		Compound& current = stack_.back();
+
+		if( current.value_p->type() == array_type )
+		{
+			Array& values = current.value_p->get_array();
+
+			if( current.count_ == values.size() )
+			{
+				values.push_back( Value() );
+			}
+			return values[ current.count_++ ];
+		}
+
+		Object& pairs = current.value_p->get_obj();
+
+		if( current.count_ == pairs.size() )
+		{
+			pairs.push_back( Pair( name_, Value() ) );
+		}
+		else
+		{
+			pairs[ current.count_ ].name_.assign( name_ );
+		}
+		return pairs[ current.count_++ ].value_;
+	}
+
+	void Reuse_semantic_actions::begin_compound( Value_type type )
+	{
+		Value& value = next_value();
+
+		if( type == array_type )
+		{
+			value.set_array_type();
+		}
+		else
+		{
+			value.set_obj_type();
+		}
+
+		Compound compound = { &value, 0 };
+		stack_.push_back( compound );
+	}
+
+	void Reuse_semantic_actions::end_compound()
+	{
+		Compound& current = stack_.back();
+
+		// remove values left from the previous content
+		if( current.value_p->type() == array_type )
+		{
+			Array& values = current.value_p->get_array();
+			values.erase( values.begin() + current.count_, values.end() );
+		}
+		else
+		{
+			Object& pairs = current.value_p->get_obj();
+			pairs.erase( pairs.begin() + current.count_, pairs.end() );
+		}
+
+		stack_.pop_back();
+	}
+
+	int json_reuse_callback( void* ctx, int type, const JSON_value* value )
+	{
+		Reuse_semantic_actions * semantic_actions = static_cast<Reuse_semantic_actions *>(ctx);
+
+		switch(type) {
+		case JSON_T_ARRAY_BEGIN:
+			semantic_actions->begin_compound( array_type );
+			break;
+		case JSON_T_OBJECT_BEGIN:
+			semantic_actions->begin_compound( obj_type );
+			break;
+		case JSON_T_ARRAY_END:
+		case JSON_T_OBJECT_END:
+			semantic_actions->end_compound();
+			break;
+		case JSON_T_INTEGER:
+			semantic_actions->next_value().set_int( (int)value->vu.integer_value );
+			break;
+		case JSON_T_FLOAT:
+			semantic_actions->next_value().set_real( value->vu.float_value );
+			break;
+		case JSON_T_NULL:
+			semantic_actions->next_value().set_null();
+			break;
+		case JSON_T_TRUE:
+			semantic_actions->next_value().set_bool( true );
+			break;
+		case JSON_T_FALSE:
+			semantic_actions->next_value().set_bool( false );
+			break;
+		case JSON_T_KEY:
+			semantic_actions->new_name( value->vu.str.value, value->vu.str.length );
+			break;
+		case JSON_T_STRING:
+			semantic_actions->next_value().set_str( value->vu.str.value, value->vu.str.length );
+			break;
+		default:
+			break;
+		}
+		return 1;
+	}
+
+	// one parser and its buffers per thread, kept between calls
+	class Reuse_reader
+	{
+	public:
+
+		Reuse_reader()
+		{
+			JSON_config config;
+			init_JSON_config(&config);
+			config.callback = &json_reuse_callback;
+			config.callback_ctx = static_cast<void*>(&semantic_actions_);
+			parser_ = new_JSON_parser(&config);
+		}
+
+		~Reuse_reader()
+		{
+			delete_JSON_parser(parser_);
+		}
+
+		bool read( const char* s, size_t length, Value& value )
+		{
+			semantic_actions_.start( value );
+			JSON_parser_reset( parser_, static_cast<void*>(&semantic_actions_) );
+
+			for( size_t i = 0; i < length; i++ )
+			{
+				const int next_char = (unsigned char)s[i];
+				if( next_char == 0 )
+				{
+					break;
+				}
+				if( !JSON_parser_char( parser_, next_char ) )
+				{
+					return false;
+				}
+			}
+
+			return JSON_parser_done( parser_ ) != 0;
+		}
+
+	private:
+
+		Reuse_semantic_actions semantic_actions_;
+		struct JSON_parser_struct* parser_;
+	};
+}
+
+bool json_spirit::read_reusing( const char* s, size_t length, Value& value )
+{
+	static thread_local Reuse_reader reader;
+
+	return reader.read( s, length, value );
+}
+
 
 #endif // USE_BOOST_SPIRIT
 
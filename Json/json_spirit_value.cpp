@@ -6,6 +6,7 @@
 #include <Json/json_spirit_value.h>
 
 #include <cassert>
+#include <utility>
 
 using namespace json_spirit;
 
@@ -27,6 +28,35 @@ Value::Value( const Value &val)
 {
 }
 
+Value::Value( Value &&val )
+  : type_(val.type_)
+  , str_(std::move(val.str_))
+  , obj_(std::move(val.obj_))
+  , array_(std::move(val.array_))
+  , bool_(val.bool_)
+  , i_(val.i_)
+  , d_(val.d_)
+{
+	val.type_ = null_type;
+}
+
+Value& Value::operator=( Value val )
+{
+	swap( val );
+	return *this;
+}
+
+void Value::swap( Value& val )
+{
+	std::swap( type_, val.type_ );
+	str_.swap( val.str_ );
+	obj_.swap( val.obj_ );
+	array_.swap( val.array_ );
+	std::swap( bool_, val.bool_ );
+	std::swap( i_, val.i_ );
+	std::swap( d_, val.d_ );
+}
+
 Value::Value( const char* value )
 :   type_( str_type )
 ,   str_( value )
@@ -155,6 +185,66 @@ Array& Value::get_array()
 	return array_;
 }
 
+void Value::set_type( Value_type type )
+{
+	if( type_ == type ) return;
+
+	// the payload of the previous type must not stay behind the new one,
+	// clear keeps the capacity for a later reuse
+	switch( type_ )
+	{
+		case str_type:   str_.clear();   break;
+		case obj_type:   obj_.clear();   break;
+		case array_type: array_.clear(); break;
+		default: break;
+	}
+
+	type_ = type;
+}
+
+void Value::set_str( const char* value, size_t length )
+{
+	set_type( str_type );
+	str_.assign( value, length );
+}
+
+void Value::set_bool( bool value )
+{
+	set_type( bool_type );
+	bool_ = value;
+}
+
+void Value::set_int( int value )
+{
+	set_type( int_type );
+	i_    = value;
+}
+
+void Value::set_real( double value )
+{
+	set_type( real_type );
+	d_    = value;
+}
+
+void Value::set_null()
+{
+	set_type( null_type );
+}
+
+Object& Value::set_obj_type()
+{
+	set_type( obj_type );
+
+	return obj_;
+}
+
+Array& Value::set_array_type()
+{
+	set_type( array_type );
+
+	return array_;
+}
+
 Pair::Pair( const std::string& name, const Value& value )
 :   name_( name )
 ,   value_( value )
@@ -0,0 +1,531 @@
+/**
+ * @file Messaging/Benchmarks/MessagingBenchmark.cpp
+ * @ingroup Messaging
+ * @brief Time and allocation cost of the Messaging API
+ *
+ * Usage: OmiscidMessagingBenchmark [-i Iterations] [-o Results.json] [-b Baseline.json] [-t ThresholdPercent]
+ *
+ * - -i: number of calls per benchmark (default 20000, containers use one tenth of it)
+ * - -o: save results, to be used later as a baseline
+ * - -b: compare to a baseline, exit code is 1 if a benchmark is slower or
+ *   allocates more than the baseline plus the threshold (default 10%)
+ *
+ * Allocations are only counted if the program is built with OMISCID_COUNT_ALLOCATIONS
+ * (set OMISCID_BUILD_MESSAGING_BENCHMARK=ON in cmake, see OmiscidConfig.cmake).
+ *
+ * The Idl:: benchmarks use the structures generated from BenchmarkMessages.json,
+ * with the same content as the Serializable objects, to compare both codecs.
+ */
+
+#include <System/AllocationCounter.h>
+#include <System/ElapsedTime.h>
+#include <System/SimpleList.h>
+#include <System/SimpleString.h>
+
+#include <Messaging/Serializable.h>
+#include <Messaging/SerializeValue.h>
+#include <Messaging/StructuredMessage.h>
+
+#include "BenchmarkMessages.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	// Representative objects
+
+	class FlatObject : public Serializable
+	{
+	public:
+		FlatObject()
+			: Id(42), X(1.25), Y(-3.5), Z(0.5f), Valid(true), Name("flat object")
+		{
+		}
+
+		virtual void DeclareSerializeMapping()
+		{
+			AddVarToSerialization( Id );
+			AddVarToSerialization( X );
+			AddVarToSerialization( Y );
+			AddVarToSerialization( Z );
+			AddVarToSerialization( Valid );
+			AddVarToSerialization( Name );
+		}
+
+		int Id;
+		double X;
+		double Y;
+		float Z;
+		bool Valid;
+		SimpleString Name;
+	};
+
+	class NestedObject : public Serializable
+	{
+	public:
+		NestedObject()
+			: Level(3), Label("nested object")
+		{
+		}
+
+		virtual void DeclareSerializeMapping()
+		{
+			AddVarToSerialization( Level );
+			AddVarToSerialization( Label );
+			AddVarToSerialization( Position );
+			AddVarToSerialization( Target );
+		}
+
+		int Level;
+		SimpleString Label;
+		FlatObject Position;
+		FlatObject Target;
+	};
+
+	class ContainerObject : public Serializable
+	{
+	public:
+		ContainerObject()
+		{
+			for( int i = 0; i < 1000; i++ )
+			{
+				Samples.push_back( i * 0.001 );
+				Indexes.push_back( i );
+				Ids.AddTail( i * 3 );
+				Flags.push_back( i % 7 );
+			}
+		}
+
+		virtual void DeclareSerializeMapping()
+		{
+			AddVarToSerialization( Samples );
+			AddVarToSerialization( Indexes );
+			AddVarToSerialization( Ids );
+			AddVarToSerialization( Flags );
+		}
+
+		std::vector<double> Samples;
+		std::vector<int> Indexes;
+		SimpleList<int> Ids;
+		std::list<int> Flags;
+	};
+
+	// Same content in the generated structures
+
+	void CopyTo( const FlatObject& Source, BenchmarkMessages::Flat& Destination )
+	{
+		Destination.Id = Source.Id;
+		Destination.X = Source.X;
+		Destination.Y = Source.Y;
+		Destination.Z = Source.Z;
+		Destination.Valid = Source.Valid;
+		Destination.Name = Source.Name;
+	}
+
+	void CopyTo( const NestedObject& Source, BenchmarkMessages::Nested& Destination )
+	{
+		Destination.Level = Source.Level;
+		Destination.Label = Source.Label;
+		CopyTo( Source.Position, Destination.Position );
+		CopyTo( Source.Target, Destination.Target );
+	}
+
+	void CopyTo( ContainerObject& Source, BenchmarkMessages::Containers& Destination )
+	{
+		Destination.Samples = Source.Samples;
+		Destination.Indexes = Source.Indexes;
+		Destination.Ids.clear();
+		for( Source.Ids.First(); Source.Ids.NotAtEnd(); Source.Ids.Next() )
+		{
+			Destination.Ids.push_back( Source.Ids.GetCurrent() );
+		}
+		Destination.Flags.assign( Source.Flags.begin(), Source.Flags.end() );
+	}
+
+	// Measures
+
+	struct BenchmarkResult
+	{
+		std::string Name;
+		double NanosecondsPerOperation;
+		double AllocationsPerOperation;
+		double BytesPerOperation;
+	};
+
+	const int NbRounds = 3;
+
+	template <typename OPERATION>
+	BenchmarkResult RunBenchmark( const char * Name, size_t Iterations, OPERATION Operation )
+	{
+		// Warm up, first calls build mappings and caches
+		for( size_t i = 0; i < 10; i++ )
+		{
+			Operation();
+		}
+
+		// Best of several rounds, to reduce the noise of other processes
+		double Seconds = 0.0;
+		AllocationCounter::Counts Cost;
+		for( int Round = 0; Round < NbRounds; Round++ )
+		{
+			AllocationCounter::Counts Before = AllocationCounter::GetCounts();
+			PerfElapsedTime Timer;
+			for( size_t i = 0; i < Iterations; i++ )
+			{
+				Operation();
+			}
+			const double RoundSeconds = Timer.GetInSeconds();
+			Cost = AllocationCounter::GetCounts() - Before;
+
+			if ( Round == 0 || RoundSeconds < Seconds )
+			{
+				Seconds = RoundSeconds;
+			}
+		}
+
+		BenchmarkResult Result;
+		Result.Name = Name;
+		Result.NanosecondsPerOperation = Seconds * 1e9 / (double)Iterations;
+		Result.AllocationsPerOperation = (double)Cost.Allocations / (double)Iterations;
+		Result.BytesPerOperation = (double)Cost.AllocatedBytes / (double)Iterations;
+
+		printf( "%-46s %12.1f ns/op %10.1f allocs/op %12.1f bytes/op\n", Name,
+			Result.NanosecondsPerOperation, Result.AllocationsPerOperation, Result.BytesPerOperation );
+		fflush( stdout );
+
+		return Result;
+	}
+
+	// Keep results alive so the compiler does not remove the calls
+	volatile size_t Sink = 0;
+
+	// Generated codec of a message, to compare with the Name::* Serializable benchmarks
+	template <typename MESSAGE>
+	void RunIdlBenchmarks( std::vector<BenchmarkResult>& Results, const std::string& Name, size_t Iterations, MESSAGE& Message )
+	{
+		const SerializeValue Value = Message.Serialize();
+		const SimpleString Text = StructuredMessage( Value ).GetText( false );
+		std::string Binary;
+		Message.EncodeBinary( Binary );
+
+		json_spirit::Value ReusedValue;
+		std::string ReusedBuffer;
+		StructuredMessage ReusedMessage;
+
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::Serialize").c_str(), Iterations, [&]() { Sink += Message.Serialize().type(); } ) );
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::SerializeInto").c_str(), Iterations, [&]()
+		{
+			Message.SerializeInto( ReusedValue );
+			Sink += ReusedValue.type();
+		} ) );
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::Unserialize(SerializeValue)").c_str(), Iterations, [&]() { Message.Unserialize( Value ); } ) );
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::Unserialize(Text)").c_str(), Iterations, [&]()
+		{
+			ReusedMessage.ParseInto( Text );
+			Message.FromStructuredMessage( ReusedMessage );
+		} ) );
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::EncodeBinary").c_str(), Iterations, [&]()
+		{
+			ReusedBuffer.clear();
+			Message.EncodeBinary( ReusedBuffer );
+			Sink += ReusedBuffer.size();
+		} ) );
+		Results.push_back( RunBenchmark( ("Idl::" + Name + "::DecodeBinary").c_str(), Iterations, [&]() { Message.DecodeBinary( Binary.data(), Binary.size() ); } ) );
+	}
+
+	std::vector<BenchmarkResult> RunAll( size_t Iterations )
+	{
+		std::vector<BenchmarkResult> Results;
+		const size_t ContainerIterations = Iterations/10 > 0 ? Iterations/10 : 1;
+
+		FlatObject Flat;
+		NestedObject Nested;
+		ContainerObject Containers;
+
+		const SerializeValue FlatValue = Flat.Serialize();
+		const SerializeValue NestedValue = Nested.Serialize();
+		const SerializeValue ContainersValue = Containers.Serialize();
+		const SimpleString FlatText = StructuredMessage( FlatValue ).GetText( false );
+		const SimpleString NestedText = StructuredMessage( NestedValue ).GetText( false );
+		const SimpleString ContainersText = StructuredMessage( ContainersValue ).GetText( false );
+
+		// Serializable
+		Results.push_back( RunBenchmark( "Flat::Serialize", Iterations, [&]() { Sink += Flat.Serialize().type(); } ) );
+		Results.push_back( RunBenchmark( "Flat::Unserialize(SerializeValue)", Iterations, [&]() { Flat.Unserialize( FlatValue ); } ) );
+		Results.push_back( RunBenchmark( "Flat::Unserialize(Text)", Iterations, [&]() { Flat.Unserialize( FlatText ); } ) );
+		Results.push_back( RunBenchmark( "Nested::Serialize", Iterations, [&]() { Sink += Nested.Serialize().type(); } ) );
+		Results.push_back( RunBenchmark( "Nested::Unserialize(SerializeValue)", Iterations, [&]() { Nested.Unserialize( NestedValue ); } ) );
+		Results.push_back( RunBenchmark( "Nested::Unserialize(Text)", Iterations, [&]() { Nested.Unserialize( NestedText ); } ) );
+		Results.push_back( RunBenchmark( "Containers::Serialize", ContainerIterations, [&]() { Sink += Containers.Serialize().type(); } ) );
+		Results.push_back( RunBenchmark( "Containers::Unserialize(SerializeValue)", ContainerIterations, [&]() { Containers.Unserialize( ContainersValue ); } ) );
+		Results.push_back( RunBenchmark( "Containers::Unserialize(Text)", ContainerIterations, [&]() { Containers.Unserialize( ContainersText ); } ) );
+
+		// Generated codecs
+		BenchmarkMessages::Flat IdlFlat;
+		BenchmarkMessages::Nested IdlNested;
+		BenchmarkMessages::Containers IdlContainers;
+		CopyTo( Flat, IdlFlat );
+		CopyTo( Nested, IdlNested );
+		CopyTo( Containers, IdlContainers );
+		RunIdlBenchmarks( Results, "Flat", Iterations, IdlFlat );
+		RunIdlBenchmarks( Results, "Nested", Iterations, IdlNested );
+		RunIdlBenchmarks( Results, "Containers", ContainerIterations, IdlContainers );
+
+		// StructuredMessage
+		Results.push_back( RunBenchmark( "StructuredMessage::Put", Iterations, [&]()
+		{
+			StructuredMessage Msg;
+			Msg.Put( "id", SerializeValue( 12 ) );
+			Msg.Put( "x", SerializeValue( 1.5 ) );
+			Msg.Put( "valid", SerializeValue( true ) );
+			Msg.Put( "name", SerializeValue( json_spirit::Value( std::string("structured message") ) ) );
+			Sink += Msg.GetValue().type();
+		} ) );
+		const StructuredMessage FlatMessage( FlatValue );
+		Results.push_back( RunBenchmark( "StructuredMessage::FindAndGetValue", Iterations, [&]()
+		{
+			Sink += FlatMessage.FindAndGetValue( "Name" ).type();
+			Sink += FlatMessage.FindAndGetValue( "Valid" ).type();
+		} ) );
+		Results.push_back( RunBenchmark( "StructuredMessage::TryFind", Iterations, [&]()
+		{
+			Sink += FlatMessage.TryFind( "Name" )->type();
+			Sink += FlatMessage.TryFind( "Valid" )->type();
+		} ) );
+		Results.push_back( RunBenchmark( "StructuredMessage::GetText", Iterations, [&]()
+		{
+			// New message each time, GetText would be served by the text cache otherwise
+			StructuredMessage Msg( NestedValue );
+			Sink += Msg.GetText( false ).GetLength();
+		} ) );
+		Results.push_back( RunBenchmark( "StructuredMessage(Text)", Iterations, [&]()
+		{
+			StructuredMessage Msg( NestedText );
+			Sink += Msg.GetValue().type();
+		} ) );
+		// Same parsing in a message kept between calls, no allocation after warm up
+		StructuredMessage ReusedMessage;
+		Results.push_back( RunBenchmark( "StructuredMessage::ParseInto", Iterations, [&]()
+		{
+			ReusedMessage.ParseInto( NestedText );
+			Sink += ReusedMessage.GetValue().type();
+		} ) );
+
+		// Container helpers
+		Results.push_back( RunBenchmark( "SerializeStdVector<int>", ContainerIterations, [&]() { Sink += SerializeStdVector( Containers.Indexes ).type(); } ) );
+		const SerializeValue IndexesValue = SerializeStdVector( Containers.Indexes );
+		Results.push_back( RunBenchmark( "UnserializeStdVector<int>", ContainerIterations, [&]() { UnserializeStdVectorFromAddress( IndexesValue, &Containers.Indexes ); } ) );
+		Results.push_back( RunBenchmark( "SerializeSimpleList<int>", ContainerIterations, [&]() { Sink += SerializeSimpleList( Containers.Ids ).type(); } ) );
+		const SerializeValue IdsValue = SerializeSimpleList( Containers.Ids );
+		Results.push_back( RunBenchmark( "UnserializeSimpleList<int>", ContainerIterations, [&]() { UnserializeSimpleListFromAddress( IdsValue, &Containers.Ids ); } ) );
+
+		return Results;
+	}
+
+	// Results file
+
+	void SaveResults( const std::vector<BenchmarkResult>& Results, const char * FileName )
+	{
+		SerializeArray Benchmarks;
+		for( size_t i = 0; i < Results.size(); i++ )
+		{
+			StructuredMessage Entry;
+			Entry.Put( "Name", SerializeValue( json_spirit::Value( Results[i].Name ) ) );
+			Entry.Put( "NsPerOp", SerializeValue( Results[i].NanosecondsPerOperation ) );
+			Entry.Put( "AllocsPerOp", SerializeValue( Results[i].AllocationsPerOperation ) );
+			Entry.Put( "BytesPerOp", SerializeValue( Results[i].BytesPerOperation ) );
+			Benchmarks.push_back( Entry.GetValue() );
+		}
+
+		StructuredMessage Root;
+		Root.Put( "AllocationsCounted", SerializeValue( AllocationCounter::IsEnabled() ) );
+		Root.Put( "Benchmarks", Benchmarks );
+
+		std::ofstream Output( FileName );
+		Output << Root.GetText( true ).GetStr() << std::endl;
+		if ( Output.fail() )
+		{
+			fprintf( stderr, "Unable to write %s\n", FileName );
+		}
+	}
+
+	bool LoadResults( const char * FileName, std::vector<BenchmarkResult>& Results, bool& AllocationsCounted )
+	{
+		std::ifstream Input( FileName );
+		if ( Input.is_open() == false )
+		{
+			fprintf( stderr, "Unable to read %s\n", FileName );
+			return false;
+		}
+		std::stringstream Text;
+		Text << Input.rdbuf();
+
+		try
+		{
+			StructuredMessage Root( SimpleString( Text.str().c_str() ) );
+
+			AllocationsCounted = false;
+			Root.TryGetValue( "AllocationsCounted", AllocationsCounted );
+
+			const json_spirit::Value * pBenchmarks = Root.TryFind( "Benchmarks" );
+			if ( pBenchmarks == NULL || GetArrayView( *pBenchmarks ) == NULL )
+			{
+				fprintf( stderr, "%s: no Benchmarks array\n", FileName );
+				return false;
+			}
+
+			for( size_t i = 0; TryGetElement( *pBenchmarks, i ) != NULL; i++ )
+			{
+				const json_spirit::Value& Entry = *TryGetElement( *pBenchmarks, i );
+				const json_spirit::Value * pName = TryFindMember( Entry, "Name" );
+				const json_spirit::Value * pTime = TryFindMember( Entry, "NsPerOp" );
+				const json_spirit::Value * pAllocs = TryFindMember( Entry, "AllocsPerOp" );
+				const json_spirit::Value * pBytes = TryFindMember( Entry, "BytesPerOp" );
+
+				BenchmarkResult Result;
+				if ( pName == NULL || GetStringView( *pName ) == NULL || pTime == NULL || GetNumberAs( *pTime, Result.NanosecondsPerOperation ) == false ||
+					pAllocs == NULL || GetNumberAs( *pAllocs, Result.AllocationsPerOperation ) == false ||
+					pBytes == NULL || GetNumberAs( *pBytes, Result.BytesPerOperation ) == false )
+				{
+					fprintf( stderr, "%s: malformed entry %u\n", FileName, (unsigned int)i );
+					return false;
+				}
+				Result.Name = *GetStringView( *pName );
+				Results.push_back( Result );
+			}
+		}
+		catch( SimpleException& e )
+		{
+			fprintf( stderr, "%s: %s\n", FileName, e.msg.GetStr() );
+			return false;
+		}
+
+		return true;
+	}
+
+	// Return the number of regressions
+	int CompareResults( const std::vector<BenchmarkResult>& Results, const std::vector<BenchmarkResult>& Baseline,
+		bool CompareAllocations, double ThresholdPercent )
+	{
+		const double Factor = 1.0 + ThresholdPercent/100.0;
+		int NbRegressions = 0;
+
+		printf( "\nComparison to baseline (threshold %.1f%%):\n", ThresholdPercent );
+		for( size_t i = 0; i < Results.size(); i++ )
+		{
+			size_t j;
+			for( j = 0; j < Baseline.size(); j++ )
+			{
+				if ( Baseline[j].Name == Results[i].Name )
+				{
+					break;
+				}
+			}
+			if ( j == Baseline.size() )
+			{
+				printf( "%-46s not in baseline\n", Results[i].Name.c_str() );
+				continue;
+			}
+
+			const BenchmarkResult& Base = Baseline[j];
+			const bool SlowerThanBase = Results[i].NanosecondsPerOperation > Base.NanosecondsPerOperation * Factor;
+			// Allocation counts are deterministic, tolerate rounding only
+			const bool MoreAllocations = CompareAllocations &&
+				Results[i].AllocationsPerOperation > Base.AllocationsPerOperation * Factor + 0.01;
+
+			printf( "%-46s time %+7.1f%%", Results[i].Name.c_str(),
+				Base.NanosecondsPerOperation > 0.0 ? (Results[i].NanosecondsPerOperation/Base.NanosecondsPerOperation - 1.0)*100.0 : 0.0 );
+			if ( CompareAllocations )
+			{
+				printf( "  allocs %10.1f -> %10.1f", Base.AllocationsPerOperation, Results[i].AllocationsPerOperation );
+			}
+			if ( SlowerThanBase || MoreAllocations )
+			{
+				printf( "  REGRESSION" );
+				NbRegressions++;
+			}
+			printf( "\n" );
+		}
+
+		return NbRegressions;
+	}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+	size_t Iterations = 20000;
+	const char * OutputFile = NULL;
+	const char * BaselineFile = NULL;
+	double ThresholdPercent = 10.0;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		if ( i+1 < argc && strcmp( argv[i], "-i" ) == 0 )
+		{
+			Iterations = (size_t)strtoul( argv[++i], NULL, 10 );
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-o" ) == 0 )
+		{
+			OutputFile = argv[++i];
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-b" ) == 0 )
+		{
+			BaselineFile = argv[++i];
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-t" ) == 0 )
+		{
+			ThresholdPercent = strtod( argv[++i], NULL );
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [-i Iterations] [-o Results.json] [-b Baseline.json] [-t ThresholdPercent]\n", argv[0] );
+			return 2;
+		}
+	}
+	if ( Iterations == 0 )
+	{
+		Iterations = 1;
+	}
+
+	if ( AllocationCounter::IsEnabled() == false )
+	{
+		printf( "Allocations are not counted (build without OMISCID_COUNT_ALLOCATIONS)\n" );
+	}
+
+	std::vector<BenchmarkResult> Baseline;
+	bool BaselineAllocationsCounted = false;
+	if ( BaselineFile != NULL && LoadResults( BaselineFile, Baseline, BaselineAllocationsCounted ) == false )
+	{
+		return 2;
+	}
+
+	std::vector<BenchmarkResult> Results = RunAll( Iterations );
+
+	if ( OutputFile != NULL )
+	{
+		SaveResults( Results, OutputFile );
+	}
+
+	if ( BaselineFile != NULL )
+	{
+		const bool CompareAllocations = BaselineAllocationsCounted && AllocationCounter::IsEnabled();
+		int NbRegressions = CompareResults( Results, Baseline, CompareAllocations, ThresholdPercent );
+		if ( NbRegressions > 0 )
+		{
+			printf( "%d regression(s)\n", NbRegressions );
+			return 1;
+		}
+	}
+
+	return 0;
+}
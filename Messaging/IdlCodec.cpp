@@ -0,0 +1,44 @@
+/* @file Messaging/IdlCodec.cpp
+ * @ingroup Messaging
+ * @brief Implementation of IdlCodec class
+ */
+
+#include <Messaging/IdlCodec.h>
+
+using namespace Omiscid;
+
+const json_spirit::Value& IdlCodec::SearchField( const SerializeObject& Object, const char * Name )
+{
+	for( SerializeObjectConstIterator it = Object.begin(); it != Object.end(); ++it )
+	{
+		if ( it->name_ == Name )
+		{
+			return it->value_;
+		}
+	}
+
+	throw SerializeException( SimpleString( "Key not found: ", Name ), SerializeException::UnknownField );
+}
+
+void IdlCodec::ThrowTypeError( const char * Name, const char * ExpectedType )
+{
+	SimpleString Error( "Bad type for field '" );
+	Error += Name;
+	Error += "' (";
+	Error += ExpectedType;
+	Error += " expected)";
+	throw SerializeException( Error, SerializeException::IllegalTypeConversion );
+}
+
+void IdlCodec::ThrowTruncated()
+{
+	throw SerializeException( "Truncated binary message", SerializeException::MalformedStream );
+}
+
+void IdlCodec::CheckFullyRead( const BinaryReader& Reader, size_t Length )
+{
+	if ( Reader.GetPosition() != Length )
+	{
+		throw SerializeException( "Trailing bytes after binary message", SerializeException::MalformedStream );
+	}
+}
@@ -0,0 +1,88 @@
+/* @file Messaging/LockProfileReport.cpp
+ * @ingroup Messaging
+ * @brief Implementation of LockProfileReport class
+ */
+
+#include <Messaging/LockProfileReport.h>
+
+#include <limits.h>
+#include <stdio.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	// json_spirit only has int and double numbers
+	SerializeValue CounterValue( unsigned long long Counter )
+	{
+		if ( Counter <= (unsigned long long)INT_MAX )
+		{
+			return SerializeValue( (int)Counter );
+		}
+		return SerializeValue( (double)Counter );
+	}
+
+	SerializeValue HistogramValue( const unsigned long long * Histogram )
+	{
+		SerializeArray Buckets;
+		Buckets.reserve( LockProfiler::NbHistogramBuckets );
+		for( unsigned int i = 0; i < LockProfiler::NbHistogramBuckets; i++ )
+		{
+			Buckets.push_back( CounterValue(Histogram[i]) );
+		}
+		return SerializeValue( Buckets );
+	}
+
+} // anonymous namespace
+
+StructuredMessage LockProfileReport::ToStructuredMessage()
+{
+	std::vector<LockProfiler::LockReport> Reports;
+	LockProfiler::GetReports( Reports );
+	return ToStructuredMessage( Reports );
+}
+
+StructuredMessage LockProfileReport::ToStructuredMessage( const std::vector<LockProfiler::LockReport>& Reports )
+{
+	SerializeArray Locks;
+	Locks.reserve( Reports.size() );
+
+	for( size_t i = 0; i < Reports.size(); i++ )
+	{
+		const LockProfiler::LockReport& Current = Reports[i];
+
+		SerializeArray CallSites;
+		CallSites.reserve( Current.CallSites.size() );
+		for( size_t j = 0; j < Current.CallSites.size(); j++ )
+		{
+			const LockProfiler::CallSiteReport& Site = Current.CallSites[j];
+
+			char Address[32];
+			snprintf( Address, sizeof(Address), "%p", Site.Address );
+
+			SerializeObject SiteObject;
+			SiteObject.push_back( SerializePair( "Address", SerializeValue(json_spirit::Value(std::string(Address))) ) );
+			SiteObject.push_back( SerializePair( "Symbol", SerializeValue(json_spirit::Value(std::string(Site.Symbol.GetStr()))) ) );
+			SiteObject.push_back( SerializePair( "Waits", CounterValue(Site.Waits) ) );
+			SiteObject.push_back( SerializePair( "WaitTimeNs", CounterValue(Site.WaitTimeNs) ) );
+			CallSites.push_back( SerializeValue(SiteObject) );
+		}
+
+		SerializeObject LockObject;
+		LockObject.push_back( SerializePair( "Name", SerializeValue(json_spirit::Value(std::string(Current.Name.GetStr()))) ) );
+		LockObject.push_back( SerializePair( "Acquisitions", CounterValue(Current.Acquisitions) ) );
+		LockObject.push_back( SerializePair( "ContendedAcquisitions", CounterValue(Current.ContendedAcquisitions) ) );
+		LockObject.push_back( SerializePair( "WaitTimeNs", CounterValue(Current.WaitTimeNs) ) );
+		LockObject.push_back( SerializePair( "SampledHolds", CounterValue(Current.SampledHolds) ) );
+		LockObject.push_back( SerializePair( "HoldTimeNs", CounterValue(Current.HoldTimeNs) ) );
+		LockObject.push_back( SerializePair( "WaitHistogram", HistogramValue(Current.WaitHistogram) ) );
+		LockObject.push_back( SerializePair( "HoldHistogram", HistogramValue(Current.HoldHistogram) ) );
+		LockObject.push_back( SerializePair( "CallSites", SerializeValue(CallSites) ) );
+		Locks.push_back( SerializeValue(LockObject) );
+	}
+
+	StructuredMessage Report;
+	Report.Put( "SamplingPeriod", CounterValue( LockProfiler::GetSamplingPeriod() ) );
+	Report.Put( "Locks", Locks );
+	return Report;
+}
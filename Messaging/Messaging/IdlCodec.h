@@ -0,0 +1,352 @@
+/**
+ * @file Messaging/Messaging/IdlCodec.h
+ * \ingroup Messaging
+ * @brief Runtime support for the code generated by OmiscidIdlCompiler
+ */
+
+#ifndef __IDL_CODEC_H__
+#define __IDL_CODEC_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <System/SimpleString.h>
+
+#include <Messaging/SerializeException.h>
+#include <Messaging/SerializeManager.h>
+#include <Messaging/SerializePackedArray.h>
+
+#include <vector>
+#include <string>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Omiscid {
+
+/**
+ * @class IdlCodec IdlCodec.h Messaging/IdlCodec.h
+ * \ingroup Messaging
+ * @brief Helpers used by the structures generated from a message schema.
+ *
+ * The generated code knows the layout of each message at compile time: fields
+ * are read and written directly, without going through the EncodeMapping table
+ * of Serializable. JSON decoding first looks for a field at its place in the
+ * schema and only searches the whole object if the sender used another order.
+ *
+ * The binary encoding is the list of the fields in schema order, without any
+ * name or tag: 32 bits integers, floats and doubles in little-endian byte order,
+ * one byte for booleans, a 32 bits length before strings and arrays, nested
+ * messages inline.
+ */
+class IdlCodec
+{
+public:
+	// JSON decoding
+
+	/** @brief Find a field of a message, looking first at its place in the schema
+	 * @param Object [in] the message object
+	 * @param Position [in] the index of the field in the schema
+	 * @param Name [in] the field name
+	 * @exception SerializeException (UnknownField) if the field does not exist
+	 */
+	static const json_spirit::Value& FindField( const SerializeObject& Object, size_t Position, const char * Name )
+	{
+		if ( Position < Object.size() && Object[Position].name_ == Name )
+		{
+			return Object[Position].value_;
+		}
+		return SearchField( Object, Name );
+	}
+
+	/** @brief Check that a value is an object
+	 * @exception SerializeException (IllegalTypeConversion) otherwise
+	 */
+	static const SerializeObject& GetObject( const json_spirit::Value& Val, const char * Name )
+	{
+		if ( Val.type() != json_spirit::obj_type )
+		{
+			ThrowTypeError( Name, "object" );
+		}
+		return Val.get_obj();
+	}
+
+	/** @brief Check that a value is an array
+	 * @exception SerializeException (IllegalTypeConversion) otherwise
+	 */
+	static const SerializeArray& GetArray( const json_spirit::Value& Val, const char * Name )
+	{
+		if ( Val.type() != json_spirit::array_type )
+		{
+			ThrowTypeError( Name, "array" );
+		}
+		return Val.get_array();
+	}
+
+	/** @brief Read an integer
+	 * @exception SerializeException (IllegalTypeConversion) if Val is not an integer
+	 */
+	static int GetInt( const json_spirit::Value& Val, const char * Name )
+	{
+		if ( Val.type() != json_spirit::int_type )
+		{
+			ThrowTypeError( Name, "integer" );
+		}
+		return Val.get_int();
+	}
+
+	/** @brief Read a real, integers are accepted
+	 * @exception SerializeException (IllegalTypeConversion) if Val is not a number
+	 */
+	static double GetReal( const json_spirit::Value& Val, const char * Name )
+	{
+		if ( Val.type() != json_spirit::real_type && Val.type() != json_spirit::int_type )
+		{
+			ThrowTypeError( Name, "number" );
+		}
+		return Val.get_real();
+	}
+
+	/** @brief Read a boolean
+	 * @exception SerializeException (IllegalTypeConversion) if Val is not a boolean
+	 */
+	static bool GetBool( const json_spirit::Value& Val, const char * Name )
+	{
+		if ( Val.type() != json_spirit::bool_type )
+		{
+			ThrowTypeError( Name, "boolean" );
+		}
+		return Val.get_bool();
+	}
+
+	/** @brief Read a string
+	 * @exception SerializeException (IllegalTypeConversion) if Val is not a string
+	 */
+	static void GetString( const json_spirit::Value& Val, const char * Name, SimpleString& Result )
+	{
+		if ( Val.type() != json_spirit::str_type )
+		{
+			ThrowTypeError( Name, "string" );
+		}
+		static_cast<std::string&>(Result) = Val.get_str();
+	}
+
+	// JSON encoding, in place: the pairs, strings and arrays of a previous
+	// encoding in the same value are overwritten without memory allocation
+
+	/** @brief Get the value of the field at Position of an object being encoded
+	 * @param Object [in,out] the message object
+	 * @param Position [in] the index of the field in the schema
+	 * @param Name [in] the field name
+	 */
+	static json_spirit::Value& SetField( SerializeObject& Object, size_t Position, const char * Name )
+	{
+		if ( Position == Object.size() )
+		{
+			Object.push_back( SerializePair( Name, json_spirit::Value() ) );
+		}
+		else if ( Object[Position].name_ != Name )
+		{
+			Object[Position].name_.assign( Name );
+		}
+		return Object[Position].value_;
+	}
+
+	/** @brief Remove the fields left after the NbFields of the message */
+	static void EndObject( SerializeObject& Object, size_t NbFields )
+	{
+		if ( Object.size() > NbFields )
+		{
+			Object.erase( Object.begin() + NbFields, Object.end() );
+		}
+	}
+
+	/** @brief Write a string in place */
+	static void SetString( json_spirit::Value& Val, const std::string& Str )
+	{
+		Val.set_str( Str.data(), Str.length() );
+	}
+
+	// Binary encoding
+
+	static void PutInt( std::string& Buffer, int Val )
+	{
+		PutRaw( Buffer, &Val, sizeof(int32_t) );
+	}
+
+	static void PutCount( std::string& Buffer, size_t Count )
+	{
+		const uint32_t Val = (uint32_t)Count;
+		PutRaw( Buffer, &Val, sizeof(Val) );
+	}
+
+	static void PutFloat( std::string& Buffer, float Val )
+	{
+		PutRaw( Buffer, &Val, sizeof(Val) );
+	}
+
+	static void PutDouble( std::string& Buffer, double Val )
+	{
+		PutRaw( Buffer, &Val, sizeof(Val) );
+	}
+
+	static void PutBool( std::string& Buffer, bool Val )
+	{
+		Buffer.push_back( Val ? '\1' : '\0' );
+	}
+
+	static void PutString( std::string& Buffer, const std::string& Val )
+	{
+		PutCount( Buffer, Val.length() );
+		Buffer.append( Val );
+	}
+
+	/** @brief Write a vector of int, float or double as a count and a single block
+	 */
+	template <typename TYPE_NAME> static void PutNumericVector( std::string& Buffer, const std::vector<TYPE_NAME>& Data )
+	{
+		PutCount( Buffer, Data.size() );
+		if ( Data.empty() )
+		{
+			return;
+		}
+
+		const size_t Start = Buffer.length();
+		Buffer.append( (const char*)&Data[0], Data.size()*sizeof(TYPE_NAME) );
+		if ( SerializePackedArray::HostIsLittleEndian() == false )
+		{
+			SerializePackedArray::SwapBytes( (unsigned char*)&Buffer[Start], Data.size(), sizeof(TYPE_NAME) );
+		}
+	}
+
+	/**
+	 * @class BinaryReader IdlCodec.h Messaging/IdlCodec.h
+	 * @brief Cursor over a binary encoded message
+	 */
+	class BinaryReader
+	{
+	public:
+		BinaryReader( const char * Buffer, size_t BufferLength )
+			: Data(Buffer), Length(BufferLength), Position(0)
+		{
+		}
+
+		/** @brief Number of bytes read so far */
+		size_t GetPosition() const
+		{
+			return Position;
+		}
+
+		int GetInt()
+		{
+			int32_t Val;
+			GetRaw( &Val, sizeof(Val) );
+			return (int)Val;
+		}
+
+		size_t GetCount()
+		{
+			uint32_t Val;
+			GetRaw( &Val, sizeof(Val) );
+			// Each element uses at least one byte, reject counts larger than the remaining data
+			if ( (size_t)Val > Length - Position )
+			{
+				ThrowTruncated();
+			}
+			return (size_t)Val;
+		}
+
+		float GetFloat()
+		{
+			float Val;
+			GetRaw( &Val, sizeof(Val) );
+			return Val;
+		}
+
+		double GetDouble()
+		{
+			double Val;
+			GetRaw( &Val, sizeof(Val) );
+			return Val;
+		}
+
+		bool GetBool()
+		{
+			Check( 1 );
+			return Data[Position++] != '\0';
+		}
+
+		void GetString( SimpleString& Result )
+		{
+			const size_t Count = GetCount();
+			static_cast<std::string&>(Result).assign( Data + Position, Count );
+			Position += Count;
+		}
+
+		template <typename TYPE_NAME> void GetNumericVector( std::vector<TYPE_NAME>& Result )
+		{
+			const size_t Count = GetCount();
+			Check( Count*sizeof(TYPE_NAME) );
+			Result.resize( Count );
+			if ( Count == 0 )
+			{
+				return;
+			}
+
+			memcpy( &Result[0], Data + Position, Count*sizeof(TYPE_NAME) );
+			Position += Count*sizeof(TYPE_NAME);
+			if ( SerializePackedArray::HostIsLittleEndian() == false )
+			{
+				SerializePackedArray::SwapBytes( (unsigned char*)&Result[0], Count, sizeof(TYPE_NAME) );
+			}
+		}
+
+	private:
+		void Check( size_t Needed ) const
+		{
+			if ( Needed > Length - Position )
+			{
+				ThrowTruncated();
+			}
+		}
+
+		void GetRaw( void * Result, size_t Size )
+		{
+			Check( Size );
+			memcpy( Result, Data + Position, Size );
+			Position += Size;
+			if ( SerializePackedArray::HostIsLittleEndian() == false )
+			{
+				SerializePackedArray::SwapBytes( (unsigned char*)Result, 1, Size );
+			}
+		}
+
+		const char * Data;
+		size_t Length;
+		size_t Position;
+	};
+
+	/** @brief Check that a whole buffer has been decoded
+	 * @exception SerializeException (MalformedStream) if there are trailing bytes
+	 */
+	static void CheckFullyRead( const BinaryReader& Reader, size_t Length );
+
+private:
+	static void PutRaw( std::string& Buffer, const void * Val, size_t Size )
+	{
+		const size_t Start = Buffer.length();
+		Buffer.append( (const char*)Val, Size );
+		if ( SerializePackedArray::HostIsLittleEndian() == false )
+		{
+			SerializePackedArray::SwapBytes( (unsigned char*)&Buffer[Start], 1, Size );
+		}
+	}
+
+	// Error paths are kept out of line
+	static const json_spirit::Value& SearchField( const SerializeObject& Object, const char * Name );
+	static void ThrowTypeError( const char * Name, const char * ExpectedType );
+	static void ThrowTruncated();
+};
+
+} // Omiscid
+
+#endif // __IDL_CODEC_H__
@@ -0,0 +1,41 @@
+/**
+ * @file Messaging/Messaging/LockProfileReport.h
+ * \ingroup Messaging
+ * @brief Definition of LockProfileReport class
+ */
+
+#ifndef __LOCK_PROFILE_REPORT_H__
+#define __LOCK_PROFILE_REPORT_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <System/LockProfiler.h>
+#include <Messaging/StructuredMessage.h>
+
+namespace Omiscid {
+
+/**
+ * @class LockProfileReport LockProfileReport.h Messaging/LockProfileReport.h
+ * \ingroup Messaging
+ * @brief JSON report of the LockProfiler.
+ *
+ * The message has the form
+ * {"SamplingPeriod":16,"Locks":[{"Name":"...","Acquisitions":...,"ContendedAcquisitions":...,
+ * "WaitTimeNs":...,"SampledHolds":...,"HoldTimeNs":...,"WaitHistogram":[...],"HoldHistogram":[...],
+ * "CallSites":[{"Address":"0x...","Symbol":"...","Waits":...,"WaitTimeNs":...}]}]}
+ * Locks and call sites are sorted by decreasing wait time. Bucket i of the histograms
+ * counts durations in [2^i, 2^(i+1)[ ns. Counters too large for an int are written as reals.
+ */
+class LockProfileReport
+{
+public:
+	/** @brief Build the report from the current statistics of the LockProfiler */
+	static StructuredMessage ToStructuredMessage();
+
+	/** @brief Build the report from statistics got with LockProfiler::GetReports */
+	static StructuredMessage ToStructuredMessage( const std::vector<LockProfiler::LockReport>& Reports );
+};
+
+} // Omiscid
+
+#endif // __LOCK_PROFILE_REPORT_H__
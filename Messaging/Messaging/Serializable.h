@@ -15,10 +15,14 @@
 #include <System/SimpleString.h>
 
 #include <Messaging/SerializeValue.h>
+#include <Messaging/SerializePackedArray.h>
+#include <Messaging/SerializeStream.h>
 #include <Messaging/StructuredMessage.h>
 
 #include <vector>
 #include <list>
+#include <memory>
+#include <atomic>
 
 namespace Omiscid {
 
@@ -27,10 +31,42 @@ class StructuredMessage;
 class Serializable : protected ReentrantMutex {
 public:
 
-	Serializable();
+	/** @brief Concurrency policy of a Serializable object
+	 *
+	 * - LockedAccess: (default) all calls lock the object.
+	 * - UnlockedAccess: no lock at all, for objects used by a single thread.
+	 * - SnapshotAccess: writers lock the object and call PublishSnapshot after
+	 *   updating it. Serialize returns the last published snapshot without
+	 *   locking the object, so readers never block writers.
+	 */
+	enum ConcurrencyPolicy { LockedAccess = 0, UnlockedAccess, SnapshotAccess };
+
+	Serializable( ConcurrencyPolicy Policy = LockedAccess );
 
 	virtual ~Serializable();
 
+	/** @brief Change the concurrency policy. Must be called before sharing the object among threads,
+	 * the policy is read atomically but a call in progress keeps the policy it started with.
+	 */
+	void SetConcurrencyPolicy( ConcurrencyPolicy NewPolicy );
+
+	/** @brief Retrieve the current concurrency policy
+	 */
+	ConcurrencyPolicy GetConcurrencyPolicy() const
+	{
+		return CurrentPolicy.load( std::memory_order_acquire );
+	}
+
+	/** @brief Encode the object and publish the result as the current snapshot.
+	 * Meaningful for the SnapshotAccess policy, called by the writer thread
+	 * after a set of modifications.
+	 */
+	void PublishSnapshot();
+
+	/** @brief Get the last published snapshot, NULL if none.
+	 */
+	std::shared_ptr<const SerializeValue> GetSnapshot() const;
+
 	virtual void DeclareSerializeMapping() = 0;
 
 	virtual void PreSerializableFonction() {};
@@ -60,26 +96,129 @@ public:
 	template <typename CurrentType>
 	void AddToSerialization( const SimpleString& Key, std::list<CurrentType>& Val );
 
+	// Numeric containers, can be encoded as packed arrays
+	void AddToSerialization( const SimpleString& Key, std::vector<float>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, std::vector<double>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, std::vector<int>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, std::vector<short int>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, std::vector<char>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, SimpleList<float>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, SimpleList<double>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, SimpleList<int>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, SimpleList<short int>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+	void AddToSerialization( const SimpleString& Key, SimpleList<char>& Val ) { AddNumericContainerToSerialization( Key, Val ); }
+
+	/** @brief Static variable to define if numeric containers (std::vector and SimpleList of
+	 * float, double, int, short int and char) are encoded as packed arrays (base64 of
+	 * little-endian raw bytes) or as plain arrays. Decoding accepts both forms (default PackNumericContainers=false)
+	 */
+	static bool PackNumericContainers;
+
+	/** @brief Encode the object.
+	 *
+	 * The result is a copy. With the SnapshotAccess policy, use SerializeShared
+	 * to read the published snapshot without copying it.
+	 */
 	SerializeValue Serialize();
+
+	/** @brief Encode the object as a shared read-only value.
+	 *
+	 * With the SnapshotAccess policy, the last published snapshot is returned
+	 * as is, without lock nor copy. Otherwise, the object is encoded as by Serialize.
+	 */
+	std::shared_ptr<const SerializeValue> SerializeShared();
+
+	/** @brief Encode the object directly as JSON text in a stream.
+	 *
+	 * The text is the same as json_spirit::write( Serialize() ) but containers
+	 * are written element by element: neither the whole SerializeValue nor
+	 * the whole text are built in memory. The object stays locked (LockedAccess
+	 * policy) until the last field is written, so a slow stream delays writers.
+	 * The stream is not flushed.
+	 */
+	void SerializeToStream( SerializeStream& Stream );
+
+	/** @brief Encode the object as JSON text to a sink, by chunks of ChunkSize bytes
+	 */
+	void SerializeToSink( SerializeSink& Sink, size_t ChunkSize = SerializeStream::DefaultChunkSize );
+
 	void Unserialize( const SimpleString& SerializedVal );
-	void Unserialize( const SerializeValue& SerializedVal );
+	/** @brief Decode from a value, a SerializeValue or any member or element of it (without copy)
+	 */
+	void Unserialize( const json_spirit::Value& SerializedVal );
 
 	bool PartialUnserializationAllowed = false;
+
+	/** @brief Change tracking mode used by SerializeDelta
+	 *
+	 * - NoDeltaTracking: (default) SerializeDelta encodes all fields.
+	 * - ExplicitDeltaTracking: only fields marked using MarkDirty are encoded.
+	 * - AutomaticDeltaTracking: fields are encoded and compared to the value sent
+	 *   by the previous call to SerializeDelta, only changed ones are kept.
+	 */
+	enum DeltaTrackingMode { NoDeltaTracking = 0, ExplicitDeltaTracking, AutomaticDeltaTracking };
+
+	/** @brief Change the tracking mode. All fields are marked as dirty.
+	 */
+	void SetDeltaTrackingMode( DeltaTrackingMode NewMode );
+
+	/** @brief Retrieve the current tracking mode
+	 */
+	DeltaTrackingMode GetDeltaTrackingMode() const
+	{
+		return CurrentDeltaTrackingMode;
+	}
+
+	/** @brief Mark a field as modified since the last call to SerializeDelta
+	 * @param Key [in] the key of the field
+	 */
+	void MarkDirty( const SimpleString& Key );
+
+	/** @brief Mark all fields as modified, next SerializeDelta will encode all of them
+	 */
+	void MarkAllDirty();
+
+	/** @brief Encode the fields changed since the last call
+	 * @return an object containing only changed keys
+	 */
+	SerializeValue SerializeDelta();
+
+	/** @brief Decode a delta produced by SerializeDelta. Only fields present in the delta are updated.
+	 */
+	void ApplyDelta( const SimpleString& SerializedDelta );
+	void ApplyDelta( const json_spirit::Value& SerializedDelta );
+
 protected:
 
 	/** @brief Callback for the encoding function */
 	typedef SerializeValue (*SerializeFunction)(void *);
 
 	/** @brief Callback for the decoding function */
-	typedef void (*UnserializeFunction)(const SerializeValue&, void *);
+	typedef void (*UnserializeFunction)(const json_spirit::Value&, void *);
 
 	class EncodeMapping
 	{
 	public:
+		EncodeMapping()
+			: FunctionToStream((SerializeStreamFunction)NULL), AcceptedTypes(~0u), Dirty(true)
+		{
+		}
+
+		/** @brief Bit of a JSON type in AcceptedTypes */
+		static unsigned int TypeBit( json_spirit::Value_type Type )
+		{
+			return 1u << Type;
+		}
+
 		SimpleString Key;
 		SerializeFunction FunctionToEncode;
 		UnserializeFunction FunctionToDecode;
+		SerializeStreamFunction FunctionToStream;	/*!< Optional, used by containers to be written element by element */
 		void * AddressOfObject;
+		unsigned int AcceptedTypes;	/*!< JSON types FunctionToDecode accepts (TypeBit), checked before decoding */
+
+		bool Dirty;					/*!< Was this field modified since the last delta */
+		SerializeValue LastEncoded;	/*!< Last value sent in a delta, for AutomaticDeltaTracking */
 
 		inline const char * GetKey()
 		{
@@ -91,20 +230,91 @@ protected:
 			return FunctionToEncode(AddressOfObject);
 		}
 
-		inline void Decode( const SerializeValue &Val )
+		inline bool Accepts( const json_spirit::Value &Val ) const
+		{
+			return (AcceptedTypes & TypeBit(Val.type())) != 0;
+		}
+
+		inline void Decode( const json_spirit::Value &Val )
 		{
 			FunctionToDecode( Val, AddressOfObject );
 		}
+
+		inline void Stream( SerializeStream& Output )
+		{
+			if ( FunctionToStream == (SerializeStreamFunction)NULL )
+			{
+				Output.WriteValue( Encode() );
+				return;
+			}
+			FunctionToStream( Output, AddressOfObject );
+		}
 	};
 
 	SimpleList<EncodeMapping*> SerialiseMapping;
 
+	template <typename CurrentType>
+	void AddNumericContainerToSerialization( const SimpleString& Key, std::vector<CurrentType>& Val );
+
+	template <typename CurrentType>
+	void AddNumericContainerToSerialization( const SimpleString& Key, SimpleList<CurrentType>& Val );
+
+	template <typename CurrentType>
+	static SerializeValue SerializeNumericStdVector( void * pData )
+	{
+		return SerializeNumericStdVectorFromAddress<CurrentType>( (std::vector<CurrentType> *)pData, PackNumericContainers );
+	}
+
+	template <typename CurrentType>
+	static SerializeValue SerializeNumericSimpleList( void * pData )
+	{
+		return SerializeNumericSimpleListFromAddress<CurrentType>( (SimpleList<CurrentType> *)pData, PackNumericContainers );
+	}
+
+	template <typename CurrentType>
+	static void StreamNumericStdVector( SerializeStream& Stream, void * pData )
+	{
+		StreamNumericStdVectorFromAddress<CurrentType>( Stream, (std::vector<CurrentType> *)pData, PackNumericContainers );
+	}
+
+	template <typename CurrentType>
+	static void StreamNumericSimpleList( SerializeStream& Stream, void * pData )
+	{
+		StreamNumericSimpleListFromAddress<CurrentType>( Stream, (SimpleList<CurrentType> *)pData, PackNumericContainers );
+	}
+
 	// Find in local mapping
 	EncodeMapping * Find( const SimpleString& Key );
 
 	// Create in local mapping
 	EncodeMapping * Create( const SimpleString& Key ) throw (SimpleException);
 
+	// Encode all mappings, lock must be handled by caller
+	SerializeValue EncodeMappings();
+
+	// Write all mappings to a stream, lock must be handled by caller
+	void StreamMappings( SerializeStream& Stream );
+
+	// Decode all mappings from an object, lock must be handled by caller
+	void DecodeMappings( const json_spirit::Value& SerializedVal );
+
+	// Decode a delta object, lock must be handled by caller
+	void DecodeDelta( const json_spirit::Value& SerializedDelta );
+
+	// Decode one field, a mistyped field is skipped without exception if partial unserialization is allowed
+	void DecodeField( EncodeMapping * Mapping, const json_spirit::Value& FieldValue );
+
+	std::atomic<ConcurrencyPolicy> CurrentPolicy;	/*!< Read without lock by Serialize */
+	DeltaTrackingMode CurrentDeltaTrackingMode;
+	std::shared_ptr<const SerializeValue> Snapshot;	/*!< Last published snapshot, accessed using atomic functions */
+
+	/** @brief Do we need to lock the object according to the concurrency policy
+	 */
+	inline bool LockIsNeeded() const
+	{
+		return (CurrentPolicy.load( std::memory_order_acquire ) != UnlockedAccess);
+	}
+
 	bool SerializationDeclared;
 	inline void CallDeclareSerializeMappingIfNeeded()
 	{
@@ -123,10 +333,10 @@ protected:
 SerializeValue Serialize( Serializable& Data );
 void Unserialize( const SimpleString& Val, Serializable * pData );
 void Unserialize( const SimpleString& Val, Serializable& Data );
-void Unserialize( const SerializeValue& Val, Serializable * pData );
-void Unserialize( const SerializeValue& Val, Serializable& Data );
+void Unserialize( const json_spirit::Value& Val, Serializable * pData );
+void Unserialize( const json_spirit::Value& Val, Serializable& Data );
 
-inline void UnserializeSerializableFromAddress( const SerializeValue& Val, void * pData )
+inline void UnserializeSerializableFromAddress( const json_spirit::Value& Val, void * pData )
 {
 	Unserialize( Val, (Serializable *)pData );
 }
@@ -135,6 +345,11 @@ inline SerializeValue SerializeSerializableFromAddress( void * pData )
 {
 	return Serialize( *(Serializable*)pData );
 }
+
+inline void StreamSerializableFromAddress( SerializeStream& Stream, void * pData )
+{
+	((Serializable*)pData)->SerializeToStream( Stream );
+}
 
 
 template <typename CurrentType>
@@ -142,7 +357,7 @@ void Serializable::AddToSerialization( const SimpleString& Key, SimpleList<Curre
 {
 	// template SerializeSimpleListFromAddress<CurrentType>( SimpleList<CurrentType> * pAddress );
 
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -153,12 +368,14 @@ void Serializable::AddToSerialization( const SimpleString& Key, SimpleList<Curre
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = (SerializeFunction)SerializeSimpleListFromAddress<CurrentType>;
 	tmpMapping->FunctionToDecode = (UnserializeFunction)UnserializeSimpleListFromAddress<CurrentType>;
+	tmpMapping->FunctionToStream = (SerializeStreamFunction)StreamSimpleListFromAddress<CurrentType>;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::array_type);
 }
 
 template <typename CurrentType>
 void Serializable::AddToSerialization( const SimpleString& Key, std::vector<CurrentType>& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -169,12 +386,14 @@ void Serializable::AddToSerialization( const SimpleString& Key, std::vector<Curr
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = (SerializeFunction)SerializeStdVectorFromAddress<CurrentType>;
 	tmpMapping->FunctionToDecode = (UnserializeFunction)UnserializeStdVectorFromAddress<CurrentType>;
+	tmpMapping->FunctionToStream = (SerializeStreamFunction)StreamStdVectorFromAddress<CurrentType>;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::array_type);
 }
 
 template <typename CurrentType>
 void Serializable::AddToSerialization( const SimpleString& Key, std::list<CurrentType>& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -185,6 +404,46 @@ void Serializable::AddToSerialization( const SimpleString& Key, std::list<Curren
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = (SerializeFunction)SerializeStdListFromAddress<CurrentType>;
 	tmpMapping->FunctionToDecode = (UnserializeFunction)UnserializeStdListFromAddress<CurrentType>;
+	tmpMapping->FunctionToStream = (SerializeStreamFunction)StreamStdListFromAddress<CurrentType>;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::array_type);
+}
+
+template <typename CurrentType>
+void Serializable::AddNumericContainerToSerialization( const SimpleString& Key, std::vector<CurrentType>& Val )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	// Check if SerializeMappingIsDone
+	CallDeclareSerializeMappingIfNeeded();
+
+	Serializable::EncodeMapping * tmpMapping = Create( Key );
+
+	// Fill (new) structure
+	tmpMapping->AddressOfObject = (void*)&Val;
+	tmpMapping->FunctionToEncode = (SerializeFunction)SerializeNumericStdVector<CurrentType>;
+	tmpMapping->FunctionToDecode = (UnserializeFunction)UnserializeNumericStdVectorFromAddress<CurrentType>;
+	tmpMapping->FunctionToStream = (SerializeStreamFunction)StreamNumericStdVector<CurrentType>;
+	// Plain or packed arrays
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::array_type) | EncodeMapping::TypeBit(json_spirit::str_type) | EncodeMapping::TypeBit(json_spirit::null_type);
+}
+
+template <typename CurrentType>
+void Serializable::AddNumericContainerToSerialization( const SimpleString& Key, SimpleList<CurrentType>& Val )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	// Check if SerializeMappingIsDone
+	CallDeclareSerializeMappingIfNeeded();
+
+	Serializable::EncodeMapping * tmpMapping = Create( Key );
+
+	// Fill (new) structure
+	tmpMapping->AddressOfObject = (void*)&Val;
+	tmpMapping->FunctionToEncode = (SerializeFunction)SerializeNumericSimpleList<CurrentType>;
+	tmpMapping->FunctionToDecode = (UnserializeFunction)UnserializeNumericSimpleListFromAddress<CurrentType>;
+	tmpMapping->FunctionToStream = (SerializeStreamFunction)StreamNumericSimpleList<CurrentType>;
+	// Plain or packed arrays
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::array_type) | EncodeMapping::TypeBit(json_spirit::str_type) | EncodeMapping::TypeBit(json_spirit::null_type);
 }
 
 } // Omiscid
@@ -0,0 +1,85 @@
+/**
+ * @file Messaging/Messaging/SerializeBatch.h
+ * \ingroup Messaging
+ * @brief Definition of SerializeBatch class
+ */
+
+#ifndef __SERIALIZE_BATCH_H__
+#define __SERIALIZE_BATCH_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <System/SimpleString.h>
+
+#include <Messaging/Serializable.h>
+#include <Messaging/SerializeValue.h>
+
+#include <vector>
+
+namespace Omiscid {
+
+/**
+ * @class SerializeBatch SerializeBatch.h Messaging/SerializeBatch.h
+ * \ingroup Messaging
+ * @brief Parallel encoding and decoding of collections of Serializable objects.
+ *
+ * Objects are split in contiguous ranges, one per thread, executed by the
+ * shared ThreadPool (see ThreadPool#GetSharedPool) and the calling thread. Each worker
+ * writes to its own slots (array output) or to its own text buffer (NDJSON
+ * output), so the result keeps the order of the input without any lock
+ * between workers. Objects of a batch must be distinct: the same object
+ * must not appear twice in one call.
+ *
+ * If an object throws while encoding or decoding, the remaining work
+ * is completed and the first exception (in object order) is rethrown to the caller.
+ */
+class SerializeBatch
+{
+public:
+	/** @brief Number of threads used when 0 is given (number of cores)
+	 */
+	static unsigned int DefaultNumberOfThreads();
+
+	/** @brief Minimal number of objects per worker, smaller batches use less threads (default 64)
+	 */
+	static size_t MinimalObjectsPerThread;
+
+	/** @brief Encode objects as a single array of objects
+	 * @param Objects [in] the objects to encode
+	 * @param NbObjects [in] the number of objects
+	 * @param NbThreads [in] the maximal number of threads, 0 for DefaultNumberOfThreads()
+	 * @return an array with one serialized object per input object, in the same order
+	 */
+	static SerializeValue SerializeAll( Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads = 0 );
+	static SerializeValue SerializeAll( const std::vector<Serializable*>& Objects, unsigned int NbThreads = 0 );
+
+	/** @brief Encode objects as NDJSON text (one compact JSON object per line)
+	 * @param Objects [in] the objects to encode
+	 * @param NbObjects [in] the number of objects
+	 * @param NbThreads [in] the maximal number of threads, 0 for DefaultNumberOfThreads()
+	 */
+	static SimpleString SerializeAllToNDJSON( Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads = 0 );
+	static SimpleString SerializeAllToNDJSON( const std::vector<Serializable*>& Objects, unsigned int NbThreads = 0 );
+
+	/** @brief Decode an array of objects into pre-allocated objects
+	 * @param SerializedArray [in] an array with exactly NbObjects serialized objects
+	 * @param Objects [in,out] the objects to fill, in array order
+	 * @param NbObjects [in] the number of objects
+	 * @param NbThreads [in] the maximal number of threads, 0 for DefaultNumberOfThreads()
+	 */
+	static void UnserializeAll( const SerializeValue& SerializedArray, Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads = 0 );
+	static void UnserializeAll( const SerializeValue& SerializedArray, const std::vector<Serializable*>& Objects, unsigned int NbThreads = 0 );
+
+	/** @brief Decode NDJSON text into pre-allocated objects (empty lines are ignored)
+	 * @param Text [in] the NDJSON text with exactly NbObjects objects
+	 * @param Objects [in,out] the objects to fill, in line order
+	 * @param NbObjects [in] the number of objects
+	 * @param NbThreads [in] the maximal number of threads, 0 for DefaultNumberOfThreads()
+	 */
+	static void UnserializeAllFromNDJSON( const SimpleString& Text, Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads = 0 );
+	static void UnserializeAllFromNDJSON( const SimpleString& Text, const std::vector<Serializable*>& Objects, unsigned int NbThreads = 0 );
+};
+
+} // Omiscid
+
+#endif // __SERIALIZE_BATCH_H__
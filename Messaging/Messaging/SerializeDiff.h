@@ -0,0 +1,100 @@
+/**
+ * @file Messaging/Messaging/SerializeDiff.h
+ * \ingroup Messaging
+ * @brief Definition of SerializeDiff class
+ */
+
+#ifndef __SERIALIZE_DIFF_H__
+#define __SERIALIZE_DIFF_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <System/SimpleString.h>
+
+#include <Messaging/SerializeException.h>
+#include <Messaging/SerializeManager.h>
+#include <Messaging/SerializeValue.h>
+
+#include <string>
+
+namespace Omiscid {
+
+/**
+ * @class SerializeDiff SerializeDiff.h Messaging/SerializeDiff.h
+ * \ingroup Messaging
+ * @brief Structural diff and patch between SerializeValue trees.
+ *
+ * A patch is an array of operations like in RFC 6902 (JSON Patch):
+ * @code
+ * [ { "op" : "replace", "path" : "/pos/x", "value" : 12 },
+ *   { "op" : "remove", "path" : "/tags/3" },
+ *   { "op" : "add", "path" : "/name", "value" : "robot" } ]
+ * @endcode
+ * Paths are JSON pointers (RFC 6901), '~' and '/' in keys are escaped as "~0" and "~1".
+ * Only "add", "remove" and "replace" are produced. "test" is also accepted by ApplyPatch.
+ *
+ * Objects are compared key by key, arrays index by index or, optionally,
+ * using a longest common subsequence to find inserted and removed elements.
+ * Operations are computed for the deepest modified values only, identical
+ * subtrees do not produce anything. Objects and arrays by index are walked
+ * once. In longest common subsequence mode, array elements are compared by
+ * their SerializeHash first, so identical elements are not compared again
+ * for each candidate position.
+ *
+ * Objects are unordered: a patched object has the members of the destination,
+ * but existing keys keep their order and added keys are appended. Compare a
+ * patched value to the destination with SerializeHash::Equal( ..., SerializeHash::UnorderedKeys ).
+ */
+class SerializeDiff
+{
+public:
+	/** @brief How arrays are compared */
+	enum ArrayDiffMode {
+		ArrayByIndex = 0,					/*!< element i of the source is compared to element i of the destination */
+		ArrayLongestCommonSubsequence		/*!< find inserted/removed elements (cost is size of source * size of destination) */
+	};
+
+	/** @brief Maximal size of the LCS table (size of source * size of destination) in
+	 * ArrayLongestCommonSubsequence mode, larger arrays are compared by index (default 1000000)
+	 */
+	static size_t MaxLCSTableSize;
+
+	/** @brief Compute a patch transforming From into To
+	 * @param From [in] the source value
+	 * @param To [in] the destination value
+	 * @param Mode [in] how arrays are compared
+	 * @return an array of operations, empty if values are equal
+	 */
+	static SerializeValue Diff( const SerializeValue& From, const SerializeValue& To, ArrayDiffMode Mode = ArrayByIndex );
+
+	/** @brief Apply a patch in place
+	 *
+	 * Operations are applied in order. If an operation fails, the previous ones
+	 * stay applied, use Patch to get an all or nothing behaviour.
+	 * An "add" of a new key appends it at the end of its object.
+	 * @param Target [in,out] the value to modify
+	 * @param PatchOperations [in] an array of operations
+	 * @exception SerializeException if the patch is malformed or does not apply to Target
+	 */
+	static void ApplyPatch( SerializeValue& Target, const SerializeValue& PatchOperations );
+
+	/** @brief Apply a patch to a copy of a value
+	 * @param Source [in] the value to patch
+	 * @param PatchOperations [in] an array of operations
+	 * @return the patched value
+	 * @exception SerializeException if the patch is malformed or does not apply to Source
+	 */
+	static SerializeValue Patch( const SerializeValue& Source, const SerializeValue& PatchOperations );
+
+	/** @brief Escape a key to be used in a JSON pointer ('~' -> "~0", '/' -> "~1")
+	 */
+	static SimpleString EscapePathToken( const SimpleString& Key );
+
+	/** @brief Unescape a JSON pointer token ("~1" -> '/', "~0" -> '~')
+	 */
+	static SimpleString UnescapePathToken( const SimpleString& Token );
+};
+
+} // Omiscid
+
+#endif // __SERIALIZE_DIFF_H__
@@ -0,0 +1,56 @@
+/**
+ * @file Messaging/Messaging/SerializeHash.h
+ * \ingroup Messaging
+ * @brief Definition of SerializeHash class
+ */
+
+#ifndef __SERIALIZE_HASH_H__
+#define __SERIALIZE_HASH_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <Messaging/SerializeManager.h>
+
+#include <stdint.h>
+
+namespace Omiscid {
+
+/**
+ * @class SerializeHash SerializeHash.h Messaging/SerializeHash.h
+ * \ingroup Messaging
+ * @brief Structural hashing and equality of SerializeValue trees.
+ *
+ * The 64 bits hash only depends on the content of the tree: it is stable
+ * between runs and platforms and can be stored or sent. Types are part
+ * of the hash (1 and 1.0 are different values, as for operator==), -0.0
+ * and 0.0 have the same hash. Objects can be hashed with their keys in
+ * order or without taking the order of the keys into account.
+ */
+class SerializeHash
+{
+public:
+	/** @brief Is the order of the keys in objects significant */
+	enum ObjectKeyOrder { OrderedKeys = 0, UnorderedKeys };
+
+	/** @brief Compute the structural hash of a value
+	 * @param Val [in] the value (a SerializeValue or a json_spirit::Value)
+	 * @param Order [in] is the order of the keys in objects significant
+	 */
+	static uint64_t Hash( const json_spirit::Value& Val, ObjectKeyOrder Order = OrderedKeys );
+
+	/** @brief Structural equality
+	 *
+	 * Same result as operator== in OrderedKeys mode, but stops as soon
+	 * as a difference is found and skips identical nodes. In UnorderedKeys
+	 * mode, each pair of an object is matched once (a key may appear several
+	 * times) and keys out of place in large objects are found from an index.
+	 * @param Val1 [in] first value
+	 * @param Val2 [in] second value
+	 * @param Order [in] is the order of the keys in objects significant
+	 */
+	static bool Equal( const json_spirit::Value& Val1, const json_spirit::Value& Val2, ObjectKeyOrder Order = OrderedKeys );
+};
+
+} // Omiscid
+
+#endif // __SERIALIZE_HASH_H__
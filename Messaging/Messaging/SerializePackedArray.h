@@ -0,0 +1,206 @@
+/**
+ * @file Messaging/Messaging/SerializePackedArray.h
+ * \ingroup Messaging
+ * @brief Packed encoding of numeric containers (raw little-endian bytes wrapped in base64)
+ */
+
+#ifndef __SERIALIZE_PACKED_ARRAY_H__
+#define __SERIALIZE_PACKED_ARRAY_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <Messaging/SerializeException.h>
+#include <Messaging/SerializeValue.h>
+
+#include <System/SimpleList.h>
+
+#include <vector>
+#include <string>
+
+#include <string.h>
+
+namespace Omiscid {
+
+/**
+ * @class SerializePackedArray SerializePackedArray.h Messaging/SerializePackedArray.h
+ * \ingroup Messaging
+ * @brief Tools to encode numeric containers as a single base64 string.
+ *
+ * Elements are stored as raw little-endian bytes, whatever the host byte order,
+ * then wrapped in base64 to fit in a JSON string. Encoding and decoding are
+ * a memcpy (plus a byte swap on big-endian hosts) and a table-driven base64 pass,
+ * without any intermediate SerializeValue per element.
+ */
+class SerializePackedArray
+{
+public:
+	/** @brief Compute the length of the base64 text for a raw buffer
+	 */
+	static size_t EncodedLength( size_t RawLength )
+	{
+		return ((RawLength+2)/3)*4;
+	}
+
+	/** @brief Encode a raw buffer in base64
+	 * @param Data [in] the raw buffer
+	 * @param Length [in] the length of the raw buffer
+	 * @param Result [out] the base64 text
+	 */
+	static void EncodeBase64( const unsigned char * Data, size_t Length, std::string& Result );
+
+	/** @brief Compute the length of raw data encoded in a base64 text
+	 * @return the raw length or (size_t)-1 if the text is not valid base64
+	 */
+	static size_t DecodedLength( const char * Text, size_t TextLength );
+
+	/** @brief Decode a base64 text to a raw buffer of DecodedLength() bytes
+	 * @return false if the text is not valid base64
+	 */
+	static bool DecodeBase64( const char * Text, size_t TextLength, unsigned char * Result );
+
+	/** @brief Check host byte order
+	 */
+	static bool HostIsLittleEndian()
+	{
+		const unsigned short Probe = 1;
+		return (*(const unsigned char*)&Probe) == 1;
+	}
+
+	/** @brief Reverse in place the bytes of each element of a buffer
+	 */
+	static void SwapBytes( unsigned char * Data, size_t NbElements, size_t SizeOfElement );
+};
+
+// packed std::vector management
+	// Encoding functions
+	template <typename TYPE_NAME> SerializeValue SerializePackedStdVector( const std::vector<TYPE_NAME>& Data )
+	{
+		const size_t RawLength = Data.size()*sizeof(TYPE_NAME);
+		std::string Encoded;
+
+		if ( SerializePackedArray::HostIsLittleEndian() == true || sizeof(TYPE_NAME) == 1 )
+		{
+			SerializePackedArray::EncodeBase64( (const unsigned char *)Data.data(), RawLength, Encoded );
+		}
+		else
+		{
+			std::vector<TYPE_NAME> LittleEndianData( Data );
+			SerializePackedArray::SwapBytes( (unsigned char *)LittleEndianData.data(), LittleEndianData.size(), sizeof(TYPE_NAME) );
+			SerializePackedArray::EncodeBase64( (const unsigned char *)LittleEndianData.data(), RawLength, Encoded );
+		}
+
+		// Do not use SerializeValue(const char*), it would try to parse the text as JSON
+		return SerializeValue( json_spirit::Value(Encoded) );
+	}
+
+	template <typename TYPE_NAME> SerializeValue SerializePackedStdVectorFromAddress( std::vector<TYPE_NAME> * pData )
+	{
+		return SerializePackedStdVector<TYPE_NAME>( *pData );
+	}
+	// Decoding functions
+	template <typename TYPE_NAME> void UnserializePackedStdVectorFromAddress( const json_spirit::Value& Val, std::vector<TYPE_NAME> * pData )
+	{
+		if ( Val.type() == json_spirit::null_type )		// Case on empty string in some json analysis
+		{
+			pData->clear();
+			return;
+		}
+		if ( Val.type() != json_spirit::str_type )
+		{
+			throw SerializeException( "Parameter must be a packed array", SerializeException::IllegalTypeConversion );
+		}
+
+		const std::string& Text = Val.get_str();
+		size_t RawLength = SerializePackedArray::DecodedLength( Text.data(), Text.length() );
+		if ( RawLength == (size_t)-1 || (RawLength % sizeof(TYPE_NAME)) != 0 )
+		{
+			throw SerializeException( "Malformed packed array", SerializeException::MalformedStream );
+		}
+
+		pData->resize( RawLength/sizeof(TYPE_NAME) );
+		if ( RawLength == 0 )
+		{
+			return;
+		}
+		if ( SerializePackedArray::DecodeBase64( Text.data(), Text.length(), (unsigned char *)pData->data() ) == false )
+		{
+			// Do not leave a partly decoded vector
+			pData->clear();
+			throw SerializeException( "Malformed packed array", SerializeException::MalformedStream );
+		}
+		if ( SerializePackedArray::HostIsLittleEndian() == false && sizeof(TYPE_NAME) > 1 )
+		{
+			SerializePackedArray::SwapBytes( (unsigned char *)pData->data(), pData->size(), sizeof(TYPE_NAME) );
+		}
+	}
+	template <typename TYPE_NAME> std::vector<TYPE_NAME> UnserializePackedStdVector( const json_spirit::Value& Val )
+	{
+		std::vector<TYPE_NAME> ResultVector;
+		UnserializePackedStdVectorFromAddress<TYPE_NAME>( Val, &ResultVector );
+		return ResultVector;
+	}
+
+// packed SimpleList management
+	// Encoding functions
+	template <typename TYPE_NAME> SerializeValue SerializePackedSimpleListFromAddress( SimpleList<TYPE_NAME> * pData )
+	{
+		std::vector<TYPE_NAME> Flat;
+		Flat.reserve( pData->GetNumberOfElements() );
+		for( pData->First(); pData->NotAtEnd(); pData->Next() )
+		{
+			Flat.push_back( pData->GetCurrent() );
+		}
+		return SerializePackedStdVector<TYPE_NAME>( Flat );
+	}
+	// Decoding functions
+	template <typename TYPE_NAME> void UnserializePackedSimpleListFromAddress( const json_spirit::Value& Val, SimpleList<TYPE_NAME> * pData )
+	{
+		std::vector<TYPE_NAME> Flat;
+		UnserializePackedStdVectorFromAddress<TYPE_NAME>( Val, &Flat );
+
+		pData->Empty();
+		for( size_t i = 0; i < Flat.size(); i++ )
+		{
+			pData->AddTail( Flat[i] );
+		}
+	}
+
+// Numeric containers registered by Serializable: packed or plain array encoding, both accepted at decoding
+	template <typename TYPE_NAME> SerializeValue SerializeNumericStdVectorFromAddress( std::vector<TYPE_NAME> * pData, bool Packed )
+	{
+		if ( Packed == true )
+		{
+			return SerializePackedStdVectorFromAddress<TYPE_NAME>( pData );
+		}
+		return SerializeStdVectorFromAddress<TYPE_NAME>( pData );
+	}
+	template <typename TYPE_NAME> void UnserializeNumericStdVectorFromAddress( const json_spirit::Value& Val, std::vector<TYPE_NAME> * pData )
+	{
+		if ( Val.type() == json_spirit::array_type )
+		{
+			UnserializeStdVectorFromAddress<TYPE_NAME>( Val, pData );
+			return;
+		}
+		UnserializePackedStdVectorFromAddress<TYPE_NAME>( Val, pData );
+	}
+	template <typename TYPE_NAME> SerializeValue SerializeNumericSimpleListFromAddress( SimpleList<TYPE_NAME> * pData, bool Packed )
+	{
+		if ( Packed == true )
+		{
+			return SerializePackedSimpleListFromAddress<TYPE_NAME>( pData );
+		}
+		return SerializeSimpleListFromAddress<TYPE_NAME>( pData );
+	}
+	template <typename TYPE_NAME> void UnserializeNumericSimpleListFromAddress( const json_spirit::Value& Val, SimpleList<TYPE_NAME> * pData )
+	{
+		if ( Val.type() == json_spirit::array_type )
+		{
+			UnserializeSimpleListFromAddress<TYPE_NAME>( Val, pData );
+			return;
+		}
+		UnserializePackedSimpleListFromAddress<TYPE_NAME>( Val, pData );
+	}
+
+} // Omiscid
+
+#endif // __SERIALIZE_PACKED_ARRAY_H__
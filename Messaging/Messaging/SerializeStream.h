@@ -0,0 +1,317 @@
+/**
+ * @file Messaging/Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Definition of SerializeStream class and of its sinks
+ */
+
+#ifndef __SERIALIZE_STREAM_H__
+#define __SERIALIZE_STREAM_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <System/SimpleList.h>
+#include <System/SimpleString.h>
+#include <System/Socket.h>
+
+#include <Messaging/SerializeException.h>
+#include <Messaging/SerializeManager.h>
+#include <Messaging/SerializePackedArray.h>
+#include <Messaging/SerializeValue.h>
+
+#include <vector>
+#include <list>
+#include <string>
+#include <algorithm>
+
+namespace Omiscid {
+
+/**
+ * @class SerializeSink SerializeStream.h Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Destination of a SerializeStream.
+ *
+ * Write must not return before the chunk has been accepted: a slow
+ * destination slows down the encoder (back-pressure) instead of letting
+ * data pile up in memory.
+ */
+class SerializeSink
+{
+public:
+	virtual ~SerializeSink();
+
+	/** @brief Write a whole chunk
+	 * @exception SimpleException (or a derived class) if the chunk can not be written
+	 */
+	virtual void Write( const char * Data, size_t Length ) = 0;
+};
+
+/**
+ * @class SocketSerializeSink SerializeStream.h Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Send chunks on a connected TCP socket, partial sends are completed.
+ */
+class SocketSerializeSink : public SerializeSink
+{
+public:
+	SocketSerializeSink( Socket * pConnectedSocket );
+
+	virtual void Write( const char * Data, size_t Length );
+
+private:
+	Socket * pSocket;
+};
+
+/**
+ * @class FileDescriptorSerializeSink SerializeStream.h Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Write chunks to a file descriptor (file, pipe...), partial writes are completed.
+ */
+class FileDescriptorSerializeSink : public SerializeSink
+{
+public:
+	FileDescriptorSerializeSink( int FileDescriptor );
+
+	virtual void Write( const char * Data, size_t Length );
+
+private:
+	int Descriptor;
+};
+
+/**
+ * @class CallbackSerializeSink SerializeStream.h Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Give chunks to a user function. The chunk is only valid during the call.
+ */
+class CallbackSerializeSink : public SerializeSink
+{
+public:
+	typedef void (*WriteCallback)( const char * Data, size_t Length, void * UserData );
+
+	CallbackSerializeSink( WriteCallback Function, void * UserData = NULL );
+
+	virtual void Write( const char * Data, size_t Length );
+
+private:
+	WriteCallback Callback;
+	void * CallbackUserData;
+};
+
+/**
+ * @class SerializeStream SerializeStream.h Messaging/SerializeStream.h
+ * \ingroup Messaging
+ * @brief Write JSON text to a sink through a fixed size chunk buffer.
+ *
+ * The text is the same as the one produced by json_spirit::write (compact
+ * form). Memory use only depends on the chunk size: values are written as
+ * they come, a full chunk is given to the sink before going on.
+ * See Serializable::SerializeToStream to encode a Serializable object
+ * without building the whole SerializeValue and the whole text first.
+ */
+class SerializeStream
+{
+public:
+	/** @brief Default chunk size (64 KB) */
+	static const size_t DefaultChunkSize = 64*1024;
+
+	SerializeStream( SerializeSink& Destination, size_t ChunkSize = DefaultChunkSize );
+
+	/** @brief Destructor. Pending data are not flushed, Flush must be called
+	 * once the text is complete.
+	 */
+	~SerializeStream();
+
+	/** @brief Append raw text */
+	void Write( const char * Data, size_t Length )
+	{
+		if ( Length <= Chunk.size() - Used )
+		{
+			memcpy( &Chunk[Used], Data, Length );
+			Used += Length;
+			return;
+		}
+		WriteLarge( Data, Length );
+	}
+
+	void Write( char Character )
+	{
+		if ( Used == Chunk.size() )
+		{
+			Flush();
+		}
+		Chunk[Used++] = Character;
+	}
+
+	void Write( const char * Text )
+	{
+		Write( Text, strlen(Text) );
+	}
+
+	/** @brief Write a JSON string (between double quotes) */
+	void WriteString( const std::string& Str )
+	{
+		Write( '"' );
+		Write( Str.data(), Str.length() );
+		Write( '"' );
+	}
+
+	/** @brief Write the key of an object member and the ':' */
+	void WriteKey( const char * Key )
+	{
+		Write( '"' );
+		Write( Key );
+		Write( "\":", 2 );
+	}
+
+	void WriteInt( int Val );
+	void WriteReal( double Val );
+	void WriteBool( bool Val );
+
+	/** @brief Write a whole value */
+	void WriteValue( const json_spirit::Value& Val );
+
+	/** @brief Write the base64 text of a raw buffer, by pieces, without the double quotes.
+	 * Length must be a multiple of 3 for all calls but the last one of a given text.
+	 */
+	void WriteBase64( const unsigned char * Data, size_t Length );
+
+	/** @brief Give pending data to the sink */
+	void Flush();
+
+	/** @brief Number of bytes written to the stream since its creation */
+	size_t GetTotalLength() const
+	{
+		return FlushedLength + Used;
+	}
+
+private:
+	void WriteLarge( const char * Data, size_t Length );
+
+	SerializeSink& Sink;
+	std::vector<char> Chunk;
+	size_t Used;
+	size_t FlushedLength;
+	std::string Base64Buffer;
+};
+
+/** @brief Callback for the streaming function of a field */
+typedef void (*SerializeStreamFunction)( SerializeStream&, void * );
+
+// Streaming functions for containers, elements are encoded one at a time
+	template <typename TYPE_NAME> void StreamSimpleListFromAddress( SerializeStream& Stream, SimpleList<TYPE_NAME> * pData )
+	{
+		Stream.Write( '[' );
+		bool First = true;
+		for( pData->First(); pData->NotAtEnd(); pData->Next() )
+		{
+			if ( First == false )
+			{
+				Stream.Write( ',' );
+			}
+			First = false;
+			Stream.WriteValue( Serialize(pData->GetCurrent()) );
+		}
+		Stream.Write( ']' );
+	}
+
+	template <typename TYPE_NAME> void StreamStdVectorFromAddress( SerializeStream& Stream, std::vector<TYPE_NAME> * pData )
+	{
+		Stream.Write( '[' );
+		for( size_t i = 0; i < pData->size(); i++ )
+		{
+			if ( i != 0 )
+			{
+				Stream.Write( ',' );
+			}
+			Stream.WriteValue( Serialize((*pData)[i]) );
+		}
+		Stream.Write( ']' );
+	}
+
+	template <typename TYPE_NAME> void StreamStdListFromAddress( SerializeStream& Stream, std::list<TYPE_NAME> * pData )
+	{
+		Stream.Write( '[' );
+		typename std::list<TYPE_NAME>::iterator it;
+		for( it = pData->begin(); it != pData->end(); ++it )
+		{
+			if ( it != pData->begin() )
+			{
+				Stream.Write( ',' );
+			}
+			Stream.WriteValue( Serialize(*it) );
+		}
+		Stream.Write( ']' );
+	}
+
+// Packed numeric containers, the base64 text is produced by blocks
+	template <typename TYPE_NAME> void StreamPackedElements( SerializeStream& Stream, const TYPE_NAME * Data, size_t NbElements )
+	{
+		if ( SerializePackedArray::HostIsLittleEndian() == true || sizeof(TYPE_NAME) == 1 )
+		{
+			Stream.WriteBase64( (const unsigned char *)Data, NbElements*sizeof(TYPE_NAME) );
+			return;
+		}
+
+		std::vector<TYPE_NAME> LittleEndianData( Data, Data + NbElements );
+		SerializePackedArray::SwapBytes( (unsigned char *)LittleEndianData.data(), NbElements, sizeof(TYPE_NAME) );
+		Stream.WriteBase64( (const unsigned char *)LittleEndianData.data(), NbElements*sizeof(TYPE_NAME) );
+	}
+
+	// Number of elements per block, a multiple of 3 to keep base64 pieces independent
+	static const size_t PackedStreamBlockSize = 3*1024;
+
+	template <typename TYPE_NAME> void StreamPackedStdVectorFromAddress( SerializeStream& Stream, std::vector<TYPE_NAME> * pData )
+	{
+		Stream.Write( '"' );
+		for( size_t Start = 0; Start < pData->size(); Start += PackedStreamBlockSize )
+		{
+			const size_t NbElements = std::min( PackedStreamBlockSize, pData->size() - Start );
+			StreamPackedElements<TYPE_NAME>( Stream, pData->data() + Start, NbElements );
+		}
+		Stream.Write( '"' );
+	}
+
+	template <typename TYPE_NAME> void StreamPackedSimpleListFromAddress( SerializeStream& Stream, SimpleList<TYPE_NAME> * pData )
+	{
+		std::vector<TYPE_NAME> Block;
+		Block.reserve( PackedStreamBlockSize );
+
+		Stream.Write( '"' );
+		for( pData->First(); pData->NotAtEnd(); pData->Next() )
+		{
+			Block.push_back( pData->GetCurrent() );
+			if ( Block.size() == PackedStreamBlockSize )
+			{
+				StreamPackedElements<TYPE_NAME>( Stream, Block.data(), Block.size() );
+				Block.clear();
+			}
+		}
+		if ( Block.empty() == false )
+		{
+			StreamPackedElements<TYPE_NAME>( Stream, Block.data(), Block.size() );
+		}
+		Stream.Write( '"' );
+	}
+
+	template <typename TYPE_NAME> void StreamNumericStdVectorFromAddress( SerializeStream& Stream, std::vector<TYPE_NAME> * pData, bool Packed )
+	{
+		if ( Packed == true )
+		{
+			StreamPackedStdVectorFromAddress<TYPE_NAME>( Stream, pData );
+			return;
+		}
+		StreamStdVectorFromAddress<TYPE_NAME>( Stream, pData );
+	}
+
+	template <typename TYPE_NAME> void StreamNumericSimpleListFromAddress( SerializeStream& Stream, SimpleList<TYPE_NAME> * pData, bool Packed )
+	{
+		if ( Packed == true )
+		{
+			StreamPackedSimpleListFromAddress<TYPE_NAME>( Stream, pData );
+			return;
+		}
+		StreamSimpleListFromAddress<TYPE_NAME>( Stream, pData );
+	}
+
+} // Omiscid
+
+#endif // __SERIALIZE_STREAM_H__
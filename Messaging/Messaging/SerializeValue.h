@@ -1,403 +1,607 @@
-#ifndef __SERIALIZE_VALUE_H__
-#define __SERIALIZE_VALUE_H__
-
-#include <Messaging/ConfigMessaging.h>
-
-#include <Messaging/SerializeException.h>
-#include <Messaging/SerializeManager.h>
-
-#include <System/SimpleList.h>
-
-#include <vector>
-#include <list>
-
-#include <string.h>
-
-namespace Omiscid {
-
-class SerializeValue : public json_spirit::Value
-{
-public:
-	SerializeValue();
-	SerializeValue( const SerializeValue& Val );
-	SerializeValue( const json_spirit::Value& Val );
-	SerializeValue( const long Val );
-	SerializeValue( const int Val );
-	SerializeValue( const unsigned int Val );
-	SerializeValue( const bool Val );
-	SerializeValue( const double Val );
-	SerializeValue( const float Val );
-	SerializeValue( const SimpleString& Val );
-	SerializeValue( const char * Val );
-
-	operator json_spirit::Value();
-	operator int();
-	operator unsigned int();
-	operator bool();
-	operator double();
-	operator float();
-	operator SimpleString();
-	operator char*();
-
-	SerializeValue& operator=( const SerializeValue& Val );
- 	SerializeValue& operator=( const json_spirit::Value& Val );
-	SerializeValue& operator=( const long Val );
-	SerializeValue& operator=( const int Val );
-	SerializeValue& operator=( const unsigned int Val );
-	SerializeValue& operator=( const bool Val );
-	SerializeValue& operator=( const double Val );
-	SerializeValue& operator=( const float Val );
-	SerializeValue& operator=( const SimpleString& Val );
-	SerializeValue& operator=( const char* Val );
-
-	bool IsAnObject() const;
-	bool IsASimpleValue() const;
-	bool IsNullValue() const;
-	bool IsAnArray() const;
-};
-
-// int management
-	// Encoding functions
-	SerializeValue SerializeLong( long Data );
-	SerializeValue SerializeLongFromAddress( void * pData );
-	// Decoding functions
-	int UnserializeLong( const SerializeValue& Val );
-	void UnserializeLongFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( long Data ) { return SerializeLong(Data); }
-	inline void Unserialize( const SerializeValue& Val, long * pData ) { UnserializeLongFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, long& Data ) { Data = UnserializeLong(Val); }
-
-// int management
-	// Encoding functions
-	SerializeValue SerializeInt( int Data );
-	SerializeValue SerializeIntFromAddress( void * pData );
-	// Decoding functions
-	int UnserializeInt( const SerializeValue& Val );
-	void UnserializeIntFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( int Data ) { return SerializeInt(Data); }
-	inline void Unserialize( const SerializeValue& Val, int * pData ) { UnserializeIntFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, int& Data ) { Data = UnserializeInt(Val); }
-
-// short int management
-	// Encoding functions
-	SerializeValue SerializeShortInt( short int Data );
-	SerializeValue SerializeShortIntFromAddress( void * pData );
-	// Decoding functions
-	short int UnserializeShortInt( const SerializeValue& Val );
-	void UnserializeShortIntFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( short int Data ) { return SerializeShortInt(Data); }
-	inline void Unserialize( const SerializeValue& Val, short int * pData ) { UnserializeShortIntFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, short int& Data ) { Data = UnserializeShortInt(Val); }
-
-// unsigned int management
-// unsigned are not supported due to incompatibility among programming language
-	// Encoding functions
-	SerializeValue SerializeUnsignedInt( unsigned int Data );
-	SerializeValue SerializeUnsignedIntFromAddress( void * pData );
-	// Decoding functions
-	unsigned int UnserializeUnsignedInt( const SerializeValue& Val );
-	void UnserializeUnsignedIntFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( unsigned int Data ) { return SerializeUnsignedInt(Data); }
-	inline void Unserialize( const SerializeValue& Val, unsigned int * pData ) { UnserializeUnsignedIntFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, unsigned int& Data ) { Data = UnserializeUnsignedInt(Val); }
-
-// unsigned short management
-	// Encoding functions
-	SerializeValue SerializeUnsignedShort( unsigned short Data );
-	SerializeValue SerializeUnsignedShortFromAddress( void * pData );
-	// Decoding functions
-	unsigned short UnserializeUnsignedShort( const SerializeValue& Val );
-	void UnserializeUnsignedShortFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( unsigned short Data ) { return SerializeUnsignedShort(Data); }
-	inline void Unserialize( const SerializeValue& Val, unsigned short * pData ) { UnserializeUnsignedShortFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, unsigned short& Data ) { Data = UnserializeUnsignedShort(Val); }
-
-// char management
-	// Encoding functions
-	SerializeValue SerializeChar( char Data );
-	SerializeValue SerializeCharFromAddress( void * pData );
-	// Decoding functions
-	char UnserializeChar( const SerializeValue& Val );
-	void UnserializeCharFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( char Data ) { return SerializeChar(Data); }
-	inline void Unserialize( const SerializeValue& Val, char * pData ) { UnserializeCharFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, char& Data ) { Data = UnserializeChar(Val); }
-
-// unsigned char management
-	// Encoding functions
-	SerializeValue SerializeUnsignedChar( unsigned char Data );
-	SerializeValue SerializeUnsignedChar( void * pData );
-	// Decoding functions
-	unsigned char UnserializeUnsignedChar( const SerializeValue& Val );
-	void UnserializeUnsignedCharFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( unsigned char Data ) { return SerializeUnsignedChar(Data); }
-	inline void Unserialize( const SerializeValue& Val, unsigned char * pData ) { UnserializeUnsignedCharFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, unsigned char& Data ) { Data = UnserializeUnsignedChar(Val); }
-
-// double management
-	// Encoding functions
-	SerializeValue SerializeDouble( double Data );
-	SerializeValue SerializeDoubleFromAddress( void * pData );
-	// Decoding functions
-	double UnserializeDouble( const SerializeValue& Val );
-	void UnserializeDoubleFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( double Data ) { return SerializeDouble(Data); }
-	inline void Unserialize( const SerializeValue& Val, double * pData ) { UnserializeDoubleFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, double& Data ) { Data = UnserializeDouble(Val); }
-
-// float management
-	// Encoding functions
-	SerializeValue SerializeFloat( float Data );
-	SerializeValue SerializeFloatFromAddress( void * pData );
-	// Decoding functions
-	float UnserializeFloat( const SerializeValue& Val );
-	void UnserializeFloatFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( float Data ) { return SerializeFloat(Data); }
-	inline void Unserialize( const SerializeValue& Val, float * pData ) { UnserializeFloatFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, float& Data ) { Data = UnserializeFloat(Val); }
-
-// bool management
-	// Encoding functions
-	SerializeValue SerializeBool( bool Data );
-	SerializeValue SerializeBoolFromAddress( void * pData );
-	// Decoding functions
-	bool UnserializeBool( const SerializeValue& Val );
-	void UnserializeBoolFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( bool Data ) { return SerializeBool(Data); }
-	inline void Unserialize( const SerializeValue& Val, bool * pData ) { UnserializeBoolFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, bool& Data ) { Data = UnserializeBool(Val); }
-
-// SimpleString management
-	// Encoding functions
-	SerializeValue SerializeSimpleString( SimpleString& Data );
-	SerializeValue SerializeSimpleStringFromAddress( void * pData );
-	// Decoding functions
-	SimpleString UnserializeSimpleString( const SerializeValue& Val );
-	void UnserializeSimpleStringFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( SimpleString& Data ) { return SerializeSimpleString(Data); }
-	inline void Unserialize( const SerializeValue& Val, SimpleString * pData ) { UnserializeSimpleStringFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, SimpleString& Data ) { Data = UnserializeSimpleString(Val); }
-
-// char * management
-	// Encoding functions
-	SerializeValue SerializeCharStar( char * Data );
-	SerializeValue SerializeCharStarFromAddress( void * pData );
-	// Decoding functions
-	char * UnserializeCharStar( const SerializeValue& Val );
-	void UnserializeCharStarFromAddress( const SerializeValue& Val, void * pData );
-	// Generic versions
-	inline SerializeValue Serialize( char * Data ) { return SerializeCharStar(Data); }
-	inline void Unserialize( const SerializeValue& Val, char ** pData ) { UnserializeCharStarFromAddress(Val,(void*)pData); }
-	inline void Unserialize( const SerializeValue& Val, char *& Data ) { Data = UnserializeCharStar(Val); }
-
-// SimleList management
-	// Encoding functions
-	template <typename TYPE_NAME> SerializeValue SerializeSimpleList( SimpleList<TYPE_NAME>& Data )
-	{
-		SerializeArray ValArray;
-		for( Data.First(); Data.NotAtEnd(); Data.Next() )
-		{
-			ValArray.push_back( Serialize(Data.GetCurrent()) );
-		}
-		return SerializeValue(ValArray);
-	}
-
-	template <typename TYPE_NAME> SerializeValue SerializeSimpleListFromAddress( SimpleList<TYPE_NAME> * pAddress )
-	{
-		SimpleList<TYPE_NAME> * pData = (SimpleList<TYPE_NAME> *)pAddress;
-
-		SerializeArray ValArray;
-		for( pData->First(); pData->NotAtEnd(); pData->Next() )
-		{
-			ValArray.push_back( Serialize(pData->GetCurrent()) );
-		}
-		return SerializeValue(ValArray);
-	}
-	// Decoding functions
-	template <typename TYPE_NAME> SimpleList<TYPE_NAME> UnserializeSimpleList( const SerializeValue& Val )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
-		}
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		SimpleList<TYPE_NAME> ResultList;
-		TYPE_NAME Listelement;
-
-		for( it = ValArray.begin(); it != ValArray.end();++it )
-		{
-			Unserialize( *it, &Listelement );
-			ResultList.AddTail( Listelement );
-		}
-
-		return ResultList;
-	}
-	template <typename TYPE_NAME> void UnserializeSimpleListFromAddress( const SerializeValue& Val, SimpleList<TYPE_NAME> * pAddress )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
-		}
-		SimpleList<TYPE_NAME> * pData = (SimpleList<TYPE_NAME> *)pAddress;
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		TYPE_NAME Listelement;
-
-		pData->Empty();
-		for( it = ValArray.begin(); it != ValArray.end(); ++it )
-		{
-			Unserialize( *it, &Listelement );
-			pData->AddTail( Listelement );
-		}
-	}
-	// Generic versions
-	template <typename TYPE_NAME> inline SerializeValue Serialize( SimpleList<TYPE_NAME>& Data ) { return SerializeSimpleListFromAddress<TYPE_NAME>(&Data); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, SimpleList<TYPE_NAME> * pData ) { UnserializeSimpleListFromAddress<TYPE_NAME>(Val,(void*)pData); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, SimpleList<TYPE_NAME>& Data ) { UnserializeSimpleListFromAddress<TYPE_NAME>(Val,&Data); }
-
-// std::vector management
-	// Encoding functions
-	template <typename TYPE_NAME> SerializeValue SerializeStdVector( std::vector<TYPE_NAME>& Data )
-	{
-		SerializeArray ValArray;
-		typename std::vector<TYPE_NAME>::const_iterator it;
-		for( it = Data.begin(); it != Data.end(); ++it )
-		{
-			ValArray.push_back( Serialize(*it) );
-		}
-		return SerializeValue(ValArray);
-	}
-
-	template <typename TYPE_NAME> SerializeValue SerializeStdVectorFromAddress( std::vector<TYPE_NAME> * pData )
-	{
-		SerializeArray ValArray;
-		typename std::vector<TYPE_NAME>::const_iterator it;
-		for( it = pData->begin(); it != pData->end(); ++it )
-		{
-			ValArray.push_back( Serialize(*it) );
-		}
-		return SerializeValue(ValArray);
-	}
-	// Decoding functions
-	template <typename TYPE_NAME> std::vector<TYPE_NAME> UnserializeStdVector( const SerializeValue& Val )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialized Array", SerializeException::IllegalTypeConversion  );
-		}
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		typename std::vector<TYPE_NAME> ResultVector;
-		TYPE_NAME Listelement;
-
-		for( it = ValArray.begin(); it != ValArray.end();++it )
-		{
-			Unserialize( *it, &Listelement );
-			ResultVector.push_back( Listelement );
-		}
-
-		return ResultVector;
-	}
-	template <typename TYPE_NAME> void UnserializeStdVectorFromAddress( const SerializeValue& Val, std::vector<TYPE_NAME> * pData )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialized Array", SerializeException::IllegalTypeConversion  );
-		}
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		TYPE_NAME Listelement;
-
-		pData->clear();
-		for( it = ValArray.begin(); it != ValArray.end(); ++it )
-		{
-			Unserialize( *it, &Listelement );
-			pData->push_back( Listelement );
-		}
-	}
-	// Generic versions
-	template <typename TYPE_NAME> inline SerializeValue Serialize( std::vector<TYPE_NAME>& Data ) { return SerializeStdVectorFromAddress<TYPE_NAME>(&Data); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, std::vector<TYPE_NAME> * pData ) { UnserializeStdVectorFromAddress<TYPE_NAME>(Val,(void*)pData); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, std::vector<TYPE_NAME>& Data ) { UnserializeStdVectorFromAddress<TYPE_NAME>(Val,&Data); }
-
-// std::list management
-	// Encoding functions
-	template <typename TYPE_NAME> SerializeValue SerializeStdList( std::list<TYPE_NAME>& Data )
-	{
-		SerializeArray ValArray;
-		typename std::list<TYPE_NAME>::const_iterator it;
-		for( it = Data.begin(); it != Data.end(); ++it )
-		{
-			ValArray.push_back( Serialize(*it) );
-		}
-		return SerializeValue(ValArray);
-	}
-
-	template <typename TYPE_NAME> SerializeValue SerializeStdListFromAddress( std::list<TYPE_NAME> * pData )
-	{
-		SerializeArray ValArray;
-		typename std::list<TYPE_NAME>::const_iterator it;
-		for( it = pData->begin(); it != pData->end(); ++it )
-		{
-			ValArray.push_back( Serialize(*it) );
-		}
-		return SerializeValue(ValArray);
-	}
-	// Decoding functions
-	template <typename TYPE_NAME> std::list<TYPE_NAME> UnserializeStdList( const SerializeValue& Val )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
-		}
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		typename std::list<TYPE_NAME> ResultList;
-		TYPE_NAME Listelement;
-
-		for( it = ValArray.begin(); it != ValArray.end();++it )
-		{
-			Unserialize( *it, &Listelement );
-			ResultList.push_back( Listelement );
-		}
-
-		return ResultList;
-	}
-	template <typename TYPE_NAME> void UnserializeStdListFromAddress( const SerializeValue& Val, std::list<TYPE_NAME> * pData )
-	{
-		if ( Val.type() != json_spirit::array_type )
-		{
-			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
-		}
-		const SerializeArray& ValArray = Val.get_array();
-		SerializeArrayConstIterator it;
-		TYPE_NAME Listelement;
-
-		pData->clear();
-		for( it = ValArray.begin(); it != ValArray.end(); ++it )
-		{
-			Unserialize( *it, &Listelement );
-			pData->push_back( Listelement );
-		}
-	}
-	// Generic versions
-	template <typename TYPE_NAME> inline SerializeValue Serialize( std::list<TYPE_NAME>& Data ) { return SerializeStdListFromAddress<TYPE_NAME>(&Data); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, std::list<TYPE_NAME> * pData ) { UnserializeStdListFromAddress<TYPE_NAME>(Val,(void*)pData); }
-	template <typename TYPE_NAME> inline void Unserialize( const SerializeValue& Val, std::list<TYPE_NAME>& Data ) { UnserializeStdListFromAddress<TYPE_NAME>(Val,&Data); }
-
-} // Omiscid
-
-#endif // __SERIALIZE_VALUE_H__
+#ifndef __SERIALIZE_VALUE_H__
+#define __SERIALIZE_VALUE_H__
+
+#include <Messaging/ConfigMessaging.h>
+
+#include <Messaging/SerializeException.h>
+#include <Messaging/SerializeManager.h>
+
+#include <System/SimpleList.h>
+
+#include <vector>
+#include <list>
+#include <limits>
+#include <cmath>
+
+#include <string.h>
+
+namespace Omiscid {
+
+/** @brief Find a member of an object without throwing any exception
+ *
+ * Members and elements of a SerializeValue are json_spirit::Value, the decoding
+ * functions take them as they are, without copy.
+ * @param Val [in] the object
+ * @param Key [in] the key of the member
+ * @return a pointer to the member value (valid until Val is modified)
+ * or NULL if Val is not an object or if Key is not found
+ */
+const json_spirit::Value * TryFindMember( const json_spirit::Value& Val, const SimpleString& Key );
+
+/** @brief Get an element of an array without throwing any exception
+ * @param Val [in] the array
+ * @param Index [in] the index of the element
+ * @return a pointer to the element (valid until Val is modified)
+ * or NULL if Val is not an array or if Index is out of range
+ */
+inline const json_spirit::Value * TryGetElement( const json_spirit::Value& Val, size_t Index )
+{
+	if ( Val.type() != json_spirit::array_type || Index >= Val.get_array().size() )
+	{
+		return (const json_spirit::Value *)NULL;
+	}
+	return &Val.get_array()[Index];
+}
+
+// Typed accessors without exception nor copy. They return false, and leave
+// Data unchanged, if the value does not have the requested type.
+
+/** @brief Read an integer value */
+inline bool TryGetInt( const json_spirit::Value& Val, int& Data )
+{
+	if ( Val.type() != json_spirit::int_type )
+	{
+		return false;
+	}
+	Data = Val.get_int();
+	return true;
+}
+
+/** @brief Read a real value, integers are promoted */
+inline bool TryGetReal( const json_spirit::Value& Val, double& Data )
+{
+	if ( Val.type() != json_spirit::real_type && Val.type() != json_spirit::int_type )
+	{
+		return false;
+	}
+	Data = Val.get_real();
+	return true;
+}
+
+/** @brief Read a boolean value */
+inline bool TryGetBool( const json_spirit::Value& Val, bool& Data )
+{
+	if ( Val.type() != json_spirit::bool_type )
+	{
+		return false;
+	}
+	Data = Val.get_bool();
+	return true;
+}
+
+/** @brief Read any number (integer or real) converted to TYPE_NAME.
+ * When TYPE_NAME is an integer type, reals are truncated and the call fails
+ * if the value (or a NaN) does not fit in TYPE_NAME.
+ */
+template <typename TYPE_NAME> bool GetNumberAs( const json_spirit::Value& Val, TYPE_NAME& Data )
+{
+	double Number;
+	if ( TryGetReal( Val, Number ) == false )
+	{
+		return false;
+	}
+
+	if ( std::numeric_limits<TYPE_NAME>::is_integer )
+	{
+		// Exact bounds: 2^digits is max+1, -2^digits is min for signed types
+		const double Upper = std::ldexp( 1.0, std::numeric_limits<TYPE_NAME>::digits );
+		const double Lower = std::numeric_limits<TYPE_NAME>::is_signed ? -Upper : 0.0;
+		Number = std::trunc( Number );
+		// A NaN fails both comparisons
+		if ( (Number >= Lower && Number < Upper) == false )
+		{
+			return false;
+		}
+	}
+	Data = static_cast<TYPE_NAME>( Number );
+	return true;
+}
+
+/** @brief Access the internal string
+ * @return a pointer to the string (valid until Val is modified) or NULL if it is not a string
+ */
+inline const std::string * GetStringView( const json_spirit::Value& Val )
+{
+	if ( Val.type() != json_spirit::str_type )
+	{
+		return (const std::string *)NULL;
+	}
+	return &Val.get_str();
+}
+
+/** @brief Access the internal array in place
+ * @return a pointer to the array or NULL if Val is not an array
+ */
+inline const SerializeArray * GetArrayView( const json_spirit::Value& Val )
+{
+	if ( Val.type() != json_spirit::array_type )
+	{
+		return (const SerializeArray *)NULL;
+	}
+	return &Val.get_array();
+}
+
+inline SerializeArray * GetArrayView( json_spirit::Value& Val )
+{
+	if ( Val.type() != json_spirit::array_type )
+	{
+		return (SerializeArray *)NULL;
+	}
+	return &Val.get_array();
+}
+
+/** @brief Access the internal object in place
+ * @return a pointer to the object or NULL if Val is not an object
+ */
+inline const SerializeObject * GetObjectView( const json_spirit::Value& Val )
+{
+	if ( Val.type() != json_spirit::obj_type )
+	{
+		return (const SerializeObject *)NULL;
+	}
+	return &Val.get_obj();
+}
+
+inline SerializeObject * GetObjectView( json_spirit::Value& Val )
+{
+	if ( Val.type() != json_spirit::obj_type )
+	{
+		return (SerializeObject *)NULL;
+	}
+	return &Val.get_obj();
+}
+
+class SerializeValue : public json_spirit::Value
+{
+public:
+	SerializeValue();
+	SerializeValue( const SerializeValue& Val );
+	SerializeValue( const json_spirit::Value& Val );
+	SerializeValue( const long Val );
+	SerializeValue( const int Val );
+	SerializeValue( const unsigned int Val );
+	SerializeValue( const bool Val );
+	SerializeValue( const double Val );
+	SerializeValue( const float Val );
+	SerializeValue( const SimpleString& Val );
+	SerializeValue( const char * Val );
+
+	operator json_spirit::Value();
+	operator int();
+	operator unsigned int();
+	operator bool();
+	operator double();
+	operator float();
+	operator SimpleString();
+	operator char*();
+
+	SerializeValue& operator=( const SerializeValue& Val );
+ 	SerializeValue& operator=( const json_spirit::Value& Val );
+	SerializeValue& operator=( const long Val );
+	SerializeValue& operator=( const int Val );
+	SerializeValue& operator=( const unsigned int Val );
+	SerializeValue& operator=( const bool Val );
+	SerializeValue& operator=( const double Val );
+	SerializeValue& operator=( const float Val );
+	SerializeValue& operator=( const SimpleString& Val );
+	SerializeValue& operator=( const char* Val );
+
+	bool IsAnObject() const;
+	bool IsASimpleValue() const;
+	bool IsNullValue() const;
+	bool IsAnArray() const;
+
+	/** @brief Find a member of this object without throwing any exception, see Omiscid::TryFindMember
+	 */
+	const json_spirit::Value * TryFindMember( const SimpleString& Key ) const;
+
+	/** @brief Get an element of this array, see Omiscid::TryGetElement */
+	const json_spirit::Value * TryGetElement( size_t Index ) const
+	{
+		return Omiscid::TryGetElement( *this, Index );
+	}
+
+	// Typed accessors without exception nor copy, see the free functions below
+
+	bool TryGetInt( int& Val ) const
+	{
+		return Omiscid::TryGetInt( *this, Val );
+	}
+
+	bool TryGetReal( double& Val ) const
+	{
+		return Omiscid::TryGetReal( *this, Val );
+	}
+
+	bool TryGetBool( bool& Val ) const
+	{
+		return Omiscid::TryGetBool( *this, Val );
+	}
+
+	template <typename TYPE_NAME> bool GetNumberAs( TYPE_NAME& Val ) const
+	{
+		return Omiscid::GetNumberAs( *this, Val );
+	}
+
+	const std::string * GetStringView() const
+	{
+		return Omiscid::GetStringView( *this );
+	}
+
+	const SerializeArray * GetArrayView() const
+	{
+		return Omiscid::GetArrayView( *this );
+	}
+
+	SerializeArray * GetArrayView()
+	{
+		return Omiscid::GetArrayView( *this );
+	}
+
+	const SerializeObject * GetObjectView() const
+	{
+		return Omiscid::GetObjectView( *this );
+	}
+
+	SerializeObject * GetObjectView()
+	{
+		return Omiscid::GetObjectView( *this );
+	}
+};
+
+// int management
+	// Encoding functions
+	SerializeValue SerializeLong( long Data );
+	SerializeValue SerializeLongFromAddress( void * pData );
+	// Decoding functions
+	int UnserializeLong( const json_spirit::Value& Val );
+	void UnserializeLongFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( long Data ) { return SerializeLong(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, long * pData ) { UnserializeLongFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, long& Data ) { Data = UnserializeLong(Val); }
+
+// int management
+	// Encoding functions
+	SerializeValue SerializeInt( int Data );
+	SerializeValue SerializeIntFromAddress( void * pData );
+	// Decoding functions
+	int UnserializeInt( const json_spirit::Value& Val );
+	void UnserializeIntFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( int Data ) { return SerializeInt(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, int * pData ) { UnserializeIntFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, int& Data ) { Data = UnserializeInt(Val); }
+
+// short int management
+	// Encoding functions
+	SerializeValue SerializeShortInt( short int Data );
+	SerializeValue SerializeShortIntFromAddress( void * pData );
+	// Decoding functions
+	short int UnserializeShortInt( const json_spirit::Value& Val );
+	void UnserializeShortIntFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( short int Data ) { return SerializeShortInt(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, short int * pData ) { UnserializeShortIntFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, short int& Data ) { Data = UnserializeShortInt(Val); }
+
+// unsigned int management
+// unsigned are not supported due to incompatibility among programming language
+	// Encoding functions
+	SerializeValue SerializeUnsignedInt( unsigned int Data );
+	SerializeValue SerializeUnsignedIntFromAddress( void * pData );
+	// Decoding functions
+	unsigned int UnserializeUnsignedInt( const json_spirit::Value& Val );
+	void UnserializeUnsignedIntFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( unsigned int Data ) { return SerializeUnsignedInt(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned int * pData ) { UnserializeUnsignedIntFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned int& Data ) { Data = UnserializeUnsignedInt(Val); }
+
+// unsigned short management
+	// Encoding functions
+	SerializeValue SerializeUnsignedShort( unsigned short Data );
+	SerializeValue SerializeUnsignedShortFromAddress( void * pData );
+	// Decoding functions
+	unsigned short UnserializeUnsignedShort( const json_spirit::Value& Val );
+	void UnserializeUnsignedShortFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( unsigned short Data ) { return SerializeUnsignedShort(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned short * pData ) { UnserializeUnsignedShortFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned short& Data ) { Data = UnserializeUnsignedShort(Val); }
+
+// char management
+	// Encoding functions
+	SerializeValue SerializeChar( char Data );
+	SerializeValue SerializeCharFromAddress( void * pData );
+	// Decoding functions
+	char UnserializeChar( const json_spirit::Value& Val );
+	void UnserializeCharFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( char Data ) { return SerializeChar(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, char * pData ) { UnserializeCharFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, char& Data ) { Data = UnserializeChar(Val); }
+
+// unsigned char management
+	// Encoding functions
+	SerializeValue SerializeUnsignedChar( unsigned char Data );
+	SerializeValue SerializeUnsignedChar( void * pData );
+	// Decoding functions
+	unsigned char UnserializeUnsignedChar( const json_spirit::Value& Val );
+	void UnserializeUnsignedCharFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( unsigned char Data ) { return SerializeUnsignedChar(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned char * pData ) { UnserializeUnsignedCharFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, unsigned char& Data ) { Data = UnserializeUnsignedChar(Val); }
+
+// double management
+	// Encoding functions
+	SerializeValue SerializeDouble( double Data );
+	SerializeValue SerializeDoubleFromAddress( void * pData );
+	// Decoding functions
+	double UnserializeDouble( const json_spirit::Value& Val );
+	void UnserializeDoubleFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( double Data ) { return SerializeDouble(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, double * pData ) { UnserializeDoubleFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, double& Data ) { Data = UnserializeDouble(Val); }
+
+// float management
+	// Encoding functions
+	SerializeValue SerializeFloat( float Data );
+	SerializeValue SerializeFloatFromAddress( void * pData );
+	// Decoding functions
+	float UnserializeFloat( const json_spirit::Value& Val );
+	void UnserializeFloatFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( float Data ) { return SerializeFloat(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, float * pData ) { UnserializeFloatFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, float& Data ) { Data = UnserializeFloat(Val); }
+
+// bool management
+	// Encoding functions
+	SerializeValue SerializeBool( bool Data );
+	SerializeValue SerializeBoolFromAddress( void * pData );
+	// Decoding functions
+	bool UnserializeBool( const json_spirit::Value& Val );
+	void UnserializeBoolFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( bool Data ) { return SerializeBool(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, bool * pData ) { UnserializeBoolFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, bool& Data ) { Data = UnserializeBool(Val); }
+
+// SimpleString management
+	// Encoding functions
+	SerializeValue SerializeSimpleString( SimpleString& Data );
+	SerializeValue SerializeSimpleStringFromAddress( void * pData );
+	// Decoding functions
+	SimpleString UnserializeSimpleString( const json_spirit::Value& Val );
+	void UnserializeSimpleStringFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( SimpleString& Data ) { return SerializeSimpleString(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, SimpleString * pData ) { UnserializeSimpleStringFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, SimpleString& Data ) { Data = UnserializeSimpleString(Val); }
+
+// char * management
+	// Encoding functions
+	SerializeValue SerializeCharStar( char * Data );
+	SerializeValue SerializeCharStarFromAddress( void * pData );
+	// Decoding functions
+	char * UnserializeCharStar( const json_spirit::Value& Val );
+	void UnserializeCharStarFromAddress( const json_spirit::Value& Val, void * pData );
+	// Generic versions
+	inline SerializeValue Serialize( char * Data ) { return SerializeCharStar(Data); }
+	inline void Unserialize( const json_spirit::Value& Val, char ** pData ) { UnserializeCharStarFromAddress(Val,(void*)pData); }
+	inline void Unserialize( const json_spirit::Value& Val, char *& Data ) { Data = UnserializeCharStar(Val); }
+
+// Container decoders, declared before use: argument dependent lookup does not
+// look in Omiscid for nested containers of json_spirit::Value elements
+	template <typename TYPE_NAME> void Unserialize( const json_spirit::Value& Val, SimpleList<TYPE_NAME> * pData );
+	template <typename TYPE_NAME> void Unserialize( const json_spirit::Value& Val, std::vector<TYPE_NAME> * pData );
+	template <typename TYPE_NAME> void Unserialize( const json_spirit::Value& Val, std::list<TYPE_NAME> * pData );
+
+// In place decoding of container elements
+	template <typename TYPE_NAME> inline void UnserializeElementInPlace( const json_spirit::Value& Val, TYPE_NAME& Element )
+	{
+		Unserialize( Val, &Element );
+	}
+	// std::vector<bool> does not give access to its elements by address
+	inline void UnserializeElementInPlace( const json_spirit::Value& Val, std::vector<bool>::reference Element )
+	{
+		Element = UnserializeBool( Val );
+	}
+
+// SimleList management
+	// Encoding functions
+	template <typename TYPE_NAME> SerializeValue SerializeSimpleList( SimpleList<TYPE_NAME>& Data )
+	{
+		SerializeArray ValArray;
+		for( Data.First(); Data.NotAtEnd(); Data.Next() )
+		{
+			ValArray.push_back( Serialize(Data.GetCurrent()) );
+		}
+		return SerializeValue(ValArray);
+	}
+
+	template <typename TYPE_NAME> SerializeValue SerializeSimpleListFromAddress( SimpleList<TYPE_NAME> * pAddress )
+	{
+		SimpleList<TYPE_NAME> * pData = (SimpleList<TYPE_NAME> *)pAddress;
+
+		SerializeArray ValArray;
+		for( pData->First(); pData->NotAtEnd(); pData->Next() )
+		{
+			ValArray.push_back( Serialize(pData->GetCurrent()) );
+		}
+		return SerializeValue(ValArray);
+	}
+	// Decoding functions
+	template <typename TYPE_NAME> void UnserializeSimpleListFromAddress( const json_spirit::Value& Val, SimpleList<TYPE_NAME> * pAddress )
+	{
+		if ( Val.type() != json_spirit::array_type )
+		{
+			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
+		}
+		SimpleList<TYPE_NAME> * pData = (SimpleList<TYPE_NAME> *)pAddress;
+		const SerializeArray& ValArray = Val.get_array();
+		SerializeArrayConstIterator it;
+
+		// Overwrite existing elements, only add or remove the difference
+		// (decoders take the json_spirit::Value elements, no copy needed)
+		pData->First();
+		for( it = ValArray.begin(); it != ValArray.end(); ++it )
+		{
+			if ( pData->NotAtEnd() )
+			{
+				UnserializeElementInPlace( *it, pData->GetCurrent() );
+				pData->Next();
+			}
+			else
+			{
+				TYPE_NAME Listelement;
+				Unserialize( *it, &Listelement );
+				pData->AddTail( Listelement );
+			}
+		}
+		while( pData->NotAtEnd() )
+		{
+			pData->RemoveCurrent();
+			pData->Next();
+		}
+	}
+	template <typename TYPE_NAME> SimpleList<TYPE_NAME> UnserializeSimpleList( const json_spirit::Value& Val )
+	{
+		SimpleList<TYPE_NAME> ResultList;
+		UnserializeSimpleListFromAddress<TYPE_NAME>( Val, &ResultList );
+		return ResultList;
+	}
+	// Generic versions
+	template <typename TYPE_NAME> inline SerializeValue Serialize( SimpleList<TYPE_NAME>& Data ) { return SerializeSimpleListFromAddress<TYPE_NAME>(&Data); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, SimpleList<TYPE_NAME> * pData ) { UnserializeSimpleListFromAddress<TYPE_NAME>(Val,pData); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, SimpleList<TYPE_NAME>& Data ) { UnserializeSimpleListFromAddress<TYPE_NAME>(Val,&Data); }
+
+// std::vector management
+	// Encoding functions
+	template <typename TYPE_NAME> SerializeValue SerializeStdVector( std::vector<TYPE_NAME>& Data )
+	{
+		SerializeArray ValArray;
+		typename std::vector<TYPE_NAME>::const_iterator it;
+		for( it = Data.begin(); it != Data.end(); ++it )
+		{
+			ValArray.push_back( Serialize(*it) );
+		}
+		return SerializeValue(ValArray);
+	}
+
+	template <typename TYPE_NAME> SerializeValue SerializeStdVectorFromAddress( std::vector<TYPE_NAME> * pData )
+	{
+		SerializeArray ValArray;
+		typename std::vector<TYPE_NAME>::const_iterator it;
+		for( it = pData->begin(); it != pData->end(); ++it )
+		{
+			ValArray.push_back( Serialize(*it) );
+		}
+		return SerializeValue(ValArray);
+	}
+	// Decoding functions
+	template <typename TYPE_NAME> void UnserializeStdVectorFromAddress( const json_spirit::Value& Val, std::vector<TYPE_NAME> * pData )
+	{
+		if ( Val.type() != json_spirit::array_type )
+		{
+			throw SerializeException( "Parameter must be a Serialized Array", SerializeException::IllegalTypeConversion  );
+		}
+		const SerializeArray& ValArray = Val.get_array();
+
+		// No reallocation when the vector already has the capacity, elements are decoded in place
+		pData->resize( ValArray.size() );
+		for( size_t i = 0; i < ValArray.size(); i++ )
+		{
+			UnserializeElementInPlace( ValArray[i], (*pData)[i] );
+		}
+	}
+	template <typename TYPE_NAME> std::vector<TYPE_NAME> UnserializeStdVector( const json_spirit::Value& Val )
+	{
+		std::vector<TYPE_NAME> ResultVector;
+		UnserializeStdVectorFromAddress<TYPE_NAME>( Val, &ResultVector );
+		return ResultVector;
+	}
+	// Generic versions
+	template <typename TYPE_NAME> inline SerializeValue Serialize( std::vector<TYPE_NAME>& Data ) { return SerializeStdVectorFromAddress<TYPE_NAME>(&Data); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, std::vector<TYPE_NAME> * pData ) { UnserializeStdVectorFromAddress<TYPE_NAME>(Val,pData); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, std::vector<TYPE_NAME>& Data ) { UnserializeStdVectorFromAddress<TYPE_NAME>(Val,&Data); }
+
+// std::list management
+	// Encoding functions
+	template <typename TYPE_NAME> SerializeValue SerializeStdList( std::list<TYPE_NAME>& Data )
+	{
+		SerializeArray ValArray;
+		typename std::list<TYPE_NAME>::const_iterator it;
+		for( it = Data.begin(); it != Data.end(); ++it )
+		{
+			ValArray.push_back( Serialize(*it) );
+		}
+		return SerializeValue(ValArray);
+	}
+
+	template <typename TYPE_NAME> SerializeValue SerializeStdListFromAddress( std::list<TYPE_NAME> * pData )
+	{
+		SerializeArray ValArray;
+		typename std::list<TYPE_NAME>::const_iterator it;
+		for( it = pData->begin(); it != pData->end(); ++it )
+		{
+			ValArray.push_back( Serialize(*it) );
+		}
+		return SerializeValue(ValArray);
+	}
+	// Decoding functions
+	template <typename TYPE_NAME> void UnserializeStdListFromAddress( const json_spirit::Value& Val, std::list<TYPE_NAME> * pData )
+	{
+		if ( Val.type() != json_spirit::array_type )
+		{
+			throw SerializeException( "Parameter must be a Serialize Array", SerializeException::IllegalTypeConversion  );
+		}
+		const SerializeArray& ValArray = Val.get_array();
+		SerializeArrayConstIterator it;
+		typename std::list<TYPE_NAME>::iterator itData = pData->begin();
+
+		// Overwrite existing elements, only add or remove the difference
+		for( it = ValArray.begin(); it != ValArray.end(); ++it )
+		{
+			if ( itData != pData->end() )
+			{
+				UnserializeElementInPlace( *it, *itData );
+				++itData;
+			}
+			else
+			{
+				TYPE_NAME Listelement;
+				Unserialize( *it, &Listelement );
+				pData->push_back( Listelement );
+			}
+		}
+		pData->erase( itData, pData->end() );
+	}
+	template <typename TYPE_NAME> std::list<TYPE_NAME> UnserializeStdList( const json_spirit::Value& Val )
+	{
+		std::list<TYPE_NAME> ResultList;
+		UnserializeStdListFromAddress<TYPE_NAME>( Val, &ResultList );
+		return ResultList;
+	}
+	// Generic versions
+	template <typename TYPE_NAME> inline SerializeValue Serialize( std::list<TYPE_NAME>& Data ) { return SerializeStdListFromAddress<TYPE_NAME>(&Data); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, std::list<TYPE_NAME> * pData ) { UnserializeStdListFromAddress<TYPE_NAME>(Val,pData); }
+	template <typename TYPE_NAME> inline void Unserialize( const json_spirit::Value& Val, std::list<TYPE_NAME>& Data ) { UnserializeStdListFromAddress<TYPE_NAME>(Val,&Data); }
+
+} // Omiscid
+
+#endif // __SERIALIZE_VALUE_H__
 
@@ -11,6 +11,10 @@
 #include <System/SimpleString.h>
 #include <System/Message.h>
 
+#include <Messaging/SerializeHash.h>
+
+#include <atomic>
+
 // #include <Com/Message.h>
 
 #include <Messaging/SerializeValue.h>
@@ -113,6 +117,24 @@ public:
   */
   ~StructuredMessage();
 
+ /** @brief Empty the message (it becomes an empty object)
+  * The capacity of the top level object is kept for next Put calls.
+  */
+  void Reset();
+
+ /** @brief Parse a serialized text into this message, reusing its memory
+  *
+  * The previous content is overwritten in place: strings and nested
+  * containers keep their capacity. Parsing messages with the same shape
+  * in a loop does not allocate memory after the first message.
+  * @param Text [in] the serialized text
+  * @param Length [in] the length of the text
+  * @exception SerializeException if the text is not valid, the message is reset
+  */
+  void ParseInto( const char * Text, size_t Length );
+  void ParseInto( const SimpleString& Text );
+  void ParseInto( const Message& Msg );
+
   operator SerializeValue() const
   {
 	  return Serializer;
@@ -137,16 +159,50 @@ public:
   void Put( const SimpleString Key, const SerializeValue& Val );
   void Put( const SimpleString Key, const SerializeObject& Val );
 
-  operator SimpleString()
+  /** @brief Conversion to the cached text using the Indented static mode
+   * A reference, so that functions taking a const SimpleString& get the
+   * cached text without copy. SimpleString is not reference counted: a
+   * SimpleString object built from the message is still a copy of the text.
+   */
+  operator const SimpleString&()
+  {
+	  return GetText( Indented );
+  }
+
+ /** @brief Get the serialized text of the message
+  *
+  * The text is computed once per indentation mode and kept until
+  * the message is modified (Put, operator=, ParseInto, Reset).
+  * Sending an unchanged message many times does not format it again.
+  * Concurrent calls on the same unmodified message are safe, the first
+  * text built is kept and the others are dropped.
+  * @param IndentedText [in] do we want the indented or the compact text
+  * @return a reference to the cached text, valid until the message is modified
+  */
+  const SimpleString& GetText( bool IndentedText ) const;
+
+ /** @brief Get the serialized text of the message using the Indented static mode
+  */
+  const SimpleString& GetText() const
+  {
+	  return GetText( Indented );
+  }
+
+ /** @brief Get the structural hash of the message (see SerializeHash)
+  *
+  * Like the text, the hash is computed once and kept until the message is modified.
+  * @param Order [in] is the order of the keys in objects significant
+  */
+  uint64_t GetHash( SerializeHash::ObjectKeyOrder Order = SerializeHash::OrderedKeys ) const;
+
+ /** @brief Structural equality, stops at the first difference
+  * If both hashes (OrderedKeys) are already cached, different hashes
+  * answer without comparing the content.
+  */
+  bool operator==( const StructuredMessage& SMsg ) const;
+  bool operator!=( const StructuredMessage& SMsg ) const
   {
-	  if ( Indented == true )
-	  {
-		  return SimpleString(json_spirit::write_formatted(Serializer).c_str());
-	  }
-	  else
-	  {
-		  return SimpleString(json_spirit::write(Serializer).c_str());
-	  }
+	  return !(*this == SMsg);
   }
 
  /** \find Find an element value hashed by Key
@@ -155,6 +211,30 @@ public:
   */
   SerializeValue FindAndGetValue( const SimpleString& Key ) const;
 
+ /** \find Find an element value hashed by Key without throwing any exception
+  * @param Key [in] the key to identifies the pair.
+  * @return a pointer to the value (valid until the message is modified), NULL if not found
+  */
+  const json_spirit::Value * TryFind( const SimpleString& Key ) const;
+
+ /** \find Get a copy of an element value hashed by Key without throwing any exception
+  * @param Key [in] the key to identifies the pair.
+  * @param Val [out] the value if found
+  * @return false if not found or if the value has not the requested type
+  */
+  bool TryGetValue( const SimpleString& Key, SerializeValue& Val ) const;
+  bool TryGetValue( const SimpleString& Key, int& Val ) const;
+  bool TryGetValue( const SimpleString& Key, double& Val ) const;
+  bool TryGetValue( const SimpleString& Key, bool& Val ) const;
+  bool TryGetValue( const SimpleString& Key, SimpleString& Val ) const;
+
+ /** @brief Access to the underlying value without copy
+  */
+  const SerializeValue& GetValue() const
+  {
+	  return Serializer;
+  }
+
  /** operator=
   */
   StructuredMessage& operator=( SerializeValue& SerValue );
@@ -184,7 +264,24 @@ protected:
   */
   SerializeObjectIterator Find( const SimpleString& Key );
 
+ /** @brief Drop cached texts and hashes, must be called by any function modifying Serializer
+  */
+  void InvalidateCachedText();
+
+ /** @brief Copy cached texts and hashes from another message with the same content
+  */
+  void CopyCachedText( const StructuredMessage& SMsg );
+
   SerializeValue Serializer;
+
+  // Const readers may fill the caches concurrently, without lock: a text is
+  // allocated on first use and installed by compare and swap, it is never
+  // modified afterwards. A hash is stored before its flag is set (release).
+  // Messages whose text is never asked only pay for the null pointers.
+  mutable std::atomic<const SimpleString*> CachedText[2] = { {NULL}, {NULL} };	/*!< compact [0] and indented [1] texts */
+
+  mutable std::atomic<uint64_t> CachedHash[2] = { {0}, {0} };	/*!< hashes for OrderedKeys [0] and UnorderedKeys [1] */
+  mutable std::atomic<bool> CachedHashIsValid[2] = { {false}, {false} };
 };
 
 } // Omiscid
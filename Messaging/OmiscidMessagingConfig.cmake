@@ -21,6 +21,13 @@
 #      - OmiscidMessaging_HDRS         : The Omiscid Messaging header files.
 #      - OmiscidMessaging_LIBS         : The Omiscid Messaging mandatory libs.
 #
+#    and the following function:
+#      - omiscid_generate_messages(Schema OutputHeader) : generate C++ message
+#        structures with dedicated JSON/binary codecs from a JSON schema (see
+#        Tools/OmiscidIdlCompiler.cpp). The OmiscidIdlCompiler tool is built
+#        the first time the function is called. Add OutputHeader to the sources
+#        of a target to generate it before the target is compiled.
+#
 #  =============================================================================
 
 set(OmiscidMessaging_FOUND TRUE CACHE BOOL "Omiscid found")
@@ -56,4 +63,23 @@ file(GLOB GlobRes
 )
 set(OmiscidMessaging_HDRS ${GlobRes} CACHE INTERNAL "Omiscid Messaging header files.")
 
-set(OmiscidMessaging_LIBS "" CACHE INTERNAL "Omsicid Messaging libraries to link with.")
\ No newline at end of file
+set(OmiscidMessaging_LIBS "" CACHE INTERNAL "Omsicid Messaging libraries to link with.")
+
+# message schema compiler
+function(omiscid_generate_messages Schema OutputHeader)
+	if (NOT TARGET OmiscidIdlCompiler)
+		get_filename_component(IdlJsonFolder "${OmiscidMessaging_ROOT_PATH}/../Json/" REALPATH)
+		file(GLOB IdlJsonSrcs "${IdlJsonFolder}/*.cpp")
+		add_executable(OmiscidIdlCompiler "${OmiscidMessaging_ROOT_PATH}/Tools/OmiscidIdlCompiler.cpp" ${IdlJsonSrcs})
+		target_include_directories(OmiscidIdlCompiler PRIVATE ${IdlJsonFolder})
+	endif()
+
+	get_filename_component(SchemaPath ${Schema} ABSOLUTE)
+	get_filename_component(OutputPath ${OutputHeader} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
+	add_custom_command(
+		OUTPUT ${OutputPath}
+		COMMAND OmiscidIdlCompiler ${SchemaPath} ${OutputPath}
+		DEPENDS OmiscidIdlCompiler ${SchemaPath}
+		COMMENT "Generating ${OutputHeader} from ${Schema}"
+	)
+endfunction()
\ No newline at end of file
@@ -10,15 +10,19 @@
 
 using namespace Omiscid;
 
+/* static */
+/** @brief Static variable to define if numeric containers are encoded as packed arrays (default PackNumericContainers=false)
+  */
+bool Serializable::PackNumericContainers = false;
 
-Serializable::Serializable()
-	: SerializationDeclared(false)
+Serializable::Serializable( ConcurrencyPolicy Policy /* = LockedAccess */ )
+	: CurrentPolicy(Policy), CurrentDeltaTrackingMode(NoDeltaTracking), SerializationDeclared(false)
 {
 }
 
 Serializable::~Serializable()
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	while( SerialiseMapping.IsNotEmpty() )
 	{
@@ -95,7 +99,7 @@ Serializable::EncodeMapping * Serializable::Create( const SimpleString& Key ) th
 
 void Serializable::AddToSerialization( const SimpleString& Key, long& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -106,11 +110,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, long& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeLongFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeLongFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, int& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -121,6 +126,7 @@ void Serializable::AddToSerialization( const SimpleString& Key, int& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeIntFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeIntFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, unsigned int& Val )
@@ -131,7 +137,7 @@ void Serializable::AddToSerialization( const SimpleString& Key, unsigned int& Va
 
 void Serializable::AddToSerialization( const SimpleString& Key, short int& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -142,11 +148,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, short int& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeShortIntFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeShortIntFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, unsigned short& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -157,11 +164,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, unsigned short&
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeUnsignedShortFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeUnsignedShortFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, double& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -172,11 +180,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, double& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeDoubleFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeDoubleFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::real_type) | EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, float& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -187,11 +196,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, float& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeFloatFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeFloatFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::real_type) | EncodeMapping::TypeBit(json_spirit::int_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, bool& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -202,11 +212,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, bool& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeBoolFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeBoolFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::bool_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, SimpleString& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -217,11 +228,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, SimpleString& Va
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeSimpleStringFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeSimpleStringFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::str_type) | EncodeMapping::TypeBit(json_spirit::null_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, char *& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -232,11 +244,12 @@ void Serializable::AddToSerialization( const SimpleString& Key, char *& Val )
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeCharStarFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeCharStarFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::str_type);
 }
 
 void Serializable::AddToSerialization( const SimpleString& Key, Serializable& Val )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
@@ -247,12 +260,78 @@ void Serializable::AddToSerialization( const SimpleString& Key, Serializable& Va
 	tmpMapping->AddressOfObject = (void*)&Val;
 	tmpMapping->FunctionToEncode = SerializeSerializableFromAddress;
 	tmpMapping->FunctionToDecode = UnserializeSerializableFromAddress;
+	tmpMapping->AcceptedTypes = EncodeMapping::TypeBit(json_spirit::obj_type);
+	tmpMapping->FunctionToStream = StreamSerializableFromAddress;
 }
 
-SerializeValue Serializable::Serialize()
+void Serializable::SetConcurrencyPolicy( ConcurrencyPolicy NewPolicy )
 {
+	// Always lock here, we may leave the LockedAccess policy
 	SmartLocker SL_this((const LockableObject&)*this);
 
+	CurrentPolicy.store( NewPolicy, std::memory_order_release );
+	if ( NewPolicy != SnapshotAccess )
+	{
+		// Free previous snapshot if any
+		std::atomic_store( &Snapshot, std::shared_ptr<const SerializeValue>() );
+	}
+}
+
+void Serializable::PublishSnapshot()
+{
+	std::shared_ptr<const SerializeValue> NewSnapshot;
+	{
+		SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+		NewSnapshot = std::make_shared<const SerializeValue>( EncodeMappings() );
+	}
+
+	// Readers will get the new snapshot from now, previous one is freed by its last reader
+	std::atomic_store( &Snapshot, NewSnapshot );
+}
+
+std::shared_ptr<const SerializeValue> Serializable::GetSnapshot() const
+{
+	return std::atomic_load( &Snapshot );
+}
+
+SerializeValue Serializable::Serialize()
+{
+	if ( GetConcurrencyPolicy() == SnapshotAccess )
+	{
+		std::shared_ptr<const SerializeValue> CurrentSnapshot = std::atomic_load( &Snapshot );
+		if ( CurrentSnapshot )
+		{
+			// Published snapshots are never modified, no need to lock
+			return *CurrentSnapshot;
+		}
+		// No snapshot yet, encode the object as usual
+	}
+
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	return EncodeMappings();
+}
+
+std::shared_ptr<const SerializeValue> Serializable::SerializeShared()
+{
+	if ( GetConcurrencyPolicy() == SnapshotAccess )
+	{
+		std::shared_ptr<const SerializeValue> CurrentSnapshot = std::atomic_load( &Snapshot );
+		if ( CurrentSnapshot )
+		{
+			// Shared with the other readers, no copy
+			return CurrentSnapshot;
+		}
+	}
+
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	return std::make_shared<const SerializeValue>( EncodeMappings() );
+}
+
+SerializeValue Serializable::EncodeMappings()
+{
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
 
@@ -271,12 +350,85 @@ SerializeValue Serializable::Serialize()
 	return MySMsg;
 }
 
+void Serializable::SerializeToStream( SerializeStream& Stream )
+{
+	if ( GetConcurrencyPolicy() == SnapshotAccess )
+	{
+		std::shared_ptr<const SerializeValue> CurrentSnapshot = std::atomic_load( &Snapshot );
+		if ( CurrentSnapshot )
+		{
+			// Published snapshots are never modified, no need to lock
+			Stream.WriteValue( *CurrentSnapshot );
+			return;
+		}
+	}
+
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	StreamMappings( Stream );
+}
+
+void Serializable::SerializeToSink( SerializeSink& Sink, size_t ChunkSize /* = SerializeStream::DefaultChunkSize */ )
+{
+	SerializeStream Stream( Sink, ChunkSize );
+
+	SerializeToStream( Stream );
+
+	Stream.Flush();
+}
+
+void Serializable::StreamMappings( SerializeStream& Stream )
+{
+	// Check if SerializeMappingIsDone
+	CallDeclareSerializeMappingIfNeeded();
+
+	// Call Pre serializable function
+	PreSerializableFonction();
+
+	if ( SerialiseMapping.IsEmpty() )
+	{
+		// Same text as the empty StructuredMessage returned by EncodeMappings
+		Stream.Write( "null", 4 );
+		return;
+	}
+
+	Stream.Write( '{' );
+	bool First = true;
+	for( SerialiseMapping.First(); SerialiseMapping.NotAtEnd(); SerialiseMapping.Next() )
+	{
+		Serializable::EncodeMapping * tmpMapping = SerialiseMapping.GetCurrent();
+
+		if ( First == false )
+		{
+			Stream.Write( ',' );
+		}
+		First = false;
+
+		Stream.WriteKey( tmpMapping->GetKey() );
+		tmpMapping->Stream( Stream );
+	}
+	Stream.Write( '}' );
+}
+
 void Serializable::Unserialize( const SimpleString& SerializedVal )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	StructuredMessage sMsg( SerializedVal );
 
+	DecodeMappings( sMsg.GetValue() );
+}
+
+
+void Serializable::Unserialize( const json_spirit::Value& SerializedVal )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	DecodeMappings( SerializedVal );
+}
+
+void Serializable::DecodeMappings( const json_spirit::Value& SerializedVal )
+{
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
 
@@ -285,45 +437,200 @@ void Serializable::Unserialize( const SimpleString& SerializedVal )
 	{
 		Serializable::EncodeMapping * tmpMapping = SerialiseMapping.GetCurrent();
 
-		try
-		{
-			tmpMapping->Decode( sMsg.FindAndGetValue( tmpMapping->Key ) );
-		}
-		catch( SimpleException& Ex )
+		// No exception for missing fields, just a pointer check
+		const json_spirit::Value * pFieldValue = TryFindMember( SerializedVal, tmpMapping->Key );
+		if ( pFieldValue == (const json_spirit::Value *)NULL )
 		{
 			if ( PartialUnserializationAllowed == false )
 			{
 				// Partial is not allowed, thow up!
-				throw Ex;
+				throw SerializeException( "Key not found: " + tmpMapping->Key, SerializeException::UnknownField );
 			}
 			// Ok, go ahead
+			continue;
 		}
+
+		DecodeField( tmpMapping, *pFieldValue );
 	}
 
 	// Call Post serializable function
 	PostSerializableFonction();
+
+	if ( GetConcurrencyPolicy() == SnapshotAccess )
+	{
+		// Object was modified, readers must see the new values
+		PublishSnapshot();
+	}
 }
 
+void Serializable::SetDeltaTrackingMode( DeltaTrackingMode NewMode )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	CurrentDeltaTrackingMode = NewMode;
+
+	// Next delta will be a full one
+	MarkAllDirty();
+}
 
-void Serializable::Unserialize( const SerializeValue& SerializedVal )
+void Serializable::MarkDirty( const SimpleString& Key )
 {
-	SmartLocker SL_this((const LockableObject&)*this);
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
-	StructuredMessage sMsg( SerializedVal );
+	Serializable::EncodeMapping * tmpMapping = Find( Key );
+	if ( tmpMapping == (Serializable::EncodeMapping*)NULL )
+	{
+		throw SerializeException( "Unknown field " + Key, SerializeException::UnknownField );
+	}
+
+	tmpMapping->Dirty = true;
+}
+
+void Serializable::MarkAllDirty()
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
 
 	// Check if SerializeMappingIsDone
 	CallDeclareSerializeMappingIfNeeded();
 
-	// Parse serialising objet
 	for( SerialiseMapping.First(); SerialiseMapping.NotAtEnd(); SerialiseMapping.Next() )
 	{
 		Serializable::EncodeMapping * tmpMapping = SerialiseMapping.GetCurrent();
 
-		tmpMapping->Decode( sMsg.FindAndGetValue( tmpMapping->Key ) );
+		tmpMapping->Dirty = true;
+		tmpMapping->LastEncoded = SerializeValue();
+	}
+}
+
+SerializeValue Serializable::SerializeDelta()
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	if ( CurrentDeltaTrackingMode == NoDeltaTracking )
+	{
+		return EncodeMappings();
+	}
+
+	// Check if SerializeMappingIsDone
+	CallDeclareSerializeMappingIfNeeded();
+
+	// Call Pre serializable function
+	PreSerializableFonction();
+
+	StructuredMessage MySMsg;
+	SerializeObject EmptyObject;
+
+	// An empty delta is an empty object, not a null value
+	MySMsg = SerializeValue( EmptyObject );
+
+	for( SerialiseMapping.First(); SerialiseMapping.NotAtEnd(); SerialiseMapping.Next() )
+	{
+		Serializable::EncodeMapping * tmpMapping = SerialiseMapping.GetCurrent();
+
+		if ( CurrentDeltaTrackingMode == ExplicitDeltaTracking )
+		{
+			if ( tmpMapping->Dirty == true )
+			{
+				MySMsg.Put( tmpMapping->GetKey(), tmpMapping->Encode() );
+				tmpMapping->Dirty = false;
+			}
+		}
+		else
+		{
+			// AutomaticDeltaTracking, compare with the previous encoded value
+			SerializeValue CurrentValue = tmpMapping->Encode();
+			if ( tmpMapping->Dirty == true || !(CurrentValue == tmpMapping->LastEncoded) )
+			{
+				MySMsg.Put( tmpMapping->GetKey(), CurrentValue );
+				tmpMapping->LastEncoded = CurrentValue;
+				tmpMapping->Dirty = false;
+			}
+		}
+	}
+
+	return MySMsg;
+}
+
+void Serializable::ApplyDelta( const SimpleString& SerializedDelta )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	StructuredMessage sMsg( SerializedDelta );
+
+	DecodeDelta( sMsg );
+}
+
+void Serializable::ApplyDelta( const json_spirit::Value& SerializedDelta )
+{
+	SmartLocker SL_this((const LockableObject&)*this, LockIsNeeded());
+
+	DecodeDelta( SerializedDelta );
+}
+
+void Serializable::DecodeDelta( const json_spirit::Value& SerializedDelta )
+{
+	if ( SerializedDelta.type() != json_spirit::obj_type )
+	{
+		throw SerializeException( "A delta must be a serialized object", SerializeException::IllegalTypeConversion );
+	}
+
+	// Check if SerializeMappingIsDone
+	CallDeclareSerializeMappingIfNeeded();
+
+	// Walk the delta, usually much smaller than the mapping
+	const SerializeObject& Delta = SerializedDelta.get_obj();
+	for( SerializeObjectConstIterator it = Delta.begin(); it != Delta.end(); ++it )
+	{
+		Serializable::EncodeMapping * tmpMapping = Find( it->name_.c_str() );
+		if ( tmpMapping == (Serializable::EncodeMapping*)NULL )
+		{
+			if ( PartialUnserializationAllowed == false )
+			{
+				throw SerializeException( "Unknown field " + SimpleString(it->name_), SerializeException::UnknownField );
+			}
+			// Ok, go ahead
+			continue;
+		}
+
+		DecodeField( tmpMapping, it->value_ );
 	}
 
 	// Call Post serializable function
 	PostSerializableFonction();
+
+	if ( GetConcurrencyPolicy() == SnapshotAccess )
+	{
+		// Object was modified, readers must see the new values
+		PublishSnapshot();
+	}
+}
+
+void Serializable::DecodeField( EncodeMapping * Mapping, const json_spirit::Value& FieldValue )
+{
+	// Mistyped fields are detected with a branch, no exception is thrown in partial mode
+	if ( Mapping->Accepts( FieldValue ) == false )
+	{
+		if ( PartialUnserializationAllowed == false )
+		{
+			throw SerializeException( "Wrong type for field " + Mapping->Key, SerializeException::IllegalTypeConversion );
+		}
+		return;
+	}
+
+	if ( PartialUnserializationAllowed == false )
+	{
+		Mapping->Decode( FieldValue );
+		return;
+	}
+
+	try
+	{
+		Mapping->Decode( FieldValue );
+	}
+	catch( SimpleException& )
+	{
+		// A container element or a member of a nested object has a wrong type, partial is allowed, go ahead
+	}
 }
 
 namespace Omiscid {
@@ -331,7 +638,7 @@ namespace Omiscid {
 SerializeValue Serialize( Serializable& Data ) { return Data.Serialize(); }
 void Unserialize( const SimpleString& Val, Serializable * pData ) { pData->Unserialize(Val); }
 void Unserialize( const SimpleString& Val, Serializable& Data ) { Data.Unserialize(Val); }
-void Unserialize( const SerializeValue& Val, Serializable * pData ) { pData->Unserialize(Val); }
-void Unserialize( const SerializeValue& Val, Serializable& Data ) { Data.Unserialize(Val); }
+void Unserialize( const json_spirit::Value& Val, Serializable * pData ) { pData->Unserialize(Val); }
+void Unserialize( const json_spirit::Value& Val, Serializable& Data ) { Data.Unserialize(Val); }
 
 } // namespace Omiscid
\ No newline at end of file
@@ -0,0 +1,302 @@
+/* @file Messaging/SerializeBatch.cpp
+ * @ingroup Messaging
+ * @brief Implementation of SerializeBatch class
+ */
+
+#include <Messaging/SerializeBatch.h>
+
+#include <Messaging/SerializeException.h>
+
+#include <System/ThreadPool.h>
+
+#include <Json/json_spirit.h>
+
+#include <thread>
+#include <exception>
+#include <sstream>
+
+using namespace Omiscid;
+
+/* static */
+/** @brief Minimal number of objects per worker (default MinimalObjectsPerThread=64)
+  */
+size_t SerializeBatch::MinimalObjectsPerThread = 64;
+
+namespace {
+
+	// Compute the number of contiguous ranges (i.e. of threads) for a batch
+	unsigned int ComputeNumberOfRanges( size_t NbObjects, unsigned int NbThreads )
+	{
+		if ( NbThreads == 0 )
+		{
+			NbThreads = SerializeBatch::DefaultNumberOfThreads();
+		}
+
+		size_t MinPerThread = SerializeBatch::MinimalObjectsPerThread;
+		if ( MinPerThread == 0 )
+		{
+			MinPerThread = 1;
+		}
+
+		size_t NbRanges = NbObjects/MinPerThread;
+		if ( NbRanges > NbThreads )
+		{
+			NbRanges = NbThreads;
+		}
+		if ( NbRanges == 0 )
+		{
+			NbRanges = 1;
+		}
+		return (unsigned int)NbRanges;
+	}
+
+	// Process one range, keep the first exception and go on with other objects
+	template <typename WORK> void ProcessRange( WORK& Work, size_t Begin, size_t End, unsigned int Range, std::exception_ptr& FirstError )
+	{
+		for( size_t Index = Begin; Index < End; Index++ )
+		{
+			try
+			{
+				Work( Index, Range );
+			}
+			catch( ... )
+			{
+				if ( !FirstError )
+				{
+					FirstError = std::current_exception();
+				}
+			}
+		}
+	}
+
+	// Call Work(Index, Range) for all objects, ranges are processed in parallel by the
+	// shared ThreadPool and the calling thread. Rethrow the first exception in object order.
+	template <typename WORK> void RunPartitioned( size_t NbObjects, unsigned int NbRanges, WORK& Work )
+	{
+		std::vector<std::exception_ptr> Errors( NbRanges );
+
+		ThreadPool::GetSharedPool().ParallelFor( 0, NbRanges, [&]( size_t Range )
+		{
+			const size_t Begin = (NbObjects*Range)/NbRanges;
+			const size_t End = (NbObjects*(Range+1))/NbRanges;
+
+			ProcessRange( Work, Begin, End, (unsigned int)Range, Errors[Range] );
+		}, 1 );
+
+		for( unsigned int Range = 0; Range < NbRanges; Range++ )
+		{
+			if ( Errors[Range] )
+			{
+				std::rethrow_exception( Errors[Range] );
+			}
+		}
+	}
+
+	struct SerializeToArrayWork
+	{
+		Serializable * const * Objects;
+		SerializeArray * pResult;
+
+		void operator()( size_t Index, unsigned int /* Range */ )
+		{
+			// Swapped into its slot, not copied
+			SerializeValue Val = Objects[Index]->Serialize();
+			(*pResult)[Index].swap( Val );
+		}
+	};
+
+	struct SerializeToNDJSONWork
+	{
+		Serializable * const * Objects;
+		std::vector<std::ostringstream> * pBuffers;
+
+		void operator()( size_t Index, unsigned int Range )
+		{
+			std::ostringstream& Buffer = (*pBuffers)[Range];
+			// Snapshots are written without being copied
+			json_spirit::write( *Objects[Index]->SerializeShared(), Buffer );
+			Buffer << '\n';
+		}
+	};
+
+	struct UnserializeFromArrayWork
+	{
+		Serializable * const * Objects;
+		const SerializeArray * pSource;
+
+		void operator()( size_t Index, unsigned int /* Range */ )
+		{
+			Objects[Index]->Unserialize( (*pSource)[Index] );
+		}
+	};
+
+	struct UnserializeFromNDJSONWork
+	{
+		Serializable * const * Objects;
+		const char * Text;
+		const std::vector<size_t> * pLineStarts;
+		const std::vector<size_t> * pLineLengths;
+		std::vector<json_spirit::Value> * pValues;
+
+		void operator()( size_t Index, unsigned int Range )
+		{
+			// Lines are parsed in place, the value of the range is reused from line to line
+			json_spirit::Value& Val = (*pValues)[Range];
+			if ( json_spirit::read_reusing( Text + (*pLineStarts)[Index], (*pLineLengths)[Index], Val ) == false )
+			{
+				throw SerializeException( "Malformed NDJSON line", SerializeException::MalformedStream );
+			}
+			Objects[Index]->Unserialize( Val );
+		}
+	};
+
+} // anonymous namespace
+
+unsigned int SerializeBatch::DefaultNumberOfThreads()
+{
+	unsigned int NbCores = std::thread::hardware_concurrency();
+	if ( NbCores == 0 )
+	{
+		// Unknown value
+		return 1;
+	}
+	return NbCores;
+}
+
+SerializeValue SerializeBatch::SerializeAll( Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads /* = 0 */ )
+{
+	// Pre-sized array, each worker fills its own slots
+	SerializeValue Result = json_spirit::Value( SerializeArray(NbObjects) );
+
+	SerializeToArrayWork Work;
+	Work.Objects = Objects;
+	Work.pResult = &Result.get_array();
+
+	RunPartitioned( NbObjects, ComputeNumberOfRanges(NbObjects, NbThreads), Work );
+
+	return Result;
+}
+
+SerializeValue SerializeBatch::SerializeAll( const std::vector<Serializable*>& Objects, unsigned int NbThreads /* = 0 */ )
+{
+	return SerializeAll( Objects.data(), Objects.size(), NbThreads );
+}
+
+SimpleString SerializeBatch::SerializeAllToNDJSON( Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads /* = 0 */ )
+{
+	const unsigned int NbRanges = ComputeNumberOfRanges(NbObjects, NbThreads);
+	std::vector<std::ostringstream> Buffers( NbRanges );
+
+	SerializeToNDJSONWork Work;
+	Work.Objects = Objects;
+	Work.pBuffers = &Buffers;
+
+	RunPartitioned( NbObjects, NbRanges, Work );
+
+	SimpleString Result;
+	if ( NbRanges == 1 )
+	{
+		// Nothing to concatenate, take the text of the buffer
+		std::string Text = Buffers[0].str();
+		Result.swap( Text );
+		return Result;
+	}
+
+	// Concatenate per range buffers, in order
+	size_t TotalLength = 0;
+	for( unsigned int Range = 0; Range < NbRanges; Range++ )
+	{
+		TotalLength += (size_t)Buffers[Range].tellp();
+	}
+
+	Result.reserve( TotalLength );
+	for( unsigned int Range = 0; Range < NbRanges; Range++ )
+	{
+		Result.append( Buffers[Range].str() );
+	}
+	return Result;
+}
+
+SimpleString SerializeBatch::SerializeAllToNDJSON( const std::vector<Serializable*>& Objects, unsigned int NbThreads /* = 0 */ )
+{
+	return SerializeAllToNDJSON( Objects.data(), Objects.size(), NbThreads );
+}
+
+void SerializeBatch::UnserializeAll( const SerializeValue& SerializedArray, Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads /* = 0 */ )
+{
+	if ( SerializedArray.type() != json_spirit::array_type )
+	{
+		throw SerializeException( "Parameter must be a Serialized Array", SerializeException::IllegalTypeConversion );
+	}
+
+	const SerializeArray& Source = SerializedArray.get_array();
+	if ( Source.size() != NbObjects )
+	{
+		throw SerializeException( "Number of serialized objects does not match number of objects", SerializeException::InvalidFormat );
+	}
+
+	UnserializeFromArrayWork Work;
+	Work.Objects = Objects;
+	Work.pSource = &Source;
+
+	RunPartitioned( NbObjects, ComputeNumberOfRanges(NbObjects, NbThreads), Work );
+}
+
+void SerializeBatch::UnserializeAll( const SerializeValue& SerializedArray, const std::vector<Serializable*>& Objects, unsigned int NbThreads /* = 0 */ )
+{
+	UnserializeAll( SerializedArray, Objects.data(), Objects.size(), NbThreads );
+}
+
+void SerializeBatch::UnserializeAllFromNDJSON( const SimpleString& Text, Serializable * const * Objects, size_t NbObjects, unsigned int NbThreads /* = 0 */ )
+{
+	// Split lines first (cheap sequential scan), decoding is done in parallel
+	std::vector<size_t> LineStarts;
+	std::vector<size_t> LineLengths;
+	LineStarts.reserve( NbObjects );
+	LineLengths.reserve( NbObjects );
+
+	const size_t TextLength = Text.length();
+	size_t Start = 0;
+	while( Start < TextLength )
+	{
+		size_t End = Text.find( '\n', Start );
+		if ( End == std::string::npos )
+		{
+			End = TextLength;
+		}
+
+		size_t Length = End - Start;
+		if ( Length > 0 && Text[End-1] == '\r' )
+		{
+			Length--;
+		}
+		if ( Length > 0 )
+		{
+			LineStarts.push_back( Start );
+			LineLengths.push_back( Length );
+		}
+		Start = End + 1;
+	}
+
+	if ( LineStarts.size() != NbObjects )
+	{
+		throw SerializeException( "Number of serialized objects does not match number of objects", SerializeException::InvalidFormat );
+	}
+
+	const unsigned int NbRanges = ComputeNumberOfRanges(NbObjects, NbThreads);
+	std::vector<json_spirit::Value> Values( NbRanges );
+
+	UnserializeFromNDJSONWork Work;
+	Work.Objects = Objects;
+	Work.Text = Text.GetStr();
+	Work.pLineStarts = &LineStarts;
+	Work.pLineLengths = &LineLengths;
+	Work.pValues = &Values;
+
+	RunPartitioned( NbObjects, NbRanges, Work );
+}
+
+void SerializeBatch::UnserializeAllFromNDJSON( const SimpleString& Text, const std::vector<Serializable*>& Objects, unsigned int NbThreads /* = 0 */ )
+{
+	UnserializeAllFromNDJSON( Text, Objects.data(), Objects.size(), NbThreads );
+}
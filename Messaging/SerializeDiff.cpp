@@ -0,0 +1,636 @@
+/* @file Messaging/SerializeDiff.cpp
+ * @ingroup Messaging
+ * @brief Implementation of SerializeDiff class
+ */
+
+#include <Messaging/SerializeDiff.h>
+#include <Messaging/SerializeHash.h>
+
+#include <vector>
+#include <map>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Omiscid;
+
+/* static */
+/** @brief Maximal size of the LCS table (default MaxLCSTableSize=1000000)
+  */
+size_t SerializeDiff::MaxLCSTableSize = 1000000;
+
+namespace {
+
+	const size_t NotFound = (size_t)-1;
+
+	// Append an escaped token to a JSON pointer
+	void AppendPathToken( std::string& Path, const std::string& Key )
+	{
+		Path += '/';
+		for( size_t i = 0; i < Key.length(); i++ )
+		{
+			switch( Key[i] )
+			{
+				case '~':
+					Path += "~0";
+					break;
+				case '/':
+					Path += "~1";
+					break;
+				default:
+					Path += Key[i];
+			}
+		}
+	}
+
+	void AppendPathIndex( std::string& Path, size_t Index )
+	{
+		char Tmp[32];
+		snprintf( Tmp, sizeof(Tmp), "/%lu", (unsigned long)Index );
+		Path += Tmp;
+	}
+
+	// Compare array elements, hashes first
+	inline bool SameElement( const SerializeArray& From, const std::vector<uint64_t>& FromHashes, size_t i,
+		const SerializeArray& To, const std::vector<uint64_t>& ToHashes, size_t j )
+	{
+		return FromHashes[i] == ToHashes[j] && SerializeHash::Equal( From[i], To[j] );
+	}
+
+	// Build the list of operations, Path is the current JSON pointer
+	class DiffBuilder
+	{
+	public:
+		DiffBuilder( SerializeArray& Operations, SerializeDiff::ArrayDiffMode Mode )
+			: Operations(Operations), Mode(Mode)
+		{
+		}
+
+		void DiffValues( const json_spirit::Value& From, const json_spirit::Value& To );
+
+	private:
+		void AddOperation( const char * Op, const json_spirit::Value * pValue );
+		void DiffObjects( const SerializeObject& From, const SerializeObject& To );
+		void DiffArraysByIndex( const SerializeArray& From, const SerializeArray& To );
+		void DiffArraysLCS( const SerializeArray& From, const SerializeArray& To );
+
+		SerializeArray& Operations;
+		SerializeDiff::ArrayDiffMode Mode;
+		std::string Path;
+	};
+
+	void DiffBuilder::AddOperation( const char * Op, const json_spirit::Value * pValue )
+	{
+		SerializeObject Operation;
+		Operation.reserve( 3 );
+		Operation.push_back( SerializePair( "op", json_spirit::Value(Op) ) );
+		Operation.push_back( SerializePair( "path", json_spirit::Value(Path) ) );
+		if ( pValue != (const json_spirit::Value *)NULL )
+		{
+			Operation.push_back( SerializePair( "value", *pValue ) );
+		}
+		Operations.push_back( json_spirit::Value(Operation) );
+	}
+
+	void DiffBuilder::DiffValues( const json_spirit::Value& From, const json_spirit::Value& To )
+	{
+		// Same node, nothing to compare
+		if ( &From == &To )
+		{
+			return;
+		}
+
+		if ( From.type() != To.type() )
+		{
+			AddOperation( "replace", &To );
+			return;
+		}
+
+		switch( From.type() )
+		{
+			case json_spirit::obj_type:
+				DiffObjects( From.get_obj(), To.get_obj() );
+				return;
+
+			case json_spirit::array_type:
+				if ( Mode == SerializeDiff::ArrayLongestCommonSubsequence )
+				{
+					DiffArraysLCS( From.get_array(), To.get_array() );
+				}
+				else
+				{
+					DiffArraysByIndex( From.get_array(), To.get_array() );
+				}
+				return;
+
+			default:
+				// Simple values
+				if ( !(From == To) )
+				{
+					AddOperation( "replace", &To );
+				}
+				return;
+		}
+	}
+
+	void DiffBuilder::DiffObjects( const SerializeObject& From, const SerializeObject& To )
+	{
+		const size_t PathLength = Path.length();
+		std::vector<bool> Matched( To.size(), false );
+
+		// Index of destination keys, only built if keys are not in the same order
+		std::map<std::string, size_t> ToIndex;
+		bool ToIndexBuilt = false;
+
+		for( size_t i = 0; i < From.size(); i++ )
+		{
+			const std::string& Key = From[i].name_;
+			size_t j = NotFound;
+
+			// Usual case, same key at the same place
+			if ( i < To.size() && Matched[i] == false && To[i].name_ == Key )
+			{
+				j = i;
+			}
+			else
+			{
+				if ( ToIndexBuilt == false )
+				{
+					for( size_t k = 0; k < To.size(); k++ )
+					{
+						// first occurrence wins
+						ToIndex.insert( std::make_pair( To[k].name_, k ) );
+					}
+					ToIndexBuilt = true;
+				}
+
+				std::map<std::string, size_t>::const_iterator it = ToIndex.find( Key );
+				if ( it != ToIndex.end() && Matched[it->second] == false )
+				{
+					j = it->second;
+				}
+			}
+
+			AppendPathToken( Path, Key );
+			if ( j == NotFound )
+			{
+				AddOperation( "remove", (const json_spirit::Value *)NULL );
+			}
+			else
+			{
+				Matched[j] = true;
+				DiffValues( From[i].value_, To[j].value_ );
+			}
+			Path.resize( PathLength );
+		}
+
+		for( size_t j = 0; j < To.size(); j++ )
+		{
+			if ( Matched[j] == false )
+			{
+				AppendPathToken( Path, To[j].name_ );
+				AddOperation( "add", &To[j].value_ );
+				Path.resize( PathLength );
+			}
+		}
+	}
+
+	void DiffBuilder::DiffArraysByIndex( const SerializeArray& From, const SerializeArray& To )
+	{
+		const size_t PathLength = Path.length();
+		const size_t CommonSize = From.size() < To.size() ? From.size() : To.size();
+
+		for( size_t i = 0; i < CommonSize; i++ )
+		{
+			AppendPathIndex( Path, i );
+			DiffValues( From[i], To[i] );
+			Path.resize( PathLength );
+		}
+
+		// Add new elements at the end
+		for( size_t i = CommonSize; i < To.size(); i++ )
+		{
+			AppendPathIndex( Path, i );
+			AddOperation( "add", &To[i] );
+			Path.resize( PathLength );
+		}
+
+		// Remove elements from the end, indexes stay valid
+		for( size_t i = From.size(); i > CommonSize; i-- )
+		{
+			AppendPathIndex( Path, i-1 );
+			AddOperation( "remove", (const json_spirit::Value *)NULL );
+			Path.resize( PathLength );
+		}
+	}
+
+	void DiffBuilder::DiffArraysLCS( const SerializeArray& From, const SerializeArray& To )
+	{
+		const size_t PathLength = Path.length();
+		const size_t FromSize = From.size();
+		const size_t ToSize = To.size();
+
+		// Elements are compared many times, compare their hashes first and
+		// only check the content of elements with the same hash
+		std::vector<uint64_t> FromHashes( FromSize );
+		std::vector<uint64_t> ToHashes( ToSize );
+		for( size_t i = 0; i < FromSize; i++ )
+		{
+			FromHashes[i] = SerializeHash::Hash( From[i] );
+		}
+		for( size_t j = 0; j < ToSize; j++ )
+		{
+			ToHashes[j] = SerializeHash::Hash( To[j] );
+		}
+		// Skip common prefix and suffix, usually most of the array
+		size_t Prefix = 0;
+		while( Prefix < FromSize && Prefix < ToSize && SameElement( From, FromHashes, Prefix, To, ToHashes, Prefix ) )
+		{
+			Prefix++;
+		}
+		size_t Suffix = 0;
+		while( Suffix < FromSize-Prefix && Suffix < ToSize-Prefix && SameElement( From, FromHashes, FromSize-1-Suffix, To, ToHashes, ToSize-1-Suffix ) )
+		{
+			Suffix++;
+		}
+
+		const size_t N = FromSize - Prefix - Suffix;
+		const size_t M = ToSize - Prefix - Suffix;
+
+		if ( N != 0 && M != 0 && N > SerializeDiff::MaxLCSTableSize/M )
+		{
+			// Too large, fallback to index comparison
+			DiffArraysByIndex( From, To );
+			return;
+		}
+
+		// Lcs[i*(M+1)+j] is the LCS length of From[Prefix+i..] and To[Prefix+j..]
+		std::vector<unsigned int> Lcs( (N+1)*(M+1), 0 );
+		std::vector<bool> Equal( N*M, false );
+		for( size_t i = N; i-- > 0; )
+		{
+			for( size_t j = M; j-- > 0; )
+			{
+				if ( SameElement( From, FromHashes, Prefix+i, To, ToHashes, Prefix+j ) )
+				{
+					Equal[i*M+j] = true;
+					Lcs[i*(M+1)+j] = Lcs[(i+1)*(M+1)+j+1] + 1;
+				}
+				else
+				{
+					const unsigned int Down = Lcs[(i+1)*(M+1)+j];
+					const unsigned int Right = Lcs[i*(M+1)+j+1];
+					Lcs[i*(M+1)+j] = Down > Right ? Down : Right;
+				}
+			}
+		}
+
+		// Walk the table, Index is the position in the array being patched
+		size_t i = 0, j = 0;
+		size_t Index = Prefix;
+		while( i < N || j < M )
+		{
+			if ( i < N && j < M )
+			{
+				if ( Equal[i*M+j] == true )
+				{
+					i++; j++; Index++;
+					continue;
+				}
+				if ( Lcs[i*(M+1)+j] == Lcs[(i+1)*(M+1)+j+1] )
+				{
+					// Element modified in place, compare its content
+					AppendPathIndex( Path, Index );
+					DiffValues( From[Prefix+i], To[Prefix+j] );
+					Path.resize( PathLength );
+					i++; j++; Index++;
+					continue;
+				}
+			}
+
+			if ( j < M && (i == N || Lcs[i*(M+1)+j+1] >= Lcs[(i+1)*(M+1)+j]) )
+			{
+				AppendPathIndex( Path, Index );
+				AddOperation( "add", &To[Prefix+j] );
+				Path.resize( PathLength );
+				j++; Index++;
+			}
+			else
+			{
+				AppendPathIndex( Path, Index );
+				AddOperation( "remove", (const json_spirit::Value *)NULL );
+				Path.resize( PathLength );
+				i++;
+			}
+		}
+	}
+
+	// Get a string member of an operation
+	const std::string& GetOperationMember( const SerializeObject& Operation, const char * Name )
+	{
+		for( SerializeObjectConstIterator it = Operation.begin(); it != Operation.end(); ++it )
+		{
+			if ( it->name_ == Name && it->value_.type() == json_spirit::str_type )
+			{
+				return it->value_.get_str();
+			}
+		}
+		throw SerializeException( SimpleString("Patch operation without string member ") + Name, SerializeException::InvalidFormat );
+	}
+
+	const json_spirit::Value& GetOperationValue( const SerializeObject& Operation )
+	{
+		for( SerializeObjectConstIterator it = Operation.begin(); it != Operation.end(); ++it )
+		{
+			if ( it->name_ == "value" )
+			{
+				return it->value_;
+			}
+		}
+		throw SerializeException( "Patch operation without value", SerializeException::InvalidFormat );
+	}
+
+	size_t FindMember( const SerializeObject& Object, const std::string& Key )
+	{
+		for( size_t i = 0; i < Object.size(); i++ )
+		{
+			if ( Object[i].name_ == Key )
+			{
+				return i;
+			}
+		}
+		return NotFound;
+	}
+
+	// Parse an array index, "-" (end of array) is accepted if AllowEnd is true
+	size_t ParseIndex( const std::string& Token, size_t Size, bool AllowEnd )
+	{
+		if ( AllowEnd == true && Token == "-" )
+		{
+			return Size;
+		}
+
+		if ( Token.empty() || Token.length() > 18 || (Token[0] == '0' && Token.length() > 1) )
+		{
+			throw SerializeException( "Invalid array index in patch path", SerializeException::InvalidFormat );
+		}
+
+		size_t Index = 0;
+		for( size_t i = 0; i < Token.length(); i++ )
+		{
+			if ( Token[i] < '0' || Token[i] > '9' )
+			{
+				throw SerializeException( "Invalid array index in patch path", SerializeException::InvalidFormat );
+			}
+			Index = Index*10 + (size_t)(Token[i]-'0');
+		}
+
+		if ( Index > Size || (Index == Size && AllowEnd == false) )
+		{
+			throw SerializeException( "Array index out of bounds in patch path", SerializeException::UnknownField );
+		}
+		return Index;
+	}
+
+	void SplitPath( const std::string& Path, std::vector<std::string>& Tokens )
+	{
+		Tokens.clear();
+		if ( Path.empty() )
+		{
+			return;
+		}
+		if ( Path[0] != '/' )
+		{
+			throw SerializeException( "Patch path must start with '/'", SerializeException::InvalidFormat );
+		}
+
+		size_t Start = 1;
+		for(;;)
+		{
+			size_t End = Path.find( '/', Start );
+			if ( End == std::string::npos )
+			{
+				End = Path.length();
+			}
+			Tokens.push_back( SerializeDiff::UnescapePathToken( SimpleString(Path.substr( Start, End-Start )) ) );
+			if ( End == Path.length() )
+			{
+				break;
+			}
+			Start = End + 1;
+		}
+	}
+
+	void ApplyOperation( json_spirit::Value& Root, const json_spirit::Value& OperationValue )
+	{
+		if ( OperationValue.type() != json_spirit::obj_type )
+		{
+			throw SerializeException( "Patch operation must be an object", SerializeException::InvalidFormat );
+		}
+		const SerializeObject& Operation = OperationValue.get_obj();
+		const std::string& Op = GetOperationMember( Operation, "op" );
+
+		std::vector<std::string> Tokens;
+		SplitPath( GetOperationMember( Operation, "path" ), Tokens );
+
+		// Operation on the whole document
+		if ( Tokens.empty() )
+		{
+			if ( Op == "add" || Op == "replace" )
+			{
+				// Copy first, the value may be inside Root
+				json_spirit::Value NewValue( GetOperationValue( Operation ) );
+				Root = NewValue;
+			}
+			else if ( Op == "remove" )
+			{
+				Root = json_spirit::Value();
+			}
+			else if ( Op == "test" )
+			{
+				if ( !(Root == GetOperationValue( Operation )) )
+				{
+					throw SerializeException( "Patch test failed", SerializeException::InvalidFormat );
+				}
+			}
+			else
+			{
+				throw SerializeException( "Unsupported patch operation " + SimpleString(Op), SerializeException::UnsupportedType );
+			}
+			return;
+		}
+
+		// Go to the parent of the target
+		json_spirit::Value * pParent = &Root;
+		for( size_t t = 0; t+1 < Tokens.size(); t++ )
+		{
+			if ( pParent->type() == json_spirit::obj_type )
+			{
+				SerializeObject& Object = pParent->get_obj();
+				size_t Pos = FindMember( Object, Tokens[t] );
+				if ( Pos == NotFound )
+				{
+					throw SerializeException( "Patch path not found", SerializeException::UnknownField );
+				}
+				pParent = &Object[Pos].value_;
+			}
+			else if ( pParent->type() == json_spirit::array_type )
+			{
+				SerializeArray& Array = pParent->get_array();
+				pParent = &Array[ParseIndex( Tokens[t], Array.size(), false )];
+			}
+			else
+			{
+				throw SerializeException( "Patch path not found", SerializeException::UnknownField );
+			}
+		}
+
+		const std::string& Last = Tokens.back();
+
+		if ( pParent->type() == json_spirit::obj_type )
+		{
+			SerializeObject& Object = pParent->get_obj();
+			size_t Pos = FindMember( Object, Last );
+
+			if ( Op == "add" )
+			{
+				if ( Pos == NotFound )
+				{
+					Object.push_back( SerializePair( Last, GetOperationValue( Operation ) ) );
+				}
+				else
+				{
+					Object[Pos].value_ = GetOperationValue( Operation );
+				}
+				return;
+			}
+
+			if ( Pos == NotFound )
+			{
+				throw SerializeException( "Patch path not found", SerializeException::UnknownField );
+			}
+
+			if ( Op == "remove" )
+			{
+				Object.erase( Object.begin() + Pos );
+			}
+			else if ( Op == "replace" )
+			{
+				Object[Pos].value_ = GetOperationValue( Operation );
+			}
+			else if ( Op == "test" )
+			{
+				if ( !(Object[Pos].value_ == GetOperationValue( Operation )) )
+				{
+					throw SerializeException( "Patch test failed", SerializeException::InvalidFormat );
+				}
+			}
+			else
+			{
+				throw SerializeException( "Unsupported patch operation " + SimpleString(Op), SerializeException::UnsupportedType );
+			}
+			return;
+		}
+
+		if ( pParent->type() == json_spirit::array_type )
+		{
+			SerializeArray& Array = pParent->get_array();
+
+			if ( Op == "add" )
+			{
+				size_t Pos = ParseIndex( Last, Array.size(), true );
+				Array.insert( Array.begin() + Pos, GetOperationValue( Operation ) );
+				return;
+			}
+
+			size_t Pos = ParseIndex( Last, Array.size(), false );
+			if ( Op == "remove" )
+			{
+				Array.erase( Array.begin() + Pos );
+			}
+			else if ( Op == "replace" )
+			{
+				Array[Pos] = GetOperationValue( Operation );
+			}
+			else if ( Op == "test" )
+			{
+				if ( !(Array[Pos] == GetOperationValue( Operation )) )
+				{
+					throw SerializeException( "Patch test failed", SerializeException::InvalidFormat );
+				}
+			}
+			else
+			{
+				throw SerializeException( "Unsupported patch operation " + SimpleString(Op), SerializeException::UnsupportedType );
+			}
+			return;
+		}
+
+		throw SerializeException( "Patch path not found", SerializeException::UnknownField );
+	}
+
+} // anonymous namespace
+
+SerializeValue SerializeDiff::Diff( const SerializeValue& From, const SerializeValue& To, ArrayDiffMode Mode /* = ArrayByIndex */ )
+{
+	SerializeArray Operations;
+
+	DiffBuilder Builder( Operations, Mode );
+	Builder.DiffValues( From, To );
+
+	return SerializeValue( json_spirit::Value(Operations) );
+}
+
+void SerializeDiff::ApplyPatch( SerializeValue& Target, const SerializeValue& PatchOperations )
+{
+	if ( PatchOperations.type() != json_spirit::array_type )
+	{
+		throw SerializeException( "Patch must be an array of operations", SerializeException::InvalidFormat );
+	}
+
+	const SerializeArray& Operations = PatchOperations.get_array();
+	for( SerializeArrayConstIterator it = Operations.begin(); it != Operations.end(); ++it )
+	{
+		ApplyOperation( Target, *it );
+	}
+}
+
+SerializeValue SerializeDiff::Patch( const SerializeValue& Source, const SerializeValue& PatchOperations )
+{
+	SerializeValue Result( Source );
+	ApplyPatch( Result, PatchOperations );
+	return Result;
+}
+
+SimpleString SerializeDiff::EscapePathToken( const SimpleString& Key )
+{
+	std::string Path;
+	AppendPathToken( Path, Key );
+
+	// Remove leading '/'
+	return SimpleString( Path.substr(1) );
+}
+
+SimpleString SerializeDiff::UnescapePathToken( const SimpleString& Token )
+{
+	if ( Token.find( '~' ) == std::string::npos )
+	{
+		return Token;
+	}
+
+	std::string Result;
+	Result.reserve( Token.length() );
+	for( size_t i = 0; i < Token.length(); i++ )
+	{
+		if ( Token[i] == '~' && i+1 < Token.length() && (Token[i+1] == '0' || Token[i+1] == '1') )
+		{
+			Result += (Token[i+1] == '0') ? '~' : '/';
+			i++;
+		}
+		else
+		{
+			Result += Token[i];
+		}
+	}
+	return SimpleString( Result );
+}
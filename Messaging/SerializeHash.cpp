@@ -0,0 +1,271 @@
+/* @file Messaging/SerializeHash.cpp
+ * @ingroup Messaging
+ * @brief Implementation of SerializeHash class
+ */
+
+#include <Messaging/SerializeHash.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	// splitmix64 finalizer
+	inline uint64_t Mix( uint64_t Val )
+	{
+		Val ^= Val >> 30;
+		Val *= 0xbf58476d1ce4e5b9ULL;
+		Val ^= Val >> 27;
+		Val *= 0x94d049bb133111ebULL;
+		Val ^= Val >> 31;
+		return Val;
+	}
+
+	// Order sensitive combination
+	inline uint64_t Combine( uint64_t Seed, uint64_t Val )
+	{
+		return Mix( Seed ^ (Val + 0x9e3779b97f4a7c15ULL + (Seed << 6) + (Seed >> 2)) );
+	}
+
+	// One seed per type, the type is part of the hash
+	inline uint64_t TypeSeed( json_spirit::Value_type Type )
+	{
+		return Mix( 0x6a09e667f3bcc908ULL + (uint64_t)Type );
+	}
+
+	// FNV-1a on the bytes of a string
+	uint64_t HashString( const std::string& Str )
+	{
+		uint64_t Val = 0xcbf29ce484222325ULL;
+		for( size_t i = 0; i < Str.length(); i++ )
+		{
+			Val ^= (unsigned char)Str[i];
+			Val *= 0x100000001b3ULL;
+		}
+		return Mix( Val ^ (uint64_t)Str.length() );
+	}
+
+	uint64_t HashValue( const json_spirit::Value& Val, SerializeHash::ObjectKeyOrder Order )
+	{
+		const uint64_t Seed = TypeSeed( Val.type() );
+
+		switch( Val.type() )
+		{
+			case json_spirit::obj_type:
+			{
+				const SerializeObject& Object = Val.get_obj();
+				if ( Order == SerializeHash::OrderedKeys )
+				{
+					uint64_t Result = Seed;
+					for( SerializeObjectConstIterator it = Object.begin(); it != Object.end(); ++it )
+					{
+						Result = Combine( Result, HashString( it->name_ ) );
+						Result = Combine( Result, HashValue( it->value_, Order ) );
+					}
+					return Combine( Result, (uint64_t)Object.size() );
+				}
+
+				// Commutative sum of the pairs hashes
+				uint64_t Sum = 0;
+				for( SerializeObjectConstIterator it = Object.begin(); it != Object.end(); ++it )
+				{
+					Sum += Combine( HashString( it->name_ ), HashValue( it->value_, Order ) );
+				}
+				return Combine( Combine( Seed, Sum ), (uint64_t)Object.size() );
+			}
+
+			case json_spirit::array_type:
+			{
+				const SerializeArray& Array = Val.get_array();
+				uint64_t Result = Seed;
+				for( SerializeArrayConstIterator it = Array.begin(); it != Array.end(); ++it )
+				{
+					Result = Combine( Result, HashValue( *it, Order ) );
+				}
+				return Combine( Result, (uint64_t)Array.size() );
+			}
+
+			case json_spirit::str_type:
+				return Combine( Seed, HashString( Val.get_str() ) );
+
+			case json_spirit::bool_type:
+				return Combine( Seed, Val.get_bool() ? 1 : 0 );
+
+			case json_spirit::int_type:
+				return Combine( Seed, (uint64_t)(int64_t)Val.get_int() );
+
+			case json_spirit::real_type:
+			{
+				double Real = Val.get_real();
+				if ( Real == 0.0 )
+				{
+					// -0.0 == 0.0
+					Real = 0.0;
+				}
+				uint64_t Bits;
+				memcpy( &Bits, &Real, sizeof(Bits) );
+				return Combine( Seed, Bits );
+			}
+
+			default:
+				// null
+				return Seed;
+		}
+	}
+
+	bool EqualValues( const json_spirit::Value& Val1, const json_spirit::Value& Val2, SerializeHash::ObjectKeyOrder Order );
+
+	// Under this size, keys out of place are searched linearly
+	const size_t MinIndexedObjectSize = 16;
+
+	typedef std::multimap<std::string, size_t> KeyIndex;
+
+	// Find the first pair of Object not matched yet with the same key and an equal
+	// value. Objects may hold the same key several times, each pair is matched once.
+	size_t FindPair( const SerializeObject& Object, const SerializePair& Pair, const std::vector<bool>& Matched,
+		KeyIndex& Index, SerializeHash::ObjectKeyOrder Order )
+	{
+		if ( Object.size() < MinIndexedObjectSize )
+		{
+			for( size_t j = 0; j < Object.size(); j++ )
+			{
+				if ( Matched[j] == false && Object[j].name_ == Pair.name_ && EqualValues( Object[j].value_, Pair.value_, Order ) )
+				{
+					return j;
+				}
+			}
+			return Object.size();
+		}
+
+		if ( Index.empty() )
+		{
+			for( size_t j = 0; j < Object.size(); j++ )
+			{
+				// Occurrences of a key stay in object order
+				Index.insert( std::make_pair( Object[j].name_, j ) );
+			}
+		}
+
+		std::pair<KeyIndex::const_iterator, KeyIndex::const_iterator> Range = Index.equal_range( Pair.name_ );
+		for( KeyIndex::const_iterator it = Range.first; it != Range.second; ++it )
+		{
+			if ( Matched[it->second] == false && EqualValues( Object[it->second].value_, Pair.value_, Order ) )
+			{
+				return it->second;
+			}
+		}
+		return Object.size();
+	}
+
+	bool EqualValues( const json_spirit::Value& Val1, const json_spirit::Value& Val2, SerializeHash::ObjectKeyOrder Order )
+	{
+		if ( &Val1 == &Val2 )
+		{
+			return true;
+		}
+
+		if ( Val1.type() != Val2.type() )
+		{
+			return false;
+		}
+
+		switch( Val1.type() )
+		{
+			case json_spirit::obj_type:
+			{
+				const SerializeObject& Object1 = Val1.get_obj();
+				const SerializeObject& Object2 = Val2.get_obj();
+				if ( Object1.size() != Object2.size() )
+				{
+					return false;
+				}
+
+				if ( Order == SerializeHash::OrderedKeys )
+				{
+					for( size_t i = 0; i < Object1.size(); i++ )
+					{
+						if ( Object1[i].name_ != Object2[i].name_ || EqualValues( Object1[i].value_, Object2[i].value_, Order ) == false )
+						{
+							return false;
+						}
+					}
+					return true;
+				}
+
+				// Pairs of Object2 already matched and index of its keys, only
+				// built once a pair is not found at the same place
+				std::vector<bool> Matched2;
+				KeyIndex Index2;
+
+				for( size_t i = 0; i < Object1.size(); i++ )
+				{
+					// Same place first
+					if ( (Matched2.empty() || Matched2[i] == false) && Object1[i].name_ == Object2[i].name_ &&
+						EqualValues( Object1[i].value_, Object2[i].value_, Order ) )
+					{
+						if ( Matched2.empty() == false )
+						{
+							Matched2[i] = true;
+						}
+						continue;
+					}
+
+					if ( Matched2.empty() )
+					{
+						// All previous pairs were matched at their place
+						Matched2.resize( Object2.size(), false );
+						for( size_t k = 0; k < i; k++ )
+						{
+							Matched2[k] = true;
+						}
+					}
+
+					const size_t j = FindPair( Object2, Object1[i], Matched2, Index2, Order );
+					if ( j == Object2.size() )
+					{
+						return false;
+					}
+					Matched2[j] = true;
+				}
+				return true;
+			}
+
+			case json_spirit::array_type:
+			{
+				const SerializeArray& Array1 = Val1.get_array();
+				const SerializeArray& Array2 = Val2.get_array();
+				if ( Array1.size() != Array2.size() )
+				{
+					return false;
+				}
+				for( size_t i = 0; i < Array1.size(); i++ )
+				{
+					if ( EqualValues( Array1[i], Array2[i], Order ) == false )
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+
+			default:
+				return Val1 == Val2;
+		}
+	}
+
+} // anonymous namespace
+
+uint64_t SerializeHash::Hash( const json_spirit::Value& Val, ObjectKeyOrder Order /* = OrderedKeys */ )
+{
+	return HashValue( Val, Order );
+}
+
+bool SerializeHash::Equal( const json_spirit::Value& Val1, const json_spirit::Value& Val2, ObjectKeyOrder Order /* = OrderedKeys */ )
+{
+	return EqualValues( Val1, Val2, Order );
+}
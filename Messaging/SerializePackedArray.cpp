@@ -0,0 +1,157 @@
+/* @file Messaging/SerializePackedArray.cpp
+ * @ingroup Messaging
+ * @brief Implementation of base64 tools for packed numeric containers
+ */
+
+#include <Messaging/SerializePackedArray.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	const char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	// Reverse table, 0xff for invalid characters, 0xfe for padding
+	class Base64ReverseTable
+	{
+	public:
+		Base64ReverseTable()
+		{
+			memset( Values, 0xff, sizeof(Values) );
+			for( int i = 0; i < 64; i++ )
+			{
+				Values[(unsigned char)Base64Alphabet[i]] = (unsigned char)i;
+			}
+			Values[(unsigned char)'='] = 0xfe;
+		}
+
+		unsigned char Values[256];
+	};
+
+	const Base64ReverseTable Base64Reverse;
+
+} // anonymous namespace
+
+void SerializePackedArray::EncodeBase64( const unsigned char * Data, size_t Length, std::string& Result )
+{
+	Result.resize( EncodedLength(Length) );
+	if ( Length == 0 )
+	{
+		return;
+	}
+
+	char * Out = &Result[0];
+	size_t i = 0;
+
+	// Full 3 bytes groups
+	for( ; i+2 < Length; i += 3 )
+	{
+		const unsigned int Group = (Data[i] << 16) | (Data[i+1] << 8) | Data[i+2];
+		*Out++ = Base64Alphabet[(Group >> 18) & 0x3f];
+		*Out++ = Base64Alphabet[(Group >> 12) & 0x3f];
+		*Out++ = Base64Alphabet[(Group >> 6) & 0x3f];
+		*Out++ = Base64Alphabet[Group & 0x3f];
+	}
+
+	// Remaining bytes with padding
+	if ( i < Length )
+	{
+		unsigned int Group = Data[i] << 16;
+		if ( i+1 < Length )
+		{
+			Group |= Data[i+1] << 8;
+		}
+		*Out++ = Base64Alphabet[(Group >> 18) & 0x3f];
+		*Out++ = Base64Alphabet[(Group >> 12) & 0x3f];
+		*Out++ = (i+1 < Length) ? Base64Alphabet[(Group >> 6) & 0x3f] : '=';
+		*Out++ = '=';
+	}
+}
+
+size_t SerializePackedArray::DecodedLength( const char * Text, size_t TextLength )
+{
+	if ( (TextLength % 4) != 0 )
+	{
+		return (size_t)-1;
+	}
+	if ( TextLength == 0 )
+	{
+		return 0;
+	}
+
+	size_t Padding = 0;
+	if ( Text[TextLength-1] == '=' )
+	{
+		Padding++;
+		if ( Text[TextLength-2] == '=' )
+		{
+			Padding++;
+		}
+	}
+
+	return (TextLength/4)*3 - Padding;
+}
+
+bool SerializePackedArray::DecodeBase64( const char * Text, size_t TextLength, unsigned char * Result )
+{
+	const size_t RawLength = DecodedLength( Text, TextLength );
+	if ( RawLength == (size_t)-1 )
+	{
+		return false;
+	}
+
+	const unsigned char * In = (const unsigned char *)Text;
+	const unsigned char * Table = Base64Reverse.Values;
+	size_t Written = 0;
+
+	for( size_t i = 0; i < TextLength; i += 4 )
+	{
+		const unsigned char c0 = Table[In[i]];
+		const unsigned char c1 = Table[In[i+1]];
+		const unsigned char c2 = Table[In[i+2]];
+		const unsigned char c3 = Table[In[i+3]];
+
+		// Any invalid char (or padding at wrong place) has its high bit set
+		if ( ((c0 | c1) & 0x80) != 0 )
+		{
+			return false;
+		}
+
+		const unsigned int Group = (c0 << 18) | (c1 << 12) | ((c2 & 0x3f) << 6) | (c3 & 0x3f);
+
+		Result[Written++] = (unsigned char)(Group >> 16);
+		if ( Written < RawLength )
+		{
+			if ( (c2 & 0x80) != 0 )
+			{
+				return false;
+			}
+			Result[Written++] = (unsigned char)(Group >> 8);
+		}
+		if ( Written < RawLength )
+		{
+			if ( (c3 & 0x80) != 0 )
+			{
+				return false;
+			}
+			Result[Written++] = (unsigned char)Group;
+		}
+	}
+
+	return true;
+}
+
+void SerializePackedArray::SwapBytes( unsigned char * Data, size_t NbElements, size_t SizeOfElement )
+{
+	for( size_t Element = 0; Element < NbElements; Element++ )
+	{
+		unsigned char * First = Data + Element*SizeOfElement;
+		unsigned char * Last = First + SizeOfElement - 1;
+		while( First < Last )
+		{
+			unsigned char tmp = *First;
+			*First++ = *Last;
+			*Last-- = tmp;
+		}
+	}
+}
@@ -0,0 +1,228 @@
+/* @file Messaging/SerializeStream.cpp
+ * @ingroup Messaging
+ * @brief Implementation of SerializeStream class and of its sinks
+ */
+
+#include <Messaging/SerializeStream.h>
+
+#include <System/SocketException.h>
+
+#include <errno.h>
+#include <stdio.h>
+
+#ifdef OMISCID_ON_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Omiscid;
+
+SerializeSink::~SerializeSink()
+{
+}
+
+SocketSerializeSink::SocketSerializeSink( Socket * pConnectedSocket )
+	: pSocket(pConnectedSocket)
+{
+}
+
+void SocketSerializeSink::Write( const char * Data, size_t Length )
+{
+	// Send may send only a part of the data (interrupted or non blocking socket),
+	// send the rest until done. Errors are thrown by Send as SocketException.
+	while( Length > 0 )
+	{
+		const int Sent = pSocket->Send( Length, Data );
+		if ( Sent <= 0 )
+		{
+			throw SocketException( "SocketSerializeSink::Write: unable to send data" );
+		}
+		Data += Sent;
+		Length -= (size_t)Sent;
+	}
+}
+
+FileDescriptorSerializeSink::FileDescriptorSerializeSink( int FileDescriptor )
+	: Descriptor(FileDescriptor)
+{
+}
+
+void FileDescriptorSerializeSink::Write( const char * Data, size_t Length )
+{
+	while( Length > 0 )
+	{
+#ifdef OMISCID_ON_WINDOWS
+		int res = _write( Descriptor, Data, (unsigned int)Length );
+#else
+		ssize_t res = write( Descriptor, Data, Length );
+#endif
+		if ( res < 0 )
+		{
+			if ( errno == EINTR )
+			{
+				continue;
+			}
+			throw SimpleException( "FileDescriptorSerializeSink::Write: unable to write data", errno );
+		}
+		Data += res;
+		Length -= (size_t)res;
+	}
+}
+
+CallbackSerializeSink::CallbackSerializeSink( WriteCallback Function, void * UserData /* = NULL */ )
+	: Callback(Function), CallbackUserData(UserData)
+{
+}
+
+void CallbackSerializeSink::Write( const char * Data, size_t Length )
+{
+	Callback( Data, Length, CallbackUserData );
+}
+
+SerializeStream::SerializeStream( SerializeSink& Destination, size_t ChunkSize /* = DefaultChunkSize */ )
+	: Sink(Destination), Used(0), FlushedLength(0)
+{
+	if ( ChunkSize < 64 )
+	{
+		// Room for any number
+		ChunkSize = 64;
+	}
+	Chunk.resize( ChunkSize );
+}
+
+SerializeStream::~SerializeStream()
+{
+}
+
+void SerializeStream::Flush()
+{
+	if ( Used == 0 )
+	{
+		return;
+	}
+
+	// Reset before calling the sink, if it throws the chunk is lost anyway
+	const size_t Length = Used;
+	Used = 0;
+	FlushedLength += Length;
+	Sink.Write( &Chunk[0], Length );
+}
+
+void SerializeStream::WriteLarge( const char * Data, size_t Length )
+{
+	while( Length > 0 )
+	{
+		if ( Used == Chunk.size() )
+		{
+			Flush();
+		}
+
+		const size_t Part = std::min( Length, Chunk.size() - Used );
+		memcpy( &Chunk[Used], Data, Part );
+		Used += Part;
+		Data += Part;
+		Length -= Part;
+	}
+}
+
+void SerializeStream::WriteInt( int Val )
+{
+	char Buffer[32];
+	int Length = snprintf( Buffer, sizeof(Buffer), "%d", Val );
+	Write( Buffer, (size_t)Length );
+}
+
+void SerializeStream::WriteReal( double Val )
+{
+	// Same output as the default formatting of std::ostream used by json_spirit::write
+	char Buffer[64];
+	int Length = snprintf( Buffer, sizeof(Buffer), "%g", Val );
+	Write( Buffer, (size_t)Length );
+}
+
+void SerializeStream::WriteBool( bool Val )
+{
+	if ( Val == true )
+	{
+		Write( "true", 4 );
+	}
+	else
+	{
+		Write( "false", 5 );
+	}
+}
+
+void SerializeStream::WriteValue( const json_spirit::Value& Val )
+{
+	switch( Val.type() )
+	{
+		case json_spirit::obj_type:
+		{
+			const SerializeObject& Object = Val.get_obj();
+			Write( '{' );
+			for( size_t i = 0; i < Object.size(); i++ )
+			{
+				if ( i != 0 )
+				{
+					Write( ',' );
+				}
+				WriteString( Object[i].name_ );
+				Write( ':' );
+				WriteValue( Object[i].value_ );
+			}
+			Write( '}' );
+			return;
+		}
+
+		case json_spirit::array_type:
+		{
+			const SerializeArray& Array = Val.get_array();
+			Write( '[' );
+			for( size_t i = 0; i < Array.size(); i++ )
+			{
+				if ( i != 0 )
+				{
+					Write( ',' );
+				}
+				WriteValue( Array[i] );
+			}
+			Write( ']' );
+			return;
+		}
+
+		case json_spirit::str_type:
+			WriteString( Val.get_str() );
+			return;
+
+		case json_spirit::bool_type:
+			WriteBool( Val.get_bool() );
+			return;
+
+		case json_spirit::int_type:
+			WriteInt( Val.get_int() );
+			return;
+
+		case json_spirit::real_type:
+			WriteReal( Val.get_real() );
+			return;
+
+		default:
+			Write( "null", 4 );
+			return;
+	}
+}
+
+void SerializeStream::WriteBase64( const unsigned char * Data, size_t Length )
+{
+	// Encode by pieces of at most 48 KB to keep the temporary buffer small
+	const size_t PieceSize = 3*16*1024;
+	while( Length > 0 )
+	{
+		const size_t Part = std::min( Length, PieceSize );
+		SerializePackedArray::EncodeBase64( Data, Part, Base64Buffer );
+		Write( Base64Buffer.data(), Base64Buffer.length() );
+		Data += Part;
+		Length -= Part;
+	}
+}
@@ -217,6 +217,74 @@ bool SerializeValue::IsAnArray() const
 	return (type() == json_spirit::array_type);
 }
 
+const json_spirit::Value * SerializeValue::TryFindMember( const SimpleString& Key ) const
+{
+	return Omiscid::TryFindMember( *this, Key );
+}
+
+const json_spirit::Value * Omiscid::TryFindMember( const json_spirit::Value& Val, const SimpleString& Key )
+{
+	if ( Val.type() != json_spirit::obj_type )
+	{
+		return (const json_spirit::Value *)NULL;
+	}
+
+	const SerializeObject & Members = Val.get_obj();
+	for( SerializeObjectConstIterator it = Members.begin(); it != Members.end(); ++it )
+	{
+		if ( same_name( *it, Key ) == true )
+		{
+			return &(it->value_);
+		}
+	}
+
+	return (const json_spirit::Value *)NULL;
+}
+
+namespace {
+
+	// Type checks of the decoding functions, a mistyped value costs a branch and
+	// a SerializeException instead of an assert in json_spirit
+
+	int GetCheckedInt( const json_spirit::Value& Val )
+	{
+		if ( Val.type() != json_spirit::int_type )
+		{
+			throw SerializeException( "Value is not an int", SerializeException::IllegalTypeConversion );
+		}
+		return Val.get_int();
+	}
+
+	double GetCheckedReal( const json_spirit::Value& Val )
+	{
+		// get_real promotes int values
+		if ( Val.type() != json_spirit::real_type && Val.type() != json_spirit::int_type )
+		{
+			throw SerializeException( "Value is not a number", SerializeException::IllegalTypeConversion );
+		}
+		return Val.get_real();
+	}
+
+	bool GetCheckedBool( const json_spirit::Value& Val )
+	{
+		if ( Val.type() != json_spirit::bool_type )
+		{
+			throw SerializeException( "Value is not a bool", SerializeException::IllegalTypeConversion );
+		}
+		return Val.get_bool();
+	}
+
+	const std::string& GetCheckedString( const json_spirit::Value& Val )
+	{
+		if ( Val.type() != json_spirit::str_type )
+		{
+			throw SerializeException( "Value is not a string", SerializeException::IllegalTypeConversion );
+		}
+		return Val.get_str();
+	}
+
+} // anonymous namespace
+
 // long management
 	// Encoding functions
 	SerializeValue Omiscid::SerializeLong( long Data )
@@ -228,11 +296,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( *(static_cast<long*>(pTmpData)) );
 	}
 	// Decoding functions
-	int Omiscid::UnserializeLong( const SerializeValue& Val )
+	int Omiscid::UnserializeLong( const json_spirit::Value& Val )
 	{
-		return Val.get_int();
+		return GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeLongFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeLongFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<int*>(pTmpData)) = UnserializeLong(Val);
 	}
@@ -248,11 +316,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( *(static_cast<int*>(pTmpData)) );
 	}
 	// Decoding functions
-	int Omiscid::UnserializeInt( const SerializeValue& Val )
+	int Omiscid::UnserializeInt( const json_spirit::Value& Val )
 	{
-		return Val.get_int();
+		return GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeIntFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeIntFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<int*>(pTmpData)) = UnserializeInt(Val);
 	}
@@ -268,11 +336,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (int)(*(static_cast<short int*>(pTmpData))) );
 	}
 	// Decoding functions
-	short int Omiscid::UnserializeShortInt( const SerializeValue& Val )
+	short int Omiscid::UnserializeShortInt( const json_spirit::Value& Val )
 	{
-		return (short int)Val.get_int();
+		return (short int)GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeShortIntFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeShortIntFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<short int*>(pTmpData)) = UnserializeShortInt( Val );
 	}
@@ -290,12 +358,12 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue();
 	}
 	// Decoding functions
-	unsigned int Omiscid::UnserializeUnsignedInt( const SerializeValue& Val )
+	unsigned int Omiscid::UnserializeUnsignedInt( const json_spirit::Value& Val )
 	{
 		throw SerializeException("unsigned int not supported, please send as a string", SerializeException::UnsupportedType );
 		return 0;
 	}
-	void Omiscid::UnserializeUnsignedIntFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeUnsignedIntFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		throw SerializeException("unsigned int not supported, please send as a string", SerializeException::UnsupportedType );
 	}
@@ -311,11 +379,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (int)(*(static_cast<unsigned short*>(pTmpData))) );
 	}
 	// Decoding functions
-	unsigned short Omiscid::UnserializeUnsignedShort( const SerializeValue& Val )
+	unsigned short Omiscid::UnserializeUnsignedShort( const json_spirit::Value& Val )
 	{
-		return (unsigned short)Val.get_int();
+		return (unsigned short)GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeUnsignedShortFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeUnsignedShortFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<unsigned short*>(pTmpData)) = UnserializeUnsignedShort( Val );
 	}
@@ -331,11 +399,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (int)(*(static_cast<char*>(pTmpData))) );
 	}
 	// Decoding functions
-	char Omiscid::UnserializeChar( const SerializeValue& Val )
+	char Omiscid::UnserializeChar( const json_spirit::Value& Val )
 	{
-		return (char)Val.get_int();
+		return (char)GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeCharFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeCharFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<char*>(pTmpData)) = UnserializeChar(Val);
 	}
@@ -351,11 +419,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (int)(*(static_cast<unsigned char*>(pTmpData))) );
 	}
 	// Decoding functions
-	unsigned char Omiscid::UnserializeUnsignedChar( const SerializeValue& Val )
+	unsigned char Omiscid::UnserializeUnsignedChar( const json_spirit::Value& Val )
 	{
-		return (unsigned char)Val.get_int();
+		return (unsigned char)GetCheckedInt( Val );
 	}
-	void Omiscid::UnserializeUnsignedCharFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeUnsignedCharFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<unsigned char*>(pTmpData)) = UnserializeUnsignedChar( Val );
 	}
@@ -371,11 +439,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (double)(*(static_cast<double*>(pTmpData))) );
 	}
 	// Decoding functions
-	double Omiscid::UnserializeDouble( const SerializeValue& Val )
+	double Omiscid::UnserializeDouble( const json_spirit::Value& Val )
 	{
-		return (double)Val.get_real();
+		return (double)GetCheckedReal( Val );
 	}
-	void Omiscid::UnserializeDoubleFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeDoubleFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<double*>(pTmpData)) = UnserializeDouble( Val );
 	}
@@ -391,11 +459,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (double)(*(static_cast<float*>(pTmpData))) );
 	}
 	// Decoding functions
-	float Omiscid::UnserializeFloat( const SerializeValue& Val )
+	float Omiscid::UnserializeFloat( const json_spirit::Value& Val )
 	{
-		return (float)Val.get_real();
+		return (float)GetCheckedReal( Val );
 	}
-	void Omiscid::UnserializeFloatFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeFloatFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<float*>(pTmpData)) = UnserializeFloat( Val );
 	}
@@ -411,11 +479,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( *(static_cast<bool*>(pTmpData)) );
 	}
 	// Decoding functions
-	bool Omiscid::UnserializeBool( const SerializeValue& Val )
+	bool Omiscid::UnserializeBool( const json_spirit::Value& Val )
 	{
-		return (bool)Val.get_bool();
+		return (bool)GetCheckedBool( Val );
 	}
-	void Omiscid::UnserializeBoolFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeBoolFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<bool*>(pTmpData)) = UnserializeBool( Val );
 	}
@@ -431,22 +499,22 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( (*(static_cast<SimpleString*>(pTmpData))).GetStr() );
 	}
 	// Decoding functions
-	SimpleString Omiscid::UnserializeSimpleString( const SerializeValue& Val )
+	SimpleString Omiscid::UnserializeSimpleString( const json_spirit::Value& Val )
 	{
 		if ( Val.type() == json_spirit::null_type )		// Case on empty string in some json analysis
 		{
 			return SimpleString();
 		}
-		return SimpleString( Val.get_str().c_str() );
+		return SimpleString( GetCheckedString( Val ).c_str() );
 	}
-	void Omiscid::UnserializeSimpleStringFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeSimpleStringFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		if ( Val.type() == json_spirit::null_type )		// Case on empty string in some json analysis
 		{
 			*(static_cast<SimpleString*>(pTmpData)) = "";
 			return;
 		}
-		*(static_cast<SimpleString*>(pTmpData)) = Val.get_str().c_str();
+		*(static_cast<SimpleString*>(pTmpData)) = GetCheckedString( Val ).c_str();
 	}
 
 // char * management
@@ -461,11 +529,11 @@ bool SerializeValue::IsAnArray() const
 		return SerializeValue( *(static_cast<char**>(pTmpData)) );
 	}
 	// Decoding functions
-	char * Omiscid::UnserializeCharStar( const SerializeValue& Val )
+	char * Omiscid::UnserializeCharStar( const json_spirit::Value& Val )
 	{
-		return (char*)strdup(Val.get_str().c_str());
+		return (char*)strdup(GetCheckedString( Val ).c_str());
 	}
-	void Omiscid::UnserializeCharStarFromAddress( const SerializeValue& Val, void * pTmpData )
+	void Omiscid::UnserializeCharStarFromAddress( const json_spirit::Value& Val, void * pTmpData )
 	{
 		*(static_cast<char**>(pTmpData)) = UnserializeCharStar( Val );
 	}
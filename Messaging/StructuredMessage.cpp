@@ -57,6 +57,7 @@ StructuredMessage::StructuredMessage( Message& Msg )
 StructuredMessage::StructuredMessage( const StructuredMessage& SMsg )
 {
 	Serializer = SMsg.Serializer;
+	CopyCachedText( SMsg );
 }
 
  /** @brief Copy Constructor
@@ -64,6 +65,7 @@ StructuredMessage::StructuredMessage( const StructuredMessage& SMsg )
 StructuredMessage::StructuredMessage( StructuredMessage& SMsg )
 {
 	Serializer = SMsg.Serializer;
+	CopyCachedText( SMsg );
 }
 
 
@@ -95,12 +97,48 @@ StructuredMessage:: StructuredMessage( const SimpleString& SMsg )
   */
 StructuredMessage::~StructuredMessage()
 {
+	InvalidateCachedText();
+}
+
+ /** @brief Empty the message (it becomes an empty object)
+  */
+void StructuredMessage::Reset()
+{
+	InvalidateCachedText();
+
+	// clear keeps the capacity of the top level object
+	Serializer.set_obj_type().clear();
+}
+
+ /** @brief Parse a serialized text into this message, reusing its memory
+  */
+void StructuredMessage::ParseInto( const char * Text, size_t Length )
+{
+	InvalidateCachedText();
+
+	if ( !json_spirit::read_reusing( Text, Length, Serializer ) )
+	{
+		// Do not keep a partially overwritten content
+		Reset();
+		throw SerializeException("Argument is not a valid serialization stream", SerializeException::MalformedStream );
+	}
+}
+
+void StructuredMessage::ParseInto( const SimpleString& Text )
+{
+	ParseInto( Text.GetStr(), Text.GetLength() );
+}
+
+void StructuredMessage::ParseInto( const Message& Msg )
+{
+	ParseInto( Msg.GetBuffer(), Msg.GetLenght() );
 }
 
  /** operator=
   */
 StructuredMessage& StructuredMessage::operator=( SerializeValue& SerValue )
 {
+	InvalidateCachedText();
 	Serializer = SerValue;
 
 	return *this;
@@ -110,6 +148,7 @@ StructuredMessage& StructuredMessage::operator=( SerializeValue& SerValue )
   */
 StructuredMessage& StructuredMessage::operator=( const SerializeValue& SerValue )
 {
+	InvalidateCachedText();
 	Serializer = SerValue;
 
 	return *this;
@@ -119,11 +158,114 @@ StructuredMessage& StructuredMessage::operator=( const SerializeValue& SerValue
   */
 StructuredMessage& StructuredMessage::operator=( StructuredMessage& sMsg )
 {
+	if ( this == &sMsg )
+	{
+		return *this;
+	}
+
 	Serializer = sMsg.Serializer;
+	CopyCachedText( sMsg );
 
 	return *this;
 }
 
+void StructuredMessage::InvalidateCachedText()
+{
+	for( int Mode = 0; Mode < 2; Mode++ )
+	{
+		// Called by writers only, no reader uses the texts any more
+		delete CachedText[Mode].exchange( (const SimpleString*)NULL, std::memory_order_relaxed );
+		CachedHashIsValid[Mode].store( false, std::memory_order_relaxed );
+	}
+}
+
+const SimpleString& StructuredMessage::GetText( bool IndentedText ) const
+{
+	const int Mode = IndentedText ? 1 : 0;
+
+	const SimpleString * pText = CachedText[Mode].load( std::memory_order_acquire );
+	if ( pText != (const SimpleString*)NULL )
+	{
+		return *pText;
+	}
+
+	std::string Text;
+	if ( IndentedText == true )
+	{
+		Text = json_spirit::write_formatted(Serializer);
+	}
+	else
+	{
+		Text = json_spirit::write(Serializer);
+	}
+	// No copy of the text, SimpleString is a std::string
+	SimpleString * pNewText = new SimpleString;
+	pNewText->swap( Text );
+
+	// Another reader may have installed its text meanwhile, keep the first one
+	const SimpleString * pExpected = (const SimpleString*)NULL;
+	if ( CachedText[Mode].compare_exchange_strong( pExpected, pNewText, std::memory_order_acq_rel, std::memory_order_acquire ) == false )
+	{
+		delete pNewText;
+		return *pExpected;
+	}
+	return *pNewText;
+}
+
+void StructuredMessage::CopyCachedText( const StructuredMessage& SMsg )
+{
+	InvalidateCachedText();
+
+	// SMsg may be read (and its caches filled) by other threads
+	for( int Mode = 0; Mode < 2; Mode++ )
+	{
+		const SimpleString * pText = SMsg.CachedText[Mode].load( std::memory_order_acquire );
+		if ( pText != (const SimpleString*)NULL )
+		{
+			CachedText[Mode].store( new SimpleString( *pText ), std::memory_order_relaxed );
+		}
+
+		if ( SMsg.CachedHashIsValid[Mode].load( std::memory_order_acquire ) == true )
+		{
+			CachedHash[Mode].store( SMsg.CachedHash[Mode].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+			CachedHashIsValid[Mode].store( true, std::memory_order_relaxed );
+		}
+	}
+}
+
+uint64_t StructuredMessage::GetHash( SerializeHash::ObjectKeyOrder Order /* = SerializeHash::OrderedKeys */ ) const
+{
+	const int Mode = (Order == SerializeHash::OrderedKeys) ? 0 : 1;
+
+	if ( CachedHashIsValid[Mode].load( std::memory_order_acquire ) == false )
+	{
+		// Concurrent readers compute and store the same value
+		CachedHash[Mode].store( SerializeHash::Hash( Serializer, Order ), std::memory_order_relaxed );
+		CachedHashIsValid[Mode].store( true, std::memory_order_release );
+	}
+
+	return CachedHash[Mode].load( std::memory_order_relaxed );
+}
+
+bool StructuredMessage::operator==( const StructuredMessage& SMsg ) const
+{
+	if ( this == &SMsg )
+	{
+		return true;
+	}
+
+	// Different hashes, different messages. Hashes are only used if both
+	// are already cached, computing them costs more than the comparison.
+	if ( CachedHashIsValid[0].load( std::memory_order_acquire ) == true &&
+		SMsg.CachedHashIsValid[0].load( std::memory_order_acquire ) == true &&
+		CachedHash[0].load( std::memory_order_relaxed ) != SMsg.CachedHash[0].load( std::memory_order_relaxed ) )
+	{
+		return false;
+	}
+
+	return SerializeHash::Equal( Serializer, SMsg.Serializer );
+}
+
 bool StructuredMessage::IsAnObject() const
 {
 	return (Serializer.type() == json_spirit::obj_type);
@@ -173,6 +315,9 @@ SerializeObjectConstIterator StructuredMessage::Find( const SimpleString& Key )
   */
 SerializeObjectIterator StructuredMessage::Find( const SimpleString& Key )
 {
+	// The returned iterator can be used to modify the message
+	InvalidateCachedText();
+
 	if ( IsASimpleValue() )
 	{
 		throw SimpleException( "Could not find a key : not an object" );
@@ -204,8 +349,60 @@ SerializeValue StructuredMessage::FindAndGetValue( const SimpleString& Key ) con
 	return (*Find(Key)).value_;
 }
 
+ /** \find Find an element value hashed by Key without throwing any exception
+  * @param Key [in] the key to identifies the pair.
+  * @return a pointer to the value, NULL if not found
+  */
+const json_spirit::Value * StructuredMessage::TryFind( const SimpleString& Key ) const
+{
+	return Serializer.TryFindMember( Key );
+}
+
+bool StructuredMessage::TryGetValue( const SimpleString& Key, SerializeValue& Val ) const
+{
+	const json_spirit::Value * pValue = TryFind( Key );
+	if ( pValue == (const json_spirit::Value *)NULL )
+	{
+		return false;
+	}
+	Val = *pValue;
+	return true;
+}
+
+bool StructuredMessage::TryGetValue( const SimpleString& Key, int& Val ) const
+{
+	const json_spirit::Value * pValue = TryFind( Key );
+	return pValue != (const json_spirit::Value *)NULL && TryGetInt( *pValue, Val );
+}
+
+bool StructuredMessage::TryGetValue( const SimpleString& Key, double& Val ) const
+{
+	const json_spirit::Value * pValue = TryFind( Key );
+	return pValue != (const json_spirit::Value *)NULL && TryGetReal( *pValue, Val );
+}
+
+bool StructuredMessage::TryGetValue( const SimpleString& Key, bool& Val ) const
+{
+	const json_spirit::Value * pValue = TryFind( Key );
+	return pValue != (const json_spirit::Value *)NULL && TryGetBool( *pValue, Val );
+}
+
+bool StructuredMessage::TryGetValue( const SimpleString& Key, SimpleString& Val ) const
+{
+	const json_spirit::Value * pValue = TryFind( Key );
+	const std::string * pString = pValue != (const json_spirit::Value *)NULL ? GetStringView( *pValue ) : (const std::string *)NULL;
+	if ( pString == (const std::string *)NULL )
+	{
+		return false;
+	}
+	Val = *pString;
+	return true;
+}
+
 void StructuredMessage::Put( const SimpleString Key, const SerializeValue& Val )
 {
+	InvalidateCachedText();
+
 	if ( IsNullValue() ||  IsAnObject() == false )
 	{
 		SerializeObject EmptyObject;
@@ -0,0 +1,657 @@
+/**
+ * @file Messaging/Tools/OmiscidIdlCompiler.cpp
+ * @ingroup Messaging
+ * @brief Generate C++ message structures with dedicated codecs from a schema
+ *
+ * Usage: OmiscidIdlCompiler Schema.json Output.h
+ *
+ * The schema is a JSON file:
+ * @code
+ * {
+ *   "namespace" : "MyApp::Messages",
+ *   "messages" : [
+ *     { "name" : "Point", "fields" : [
+ *         { "name" : "x", "type" : "double" },
+ *         { "name" : "y", "type" : "double" } ] },
+ *     { "name" : "Path", "fields" : [
+ *         { "name" : "id",     "type" : "int" },
+ *         { "name" : "label",  "type" : "string" },
+ *         { "name" : "closed", "type" : "bool" },
+ *         { "name" : "points", "type" : "Point[]" } ] }
+ *   ]
+ * }
+ * @endcode
+ * Field types are int, float, double, bool, string, a message defined before
+ * in the schema, or an array of one of them ("T[]"). The generated header only
+ * depends on Messaging/IdlCodec.h and Messaging/StructuredMessage.h.
+ *
+ * This tool only needs the Json module, see omiscid_generate_messages in
+ * OmiscidMessagingConfig.cmake to use it from a CMake project.
+ */
+
+#include <Json/json_spirit_reader.h>
+#include <Json/json_spirit_value.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include <ctype.h>
+
+namespace {
+
+	enum FieldKind { IntField = 0, FloatField, DoubleField, BoolField, StringField, MessageField };
+
+	struct FieldDescription
+	{
+		std::string Name;
+		FieldKind Kind;
+		std::string MessageType;	// for MessageField
+		bool IsArray;
+	};
+
+	struct MessageDescription
+	{
+		std::string Name;
+		std::vector<FieldDescription> Fields;
+	};
+
+	struct SchemaError
+	{
+		SchemaError( const std::string& Msg ) : Message(Msg) {}
+		std::string Message;
+	};
+
+	bool IsIdentifier( const std::string& Name )
+	{
+		if ( Name.empty() || (isalpha((unsigned char)Name[0]) == 0 && Name[0] != '_') )
+		{
+			return false;
+		}
+		for( size_t i = 1; i < Name.length(); i++ )
+		{
+			if ( isalnum((unsigned char)Name[i]) == 0 && Name[i] != '_' )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Member functions of the generated structures
+	bool IsReservedName( const std::string& Name )
+	{
+		static const char * Reserved[] = { "Serialize", "SerializeInto", "Unserialize", "ToStructuredMessage",
+			"FromStructuredMessage", "EncodeBinary", "DecodeBinary", NULL };
+		for( size_t i = 0; Reserved[i] != NULL; i++ )
+		{
+			if ( Name == Reserved[i] )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const json_spirit::Value * FindMember( const json_spirit::Object& Object, const char * Name )
+	{
+		for( size_t i = 0; i < Object.size(); i++ )
+		{
+			if ( Object[i].name_ == Name )
+			{
+				return &Object[i].value_;
+			}
+		}
+		return NULL;
+	}
+
+	std::string GetStringMember( const json_spirit::Object& Object, const char * Name, const std::string& Context )
+	{
+		const json_spirit::Value * pVal = FindMember( Object, Name );
+		if ( pVal == NULL || pVal->type() != json_spirit::str_type )
+		{
+			throw SchemaError( Context + ": missing string member '" + Name + "'" );
+		}
+		return pVal->get_str();
+	}
+
+	FieldDescription ParseField( const json_spirit::Value& Val, const std::string& MessageName, const std::set<std::string>& KnownMessages )
+	{
+		if ( Val.type() != json_spirit::obj_type )
+		{
+			throw SchemaError( "message '" + MessageName + "': fields must be objects" );
+		}
+
+		FieldDescription Field;
+		Field.Name = GetStringMember( Val.get_obj(), "name", "message '" + MessageName + "'" );
+		const std::string Context = "field '" + MessageName + "." + Field.Name + "'";
+		if ( IsIdentifier( Field.Name ) == false )
+		{
+			throw SchemaError( Context + ": name is not a valid identifier" );
+		}
+		if ( IsReservedName( Field.Name ) || Field.Name == MessageName )
+		{
+			throw SchemaError( Context + ": name is reserved" );
+		}
+
+		std::string Type = GetStringMember( Val.get_obj(), "type", Context );
+		Field.IsArray = false;
+		if ( Type.length() > 2 && Type.compare( Type.length()-2, 2, "[]" ) == 0 )
+		{
+			Field.IsArray = true;
+			Type.erase( Type.length()-2 );
+		}
+
+		if ( Type == "int" )
+		{
+			Field.Kind = IntField;
+		}
+		else if ( Type == "float" )
+		{
+			Field.Kind = FloatField;
+		}
+		else if ( Type == "double" )
+		{
+			Field.Kind = DoubleField;
+		}
+		else if ( Type == "bool" )
+		{
+			Field.Kind = BoolField;
+		}
+		else if ( Type == "string" )
+		{
+			Field.Kind = StringField;
+		}
+		else if ( KnownMessages.count( Type ) != 0 )
+		{
+			Field.Kind = MessageField;
+			Field.MessageType = Type;
+		}
+		else
+		{
+			throw SchemaError( Context + ": unknown type '" + Type + "' (messages must be defined before being used)" );
+		}
+
+		return Field;
+	}
+
+	std::vector<MessageDescription> ParseSchema( const json_spirit::Value& Schema, std::vector<std::string>& Namespaces )
+	{
+		if ( Schema.type() != json_spirit::obj_type )
+		{
+			throw SchemaError( "schema must be an object" );
+		}
+		const json_spirit::Object& Root = Schema.get_obj();
+
+		const json_spirit::Value * pNamespace = FindMember( Root, "namespace" );
+		if ( pNamespace != NULL )
+		{
+			if ( pNamespace->type() != json_spirit::str_type )
+			{
+				throw SchemaError( "namespace must be a string" );
+			}
+
+			// "A::B" -> A, B
+			std::string Remaining = pNamespace->get_str();
+			for(;;)
+			{
+				const size_t Pos = Remaining.find( "::" );
+				const std::string Name = Remaining.substr( 0, Pos );
+				if ( IsIdentifier( Name ) == false )
+				{
+					throw SchemaError( "invalid namespace '" + pNamespace->get_str() + "'" );
+				}
+				Namespaces.push_back( Name );
+				if ( Pos == std::string::npos )
+				{
+					break;
+				}
+				Remaining.erase( 0, Pos+2 );
+			}
+		}
+
+		const json_spirit::Value * pMessages = FindMember( Root, "messages" );
+		if ( pMessages == NULL || pMessages->type() != json_spirit::array_type )
+		{
+			throw SchemaError( "missing array member 'messages'" );
+		}
+
+		std::vector<MessageDescription> Messages;
+		std::set<std::string> KnownMessages;
+		const json_spirit::Array& MessageArray = pMessages->get_array();
+		for( size_t i = 0; i < MessageArray.size(); i++ )
+		{
+			if ( MessageArray[i].type() != json_spirit::obj_type )
+			{
+				throw SchemaError( "messages must be objects" );
+			}
+
+			MessageDescription Message;
+			Message.Name = GetStringMember( MessageArray[i].get_obj(), "name", "message" );
+			if ( IsIdentifier( Message.Name ) == false )
+			{
+				throw SchemaError( "message '" + Message.Name + "': name is not a valid identifier" );
+			}
+			if ( KnownMessages.count( Message.Name ) != 0 )
+			{
+				throw SchemaError( "message '" + Message.Name + "' is defined twice" );
+			}
+
+			const json_spirit::Value * pFields = FindMember( MessageArray[i].get_obj(), "fields" );
+			if ( pFields == NULL || pFields->type() != json_spirit::array_type )
+			{
+				throw SchemaError( "message '" + Message.Name + "': missing array member 'fields'" );
+			}
+
+			std::set<std::string> FieldNames;
+			for( size_t f = 0; f < pFields->get_array().size(); f++ )
+			{
+				FieldDescription Field = ParseField( pFields->get_array()[f], Message.Name, KnownMessages );
+				if ( FieldNames.insert( Field.Name ).second == false )
+				{
+					throw SchemaError( "message '" + Message.Name + "': field '" + Field.Name + "' is defined twice" );
+				}
+				Message.Fields.push_back( Field );
+			}
+
+			KnownMessages.insert( Message.Name );
+			Messages.push_back( Message );
+		}
+
+		return Messages;
+	}
+
+	// C++ code generation
+
+	std::string CppType( const FieldDescription& Field )
+	{
+		std::string Type;
+		switch( Field.Kind )
+		{
+			case IntField:		Type = "int"; break;
+			case FloatField:	Type = "float"; break;
+			case DoubleField:	Type = "double"; break;
+			case BoolField:		Type = "bool"; break;
+			case StringField:	Type = "Omiscid::SimpleString"; break;
+			case MessageField:	Type = Field.MessageType; break;
+		}
+		if ( Field.IsArray )
+		{
+			return "std::vector<" + Type + ">";
+		}
+		return Type;
+	}
+
+	std::string DefaultValue( const FieldDescription& Field )
+	{
+		if ( Field.IsArray )
+		{
+			return "";
+		}
+		switch( Field.Kind )
+		{
+			case IntField:		return "0";
+			case FloatField:	return "0.0f";
+			case DoubleField:	return "0.0";
+			case BoolField:		return "false";
+			default:			return "";
+		}
+	}
+
+	bool IsNumeric( FieldKind Kind )
+	{
+		return Kind == IntField || Kind == FloatField || Kind == DoubleField;
+	}
+
+	// Statement writing a scalar expression in place in the json_spirit::Value expression Val
+	std::string JsonWrite( FieldKind Kind, const std::string& Val, const std::string& Expr )
+	{
+		switch( Kind )
+		{
+			case IntField:		return Val + ".set_int( " + Expr + " );";
+			case FloatField:
+			case DoubleField:	return Val + ".set_real( (double)" + Expr + " );";
+			case BoolField:		return Val + ".set_bool( (bool)" + Expr + " );";
+			case StringField:	return "Omiscid::IdlCodec::SetString( " + Val + ", " + Expr + " );";
+			default:			return Expr + ".SerializeInto( " + Val + " );";
+		}
+	}
+
+	// Statement reading a scalar from the json_spirit::Value expression Val into Target
+	std::string JsonRead( const FieldDescription& Field, const std::string& Val, const std::string& Target )
+	{
+		const std::string Name = "\"" + Field.Name + "\"";
+		switch( Field.Kind )
+		{
+			case IntField:		return Target + " = Omiscid::IdlCodec::GetInt( " + Val + ", " + Name + " );";
+			case FloatField:	return Target + " = (float)Omiscid::IdlCodec::GetReal( " + Val + ", " + Name + " );";
+			case DoubleField:	return Target + " = Omiscid::IdlCodec::GetReal( " + Val + ", " + Name + " );";
+			case BoolField:		return Target + " = Omiscid::IdlCodec::GetBool( " + Val + ", " + Name + " );";
+			case StringField:	return "Omiscid::IdlCodec::GetString( " + Val + ", " + Name + ", " + Target + " );";
+			default:			return Target + ".Unserialize( " + Val + " );";
+		}
+	}
+
+	std::string BinaryWrite( FieldKind Kind, const std::string& Expr )
+	{
+		switch( Kind )
+		{
+			case IntField:		return "Omiscid::IdlCodec::PutInt( Buffer, " + Expr + " );";
+			case FloatField:	return "Omiscid::IdlCodec::PutFloat( Buffer, " + Expr + " );";
+			case DoubleField:	return "Omiscid::IdlCodec::PutDouble( Buffer, " + Expr + " );";
+			case BoolField:		return "Omiscid::IdlCodec::PutBool( Buffer, " + Expr + " );";
+			case StringField:	return "Omiscid::IdlCodec::PutString( Buffer, " + Expr + " );";
+			default:			return Expr + ".EncodeBinary( Buffer );";
+		}
+	}
+
+	std::string BinaryRead( FieldKind Kind, const std::string& Target )
+	{
+		switch( Kind )
+		{
+			case IntField:		return Target + " = Reader.GetInt();";
+			case FloatField:	return Target + " = Reader.GetFloat();";
+			case DoubleField:	return Target + " = Reader.GetDouble();";
+			case BoolField:		return Target + " = Reader.GetBool();";
+			case StringField:	return "Reader.GetString( " + Target + " );";
+			default:			return Target + ".DecodeBinary( Reader );";
+		}
+	}
+
+	void GenerateDeclaration( std::ostream& Out, const MessageDescription& Message )
+	{
+		Out << "struct " << Message.Name << "\n{\n";
+		for( size_t i = 0; i < Message.Fields.size(); i++ )
+		{
+			Out << "\t" << CppType( Message.Fields[i] ) << " " << Message.Fields[i].Name << ";\n";
+		}
+		if ( Message.Fields.empty() == false )
+		{
+			Out << "\n";
+		}
+
+		// Constructor
+		Out << "\t" << Message.Name << "()";
+		bool First = true;
+		for( size_t i = 0; i < Message.Fields.size(); i++ )
+		{
+			const std::string Default = DefaultValue( Message.Fields[i] );
+			if ( Default.empty() )
+			{
+				continue;
+			}
+			Out << (First ? "\n\t\t: " : ", ") << Message.Fields[i].Name << "(" << Default << ")";
+			First = false;
+		}
+		Out << "\n\t{\n\t}\n\n";
+
+		Out << "\t/** @brief Encode in a SerializeValue (a JSON object) */\n";
+		Out << "\tOmiscid::SerializeValue Serialize() const\n";
+		Out << "\t{\n\t\tOmiscid::SerializeValue Val;\n\t\tSerializeInto( Val );\n\t\treturn Val;\n\t}\n\n";
+
+		Out << "\t/** @brief Encode in an existing value, reusing its memory */\n";
+		Out << "\tvoid SerializeInto( json_spirit::Value& Val ) const;\n\n";
+
+		Out << "\t/** @brief Decode from a JSON object\n";
+		Out << "\t * @exception Omiscid::SerializeException if a field is missing or has a wrong type\n\t */\n";
+		Out << "\tvoid Unserialize( const json_spirit::Value& Val );\n\n";
+
+		Out << "\tOmiscid::StructuredMessage ToStructuredMessage() const\n";
+		Out << "\t{\n\t\treturn Omiscid::StructuredMessage( Serialize() );\n\t}\n\n";
+
+		Out << "\tvoid FromStructuredMessage( const Omiscid::StructuredMessage& Msg )\n";
+		Out << "\t{\n\t\tUnserialize( Msg.GetValue() );\n\t}\n\n";
+
+		Out << "\t/** @brief Append the binary encoding to Buffer */\n";
+		Out << "\tvoid EncodeBinary( std::string& Buffer ) const;\n\n";
+
+		Out << "\t/** @brief Decode a whole binary buffer\n";
+		Out << "\t * @exception Omiscid::SerializeException if the buffer is truncated or too long\n\t */\n";
+		Out << "\tvoid DecodeBinary( const char * Data, size_t Length )\n";
+		Out << "\t{\n\t\tOmiscid::IdlCodec::BinaryReader Reader( Data, Length );\n";
+		Out << "\t\tDecodeBinary( Reader );\n";
+		Out << "\t\tOmiscid::IdlCodec::CheckFullyRead( Reader, Length );\n\t}\n\n";
+
+		Out << "\tvoid DecodeBinary( Omiscid::IdlCodec::BinaryReader& Reader );\n";
+		Out << "};\n\n";
+	}
+
+	void GenerateDefinitions( std::ostream& Out, const MessageDescription& Message )
+	{
+		const std::vector<FieldDescription>& Fields = Message.Fields;
+
+		// JSON encoding
+		// Values of a previous encoding are overwritten in place
+		Out << "inline void " << Message.Name << "::SerializeInto( json_spirit::Value& Val ) const\n{\n";
+		Out << "\tOmiscid::SerializeObject& Object = Val.set_obj_type();\n";
+		for( size_t i = 0; i < Fields.size(); i++ )
+		{
+			const FieldDescription& Field = Fields[i];
+			const std::string Member = "this->" + Field.Name;
+			std::ostringstream SetField;
+			SetField << "Omiscid::IdlCodec::SetField( Object, " << i << ", \"" << Field.Name << "\" )";
+			const std::string Value = SetField.str();
+			if ( Field.IsArray == false )
+			{
+				Out << "\t" << JsonWrite( Field.Kind, Value, Member ) << "\n";
+				continue;
+			}
+			Out << "\t{\n";
+			Out << "\t\tOmiscid::SerializeArray& Array = " << Value << ".set_array_type();\n";
+			Out << "\t\tArray.resize( " << Member << ".size() );\n";
+			Out << "\t\tfor( size_t i = 0; i < " << Member << ".size(); i++ )\n\t\t{\n";
+			Out << "\t\t\t" << JsonWrite( Field.Kind, "Array[i]", Member + "[i]" ) << "\n";
+			Out << "\t\t}\n\t}\n";
+		}
+		Out << "\tOmiscid::IdlCodec::EndObject( Object, " << Fields.size() << " );\n";
+		Out << "}\n\n";
+
+		// JSON decoding
+		Out << "inline void " << Message.Name << "::Unserialize( const json_spirit::Value& Val )\n{\n";
+		Out << "\tconst Omiscid::SerializeObject& Object = Omiscid::IdlCodec::GetObject( Val, \"" << Message.Name << "\" );\n";
+		if ( Fields.empty() )
+		{
+			Out << "\t(void)Object;\n";
+		}
+		for( size_t i = 0; i < Fields.size(); i++ )
+		{
+			const FieldDescription& Field = Fields[i];
+			const std::string Member = "this->" + Field.Name;
+			std::ostringstream Find;
+			Find << "Omiscid::IdlCodec::FindField( Object, " << i << ", \"" << Field.Name << "\" )";
+			if ( Field.IsArray == false )
+			{
+				Out << "\t" << JsonRead( Field, Find.str(), Member ) << "\n";
+				continue;
+			}
+			Out << "\t{\n";
+			Out << "\t\tconst Omiscid::SerializeArray& Array = Omiscid::IdlCodec::GetArray( " << Find.str() << ", \"" << Field.Name << "\" );\n";
+			Out << "\t\t" << Member << ".resize( Array.size() );\n";
+			Out << "\t\tfor( size_t i = 0; i < Array.size(); i++ )\n\t\t{\n";
+			Out << "\t\t\t" << JsonRead( Field, "Array[i]", Member + "[i]" ) << "\n";
+			Out << "\t\t}\n\t}\n";
+		}
+		Out << "}\n\n";
+
+		// Binary encoding
+		Out << "inline void " << Message.Name << "::EncodeBinary( std::string& Buffer ) const\n{\n";
+		if ( Fields.empty() )
+		{
+			Out << "\t(void)Buffer;\n";
+		}
+		for( size_t i = 0; i < Fields.size(); i++ )
+		{
+			const FieldDescription& Field = Fields[i];
+			const std::string Member = "this->" + Field.Name;
+			if ( Field.IsArray == false )
+			{
+				Out << "\t" << BinaryWrite( Field.Kind, Member ) << "\n";
+			}
+			else if ( IsNumeric( Field.Kind ) )
+			{
+				Out << "\tOmiscid::IdlCodec::PutNumericVector( Buffer, " << Member << " );\n";
+			}
+			else
+			{
+				Out << "\tOmiscid::IdlCodec::PutCount( Buffer, " << Member << ".size() );\n";
+				Out << "\tfor( size_t i = 0; i < " << Member << ".size(); i++ )\n\t{\n";
+				Out << "\t\t" << BinaryWrite( Field.Kind, Member + "[i]" ) << "\n";
+				Out << "\t}\n";
+			}
+		}
+		Out << "}\n\n";
+
+		// Binary decoding
+		Out << "inline void " << Message.Name << "::DecodeBinary( Omiscid::IdlCodec::BinaryReader& Reader )\n{\n";
+		if ( Fields.empty() )
+		{
+			Out << "\t(void)Reader;\n";
+		}
+		for( size_t i = 0; i < Fields.size(); i++ )
+		{
+			const FieldDescription& Field = Fields[i];
+			const std::string Member = "this->" + Field.Name;
+			if ( Field.IsArray == false )
+			{
+				Out << "\t" << BinaryRead( Field.Kind, Member ) << "\n";
+			}
+			else if ( IsNumeric( Field.Kind ) )
+			{
+				Out << "\tReader.GetNumericVector( " << Member << " );\n";
+			}
+			else
+			{
+				Out << "\t" << Member << ".resize( Reader.GetCount() );\n";
+				Out << "\tfor( size_t i = 0; i < " << Member << ".size(); i++ )\n\t{\n";
+				if ( Field.Kind == BoolField )
+				{
+					// std::vector<bool> elements are not addressable
+					Out << "\t\t" << Member << "[i] = Reader.GetBool();\n";
+				}
+				else
+				{
+					Out << "\t\t" << BinaryRead( Field.Kind, Member + "[i]" ) << "\n";
+				}
+				Out << "\t}\n";
+			}
+		}
+		Out << "}\n\n";
+	}
+
+	std::string IncludeGuard( const std::string& OutputFile )
+	{
+		std::string Base = OutputFile;
+		const size_t Slash = Base.find_last_of( "/\\" );
+		if ( Slash != std::string::npos )
+		{
+			Base.erase( 0, Slash+1 );
+		}
+
+		std::string Guard = "__";
+		for( size_t i = 0; i < Base.length(); i++ )
+		{
+			Guard += isalnum((unsigned char)Base[i]) ? (char)toupper((unsigned char)Base[i]) : '_';
+		}
+		return Guard + "__";
+	}
+
+	void Generate( std::ostream& Out, const std::string& SchemaFile, const std::string& OutputFile,
+		const std::vector<std::string>& Namespaces, const std::vector<MessageDescription>& Messages )
+	{
+		const std::string Guard = IncludeGuard( OutputFile );
+
+		Out << "/**\n * @file " << OutputFile.substr( OutputFile.find_last_of( "/\\" ) + 1 ) << "\n";
+		Out << " * @brief Generated by OmiscidIdlCompiler from " << SchemaFile << ", do not edit\n */\n\n";
+		Out << "#ifndef " << Guard << "\n#define " << Guard << "\n\n";
+		Out << "#include <Messaging/IdlCodec.h>\n";
+		Out << "#include <Messaging/SerializeValue.h>\n";
+		Out << "#include <Messaging/StructuredMessage.h>\n\n";
+		Out << "#include <System/SimpleString.h>\n\n";
+		Out << "#include <string>\n#include <vector>\n\n";
+
+		for( size_t i = 0; i < Namespaces.size(); i++ )
+		{
+			Out << "namespace " << Namespaces[i] << " {\n";
+		}
+		if ( Namespaces.empty() == false )
+		{
+			Out << "\n";
+		}
+
+		for( size_t i = 0; i < Messages.size(); i++ )
+		{
+			GenerateDeclaration( Out, Messages[i] );
+		}
+		for( size_t i = 0; i < Messages.size(); i++ )
+		{
+			GenerateDefinitions( Out, Messages[i] );
+		}
+
+		for( size_t i = Namespaces.size(); i > 0; i-- )
+		{
+			Out << "} // " << Namespaces[i-1] << "\n";
+		}
+		if ( Namespaces.empty() == false )
+		{
+			Out << "\n";
+		}
+		Out << "#endif // " << Guard << "\n";
+	}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+	if ( argc != 3 )
+	{
+		std::cerr << "Usage: " << argv[0] << " Schema.json Output.h" << std::endl;
+		return 1;
+	}
+
+	const std::string SchemaFile = argv[1];
+	const std::string OutputFile = argv[2];
+
+	std::ifstream Input( SchemaFile.c_str() );
+	if ( Input.is_open() == false )
+	{
+		std::cerr << SchemaFile << ": unable to open file" << std::endl;
+		return 1;
+	}
+
+	json_spirit::Value Schema;
+	if ( json_spirit::read( Input, Schema ) == false )
+	{
+		std::cerr << SchemaFile << ": invalid JSON" << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> Namespaces;
+	std::vector<MessageDescription> Messages;
+	try
+	{
+		Messages = ParseSchema( Schema, Namespaces );
+	}
+	catch( SchemaError& e )
+	{
+		std::cerr << SchemaFile << ": " << e.Message << std::endl;
+		return 1;
+	}
+
+	// Generate in memory first, never leave a partial file behind
+	std::ostringstream Generated;
+	Generate( Generated, SchemaFile, OutputFile, Namespaces, Messages );
+
+	std::ofstream Output( OutputFile.c_str(), std::ios::out | std::ios::binary );
+	Output << Generated.str();
+	Output.close();
+	if ( Output.fail() )
+	{
+		std::cerr << OutputFile << ": unable to write file" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
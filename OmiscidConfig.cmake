@@ -21,6 +21,17 @@
 #      -          : The Omiscid sources files.
 #      - Omiscid_HDRS         : The Omiscid header files.
 #
+#    Options:
+#      - OMISCID_BUILD_MESSAGING_BENCHMARK : add the OmiscidMessagingBenchmark
+#        program (Messaging component), built with OMISCID_COUNT_ALLOCATIONS to
+#        report allocations per operation. See Messaging/Benchmarks/MessagingBenchmark.cpp.
+#      - OMISCID_BUILD_LOCK_BENCHMARK : add the OmiscidLockBenchmark program
+#        (System component), lock latency for 2 to 64 contending threads.
+#        See System/Benchmarks/LockBenchmark.cpp.
+#      - OMISCID_BUILD_MESSAGE_QUEUE_BENCHMARK : add the OmiscidMessageQueueBenchmark
+#        program (System component), thread message queues with 1 to 32 senders.
+#        See System/Benchmarks/MessageQueueBenchmark.cpp.
+#
 #  =============================================================================
 
 function(CollapseVariable VariablePrefix SubModule VariableSuffix)
@@ -92,3 +103,30 @@ set(Omiscid_INCLUDE_DIRS ${Temp_Omiscid_INCLUDE_DIRS} CACHE INTERNAL "The Omisci
 set(Omiscid_LIBS ${Temp_Omiscid_LIBS} CACHE INTERNAL "The Omiscid mandatory libraries.")
 set(Omiscid_SRCS ${Temp_Omiscid_SRCS} CACHE INTERNAL "The Omiscid sources files.")
 set(Omiscid_HDRS ${Temp_Omiscid_HDRS} CACHE INTERNAL "The Omiscid header files.")
+
+# Messaging benchmark, allocation counting is only enabled for this program
+option(OMISCID_BUILD_MESSAGING_BENCHMARK "Build the Omiscid Messaging benchmark program" OFF)
+list(FIND ModulesToInclude "Messaging" MessagingIndex)
+if ( OMISCID_BUILD_MESSAGING_BENCHMARK AND NOT MessagingIndex EQUAL -1 AND NOT TARGET OmiscidMessagingBenchmark )
+	find_package(Threads REQUIRED)
+	omiscid_generate_messages("${OmiscidMessaging_ROOT_PATH}/Benchmarks/BenchmarkMessages.json" BenchmarkMessages.h)
+	add_executable(OmiscidMessagingBenchmark "${OmiscidMessaging_ROOT_PATH}/Benchmarks/MessagingBenchmark.cpp" "${CMAKE_CURRENT_BINARY_DIR}/BenchmarkMessages.h" ${Omiscid_SRCS})
+	target_include_directories(OmiscidMessagingBenchmark PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+	target_compile_definitions(OmiscidMessagingBenchmark PRIVATE OMISCID_COUNT_ALLOCATIONS)
+	target_link_libraries(OmiscidMessagingBenchmark ${Omiscid_LIBS} ${CMAKE_THREAD_LIBS_INIT})
+endif()
+
+# Lock contention benchmark
+option(OMISCID_BUILD_LOCK_BENCHMARK "Build the Omiscid lock contention benchmark program" OFF)
+if ( OMISCID_BUILD_LOCK_BENCHMARK AND NOT TARGET OmiscidLockBenchmark )
+	find_package(Threads REQUIRED)
+	add_executable(OmiscidLockBenchmark "${OmiscidSystem_ROOT_PATH}/Benchmarks/LockBenchmark.cpp" ${Omiscid_SRCS})
+	target_link_libraries(OmiscidLockBenchmark ${Omiscid_LIBS} ${CMAKE_THREAD_LIBS_INIT})
+endif()
+
+option(OMISCID_BUILD_MESSAGE_QUEUE_BENCHMARK "Build the Omiscid thread message queue benchmark program" OFF)
+if ( OMISCID_BUILD_MESSAGE_QUEUE_BENCHMARK AND NOT TARGET OmiscidMessageQueueBenchmark )
+	find_package(Threads REQUIRED)
+	add_executable(OmiscidMessageQueueBenchmark "${OmiscidSystem_ROOT_PATH}/Benchmarks/MessageQueueBenchmark.cpp" ${Omiscid_SRCS})
+	target_link_libraries(OmiscidMessageQueueBenchmark ${Omiscid_LIBS} ${CMAKE_THREAD_LIBS_INIT})
+endif()
@@ -0,0 +1,221 @@
+#include <System/AdaptiveMutex.h>
+#include <System/LockProfiler.h>
+#include <System/SpinLock.h>
+
+#include <chrono>
+
+#ifdef __linux__
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using namespace Omiscid;
+
+namespace {
+
+	// Maximum number of pause instructions in one spin round
+	const unsigned int MaxBackoff = 64;
+
+	unsigned long long ElapsedNs( const std::chrono::steady_clock::time_point& Start )
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+} // anonymous namespace
+
+AdaptiveMutex::AdaptiveMutex( unsigned int MaxSpins /* = DefaultMaxSpins */ )
+	: State(0), Owner(std::thread::id()), RecursionCount(0), Acquisitions(0), ContendedAcquisitions(0), WaitTimeNs(0)
+{
+	// Spinning only makes sense if the owner can run at the same time
+	if ( std::thread::hardware_concurrency() > 1 )
+	{
+		SpinRounds = MaxSpins;
+	}
+	else
+	{
+		SpinRounds = 0;
+	}
+}
+
+AdaptiveMutex::~AdaptiveMutex()
+{
+}
+
+bool AdaptiveMutex::Lock(int wait_us /* = 0 */)
+{
+	const std::thread::id Me = std::this_thread::get_id();
+
+	// Only this thread can have stored its own id
+	if ( Owner.load(std::memory_order_relaxed) == Me )
+	{
+		RecursionCount++;
+		return true;
+	}
+
+	int Expected = 0;
+	if ( State.compare_exchange_strong(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed) == false )
+	{
+		if ( LockContended( wait_us, OMISCID_RETURN_ADDRESS() ) == false )
+		{
+			return false;
+		}
+	}
+	else if ( pProfileHook != NULL )
+	{
+		ProfileAcquired();
+	}
+
+	Owner.store( Me, std::memory_order_relaxed );
+	RecursionCount = 1;
+	AddToCounter( Acquisitions, 1 );
+
+	return true;
+}
+
+bool AdaptiveMutex::Unlock()
+{
+	if ( Owner.load(std::memory_order_relaxed) != std::this_thread::get_id() )
+	{
+		// Not locked by this thread
+		return false;
+	}
+
+	if ( --RecursionCount > 0 )
+	{
+		return true;
+	}
+
+	if ( pProfileHook != NULL )
+	{
+		ProfileReleased();
+	}
+
+	Owner.store( std::thread::id(), std::memory_order_relaxed );
+	if ( State.exchange(0, std::memory_order_release) == 2 )
+	{
+		WakeOne();
+	}
+
+	return true;
+}
+
+bool AdaptiveMutex::LockContended( int wait_us, void * CallSite )
+{
+	const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point Deadline = Start + std::chrono::microseconds(wait_us > 0 ? wait_us : 0);
+
+	// Spin with exponential backoff, the owner may release the mutex very soon
+	unsigned int Backoff = 1;
+	for( unsigned int Round = 0; Round < SpinRounds; Round++ )
+	{
+		for( unsigned int i = 0; i < Backoff; i++ )
+		{
+			OmiscidCpuPause();
+		}
+		if ( Backoff < MaxBackoff )
+		{
+			Backoff *= 2;
+		}
+
+		int Expected = 0;
+		if ( State.load(std::memory_order_relaxed) == 0 &&
+			State.compare_exchange_weak(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed) == true )
+		{
+			ContendedAcquisition( Start, CallSite );
+			return true;
+		}
+	}
+
+	// Park. State 2 tells the owner it must wake someone up when unlocking;
+	// the mutex is taken when the previous state was 0.
+	while( State.exchange(2, std::memory_order_acquire) != 0 )
+	{
+		long long RemainingNs = 0;
+		if ( wait_us > 0 )
+		{
+			RemainingNs = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(Deadline - std::chrono::steady_clock::now()).count();
+			if ( RemainingNs <= 0 )
+			{
+				// State stays 2, the next Unlock will do a useless wake up
+				return false;
+			}
+		}
+
+#ifdef __linux__
+		// Sleep only if State is still 2, the kernel checks it atomically
+		if ( wait_us > 0 )
+		{
+			struct timespec Timeout;
+			Timeout.tv_sec = (time_t)(RemainingNs / 1000000000LL);
+			Timeout.tv_nsec = (long)(RemainingNs % 1000000000LL);
+			syscall( SYS_futex, (int*)&State, FUTEX_WAIT_PRIVATE, 2, &Timeout, NULL, 0 );
+		}
+		else
+		{
+			syscall( SYS_futex, (int*)&State, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0 );
+		}
+#else
+		// Same protocol as the futex: check State and wait atomically regarding WakeOne
+		std::unique_lock<std::mutex> Guard(ParkingMutex);
+		if ( State.load(std::memory_order_relaxed) == 2 )
+		{
+			if ( wait_us > 0 )
+			{
+				ParkingCondition.wait_for( Guard, std::chrono::nanoseconds(RemainingNs) );
+			}
+			else
+			{
+				ParkingCondition.wait( Guard );
+			}
+		}
+#endif
+	}
+
+	ContendedAcquisition( Start, CallSite );
+	return true;
+}
+
+void AdaptiveMutex::ContendedAcquisition( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite )
+{
+	AddToCounter( ContendedAcquisitions, 1 );
+	AddToCounter( WaitTimeNs, ElapsedNs(WaitStart) );
+
+	if ( pProfileHook != NULL )
+	{
+		ProfileAcquiredAfterWait( WaitStart, CallSite );
+	}
+}
+
+bool AdaptiveMutex::EnableProfiling( const char * Name )
+{
+	return CreateProfileHook( Name );
+}
+
+void AdaptiveMutex::WakeOne()
+{
+#ifdef __linux__
+	syscall( SYS_futex, (int*)&State, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0 );
+#else
+	std::lock_guard<std::mutex> Guard(ParkingMutex);
+	ParkingCondition.notify_one();
+#endif
+}
+
+AdaptiveMutex::Statistics AdaptiveMutex::GetStatistics() const
+{
+	Statistics Stats;
+	Stats.Acquisitions = Acquisitions.load(std::memory_order_relaxed);
+	Stats.ContendedAcquisitions = ContendedAcquisitions.load(std::memory_order_relaxed);
+	Stats.WaitTimeNs = WaitTimeNs.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+void AdaptiveMutex::ResetStatistics()
+{
+	Acquisitions.store( 0, std::memory_order_relaxed );
+	ContendedAcquisitions.store( 0, std::memory_order_relaxed );
+	WaitTimeNs.store( 0, std::memory_order_relaxed );
+}
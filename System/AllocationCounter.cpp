@@ -0,0 +1,244 @@
+/**
+ * @file System/AllocationCounter.cpp
+ * @ingroup System
+ * @brief Implementation of AllocationCounter class
+ */
+
+#include <System/AllocationCounter.h>
+
+#ifdef OMISCID_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
+#ifdef OMISCID_ON_WINDOWS
+#include <malloc.h>
+#endif
+
+namespace {
+
+	// Constant initialised (constexpr constructor): operator new may be called
+	// before the dynamic initialisation of this file
+	std::atomic<uint64_t> NbAllocations( 0 );
+	std::atomic<uint64_t> NbFrees( 0 );
+	std::atomic<uint64_t> NbAllocatedBytes( 0 );
+
+	inline void * CountedAllocation( size_t size )
+	{
+		NbAllocations.fetch_add( 1, std::memory_order_relaxed );
+		NbAllocatedBytes.fetch_add( (uint64_t)size, std::memory_order_relaxed );
+
+		// malloc(0) may return NULL
+		return malloc( size == 0 ? 1 : size );
+	}
+
+	inline void CountedFree( void * p )
+	{
+		if ( p == NULL )
+		{
+			return;
+		}
+		NbFrees.fetch_add( 1, std::memory_order_relaxed );
+		free( p );
+	}
+
+#ifdef __cpp_aligned_new
+	inline void * CountedAlignedAllocation( size_t size, size_t alignment )
+	{
+		NbAllocations.fetch_add( 1, std::memory_order_relaxed );
+		NbAllocatedBytes.fetch_add( (uint64_t)size, std::memory_order_relaxed );
+
+		if ( alignment < sizeof(void*) )
+		{
+			alignment = sizeof(void*);
+		}
+		if ( size == 0 )
+		{
+			size = 1;
+		}
+#ifdef OMISCID_ON_WINDOWS
+		return _aligned_malloc( size, alignment );
+#else
+		void * p;
+		if ( posix_memalign( &p, alignment, size ) != 0 )
+		{
+			return NULL;
+		}
+		return p;
+#endif
+	}
+
+	inline void CountedAlignedFree( void * p )
+	{
+		if ( p == NULL )
+		{
+			return;
+		}
+		NbFrees.fetch_add( 1, std::memory_order_relaxed );
+#ifdef OMISCID_ON_WINDOWS
+		_aligned_free( p );
+#else
+		free( p );
+#endif
+	}
+#endif // __cpp_aligned_new
+
+} // anonymous namespace
+
+// Dynamic exception specifications are deprecated (ill-formed in C++17), the
+// throwing forms have none and the others are noexcept
+
+void * operator new( size_t size )
+{
+	void * p = CountedAllocation( size );
+	if ( p == NULL )
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new[]( size_t size )
+{
+	void * p = CountedAllocation( size );
+	if ( p == NULL )
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+	return CountedAllocation( size );
+}
+
+void * operator new[]( size_t size, const std::nothrow_t& ) noexcept
+{
+	return CountedAllocation( size );
+}
+
+void operator delete( void * p ) noexcept
+{
+	CountedFree( p );
+}
+
+void operator delete[]( void * p ) noexcept
+{
+	CountedFree( p );
+}
+
+void operator delete( void * p, const std::nothrow_t& ) noexcept
+{
+	CountedFree( p );
+}
+
+void operator delete[]( void * p, const std::nothrow_t& ) noexcept
+{
+	CountedFree( p );
+}
+
+#ifdef __cpp_sized_deallocation
+// C++14 sized forms, called instead of the unsized ones when the size is known
+void operator delete( void * p, size_t ) noexcept
+{
+	CountedFree( p );
+}
+
+void operator delete[]( void * p, size_t ) noexcept
+{
+	CountedFree( p );
+}
+#endif // __cpp_sized_deallocation
+
+#ifdef __cpp_aligned_new
+// C++17 forms for types aligned beyond __STDCPP_DEFAULT_NEW_ALIGNMENT__
+void * operator new( size_t size, std::align_val_t alignment )
+{
+	void * p = CountedAlignedAllocation( size, (size_t)alignment );
+	if ( p == NULL )
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new[]( size_t size, std::align_val_t alignment )
+{
+	void * p = CountedAlignedAllocation( size, (size_t)alignment );
+	if ( p == NULL )
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept
+{
+	return CountedAlignedAllocation( size, (size_t)alignment );
+}
+
+void * operator new[]( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept
+{
+	return CountedAlignedAllocation( size, (size_t)alignment );
+}
+
+void operator delete( void * p, std::align_val_t ) noexcept
+{
+	CountedAlignedFree( p );
+}
+
+void operator delete[]( void * p, std::align_val_t ) noexcept
+{
+	CountedAlignedFree( p );
+}
+
+void operator delete( void * p, std::align_val_t, const std::nothrow_t& ) noexcept
+{
+	CountedAlignedFree( p );
+}
+
+void operator delete[]( void * p, std::align_val_t, const std::nothrow_t& ) noexcept
+{
+	CountedAlignedFree( p );
+}
+
+void operator delete( void * p, size_t, std::align_val_t ) noexcept
+{
+	CountedAlignedFree( p );
+}
+
+void operator delete[]( void * p, size_t, std::align_val_t ) noexcept
+{
+	CountedAlignedFree( p );
+}
+#endif // __cpp_aligned_new
+
+bool Omiscid::AllocationCounter::IsEnabled()
+{
+	return true;
+}
+
+Omiscid::AllocationCounter::Counts Omiscid::AllocationCounter::GetCounts()
+{
+	Counts Result;
+	Result.Allocations = NbAllocations.load( std::memory_order_relaxed );
+	Result.Frees = NbFrees.load( std::memory_order_relaxed );
+	Result.AllocatedBytes = NbAllocatedBytes.load( std::memory_order_relaxed );
+	return Result;
+}
+
+#else
+
+bool Omiscid::AllocationCounter::IsEnabled()
+{
+	return false;
+}
+
+Omiscid::AllocationCounter::Counts Omiscid::AllocationCounter::GetCounts()
+{
+	return Counts();
+}
+
+#endif // OMISCID_COUNT_ALLOCATIONS
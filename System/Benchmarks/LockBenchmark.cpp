@@ -0,0 +1,263 @@
+/**
+ * @file System/Benchmarks/LockBenchmark.cpp
+ * @ingroup System
+ * @brief Latency and throughput of the System locks under contention
+ *
+ * Usage: OmiscidLockBenchmark [-i AcquisitionsPerThread] [-t MaxThreads] [-w CriticalSectionWork]
+ *
+ * For 2 to MaxThreads (default 64) threads, each thread locks the same lock
+ * AcquisitionsPerThread times (default 20000) around a critical section of
+ * CriticalSectionWork loop iterations (default 100).
+ * The wait time of each Lock call is measured.
+ *
+ * A first pass measures one thread taking an uncontended lock through SmartLocker
+ * (virtual calls) and through SmartPolicyLocker (direct calls).
+ * A last pass measures readers only: the critical section reads a shared
+ * table, under a Mutex and under the read lock of a ReadWriteMutex.
+ */
+
+#include <System/AdaptiveMutex.h>
+#include <System/ElapsedTime.h>
+#include <System/Mutex.h>
+#include <System/ReentrantMutex.h>
+#include <System/ReadWriteMutex.h>
+#include <System/SpinLock.h>
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	struct ThreadStats
+	{
+		ThreadStats() : TotalWaitNs(0.0), MaxWaitNs(0.0) {}
+
+		double TotalWaitNs;
+		double MaxWaitNs;
+	};
+
+	template <typename LOCK_TYPE>
+	void RunContention( const char * Name, unsigned int NbThreads, unsigned int Acquisitions, unsigned int Work )
+	{
+		LOCK_TYPE Lock;
+		volatile unsigned int SharedCounter = 0;
+		volatile unsigned int SharedWork = 0;
+		std::atomic<bool> Go( false );
+		std::vector<ThreadStats> Stats( NbThreads );
+		std::vector<std::thread> Threads;
+
+		for( unsigned int t = 0; t < NbThreads; t++ )
+		{
+			Threads.push_back( std::thread( [&, t]()
+			{
+				while( Go.load() == false )
+				{
+					std::this_thread::yield();
+				}
+
+				ThreadStats& MyStats = Stats[t];
+				for( unsigned int i = 0; i < Acquisitions; i++ )
+				{
+					std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+					Lock.Lock();
+					const double WaitNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+
+					// Critical section
+					for( unsigned int w = 0; w < Work; w++ )
+					{
+						SharedWork = SharedWork + w;
+					}
+					SharedCounter = SharedCounter + 1;
+
+					Lock.Unlock();
+
+					MyStats.TotalWaitNs += WaitNs;
+					MyStats.MaxWaitNs = std::max( MyStats.MaxWaitNs, WaitNs );
+				}
+			} ) );
+		}
+
+		PerfElapsedTime Timer;
+		Go.store( true );
+		for( unsigned int t = 0; t < NbThreads; t++ )
+		{
+			Threads[t].join();
+		}
+		const double Seconds = Timer.GetInSeconds();
+
+		double TotalWaitNs = 0.0;
+		double MaxWaitNs = 0.0;
+		for( unsigned int t = 0; t < NbThreads; t++ )
+		{
+			TotalWaitNs += Stats[t].TotalWaitNs;
+			MaxWaitNs = std::max( MaxWaitNs, Stats[t].MaxWaitNs );
+		}
+
+		const double NbAcquisitions = (double)NbThreads * (double)Acquisitions;
+		printf( "%-16s %3u threads %12.0f locks/s %10.0f ns mean wait %12.0f ns max wait%s\n", Name, NbThreads,
+			NbAcquisitions / Seconds, TotalWaitNs / NbAcquisitions, MaxWaitNs,
+			SharedCounter == (unsigned int)NbAcquisitions ? "" : "  ERROR: lost updates" );
+		fflush( stdout );
+	}
+
+	template <typename LOCK_TYPE>
+	void RunUncontended( const char * Name, unsigned int Acquisitions )
+	{
+		LOCK_TYPE Lock;
+		volatile unsigned int SharedCounter = 0;
+
+		PerfElapsedTime Timer;
+		for( unsigned int i = 0; i < Acquisitions; i++ )
+		{
+			SmartLocker SL_Lock( Lock );
+			SharedCounter = SharedCounter + 1;
+		}
+		const double VirtualSeconds = Timer.GetInSeconds();
+
+		Timer.Reset();
+		for( unsigned int i = 0; i < Acquisitions; i++ )
+		{
+			SmartPolicyLocker<LOCK_TYPE> SL_Lock( Lock );
+			SharedCounter = SharedCounter + 1;
+		}
+		const double PolicySeconds = Timer.GetInSeconds();
+
+		printf( "%-16s uncontended %8.2f ns with SmartLocker %8.2f ns with SmartPolicyLocker\n", Name,
+			VirtualSeconds * 1e9 / Acquisitions, PolicySeconds * 1e9 / Acquisitions );
+		fflush( stdout );
+	}
+
+	// Exclusive access with Lock/Unlock
+	template <typename LOCK_TYPE>
+	struct ExclusiveAccess
+	{
+		static void Lock( LOCK_TYPE& ToLock ) { ToLock.Lock(); }
+		static void Unlock( LOCK_TYPE& ToLock ) { ToLock.Unlock(); }
+	};
+
+	// Shared access with ReadLock/ReadUnlock
+	struct SharedAccess
+	{
+		static void Lock( ReadWriteMutex& ToLock ) { ToLock.ReadLock(); }
+		static void Unlock( ReadWriteMutex& ToLock ) { ToLock.ReadUnlock(); }
+	};
+
+	template <typename LOCK_TYPE, typename ACCESS>
+	void RunReaders( const char * Name, unsigned int NbThreads, unsigned int Acquisitions, unsigned int Work )
+	{
+		LOCK_TYPE Lock;
+		std::vector<unsigned int> SharedTable( Work + 1, 1 );
+		std::atomic<bool> Go( false );
+		std::atomic<unsigned long long> Checksum( 0 );
+		std::vector<std::thread> Threads;
+
+		for( unsigned int t = 0; t < NbThreads; t++ )
+		{
+			Threads.push_back( std::thread( [&]()
+			{
+				while( Go.load() == false )
+				{
+					std::this_thread::yield();
+				}
+
+				unsigned long long Sum = 0;
+				for( unsigned int i = 0; i < Acquisitions; i++ )
+				{
+					ACCESS::Lock( Lock );
+					for( size_t w = 0; w < SharedTable.size(); w++ )
+					{
+						Sum += SharedTable[w];
+					}
+					ACCESS::Unlock( Lock );
+				}
+				Checksum += Sum;
+			} ) );
+		}
+
+		PerfElapsedTime Timer;
+		Go.store( true );
+		for( unsigned int t = 0; t < NbThreads; t++ )
+		{
+			Threads[t].join();
+		}
+		const double Seconds = Timer.GetInSeconds();
+
+		const double NbAcquisitions = (double)NbThreads * (double)Acquisitions;
+		printf( "%-16s %3u readers %12.0f locks/s%s\n", Name, NbThreads, NbAcquisitions / Seconds,
+			Checksum.load() == (unsigned long long)NbAcquisitions * SharedTable.size() ? "" : "  ERROR: bad checksum" );
+		fflush( stdout );
+	}
+
+	template <typename LOCK_TYPE, typename ACCESS>
+	void RunAllReaders( const char * Name, unsigned int MaxThreads, unsigned int Acquisitions, unsigned int Work )
+	{
+		for( unsigned int NbThreads = 1; NbThreads <= MaxThreads; NbThreads *= 2 )
+		{
+			RunReaders<LOCK_TYPE, ACCESS>( Name, NbThreads, Acquisitions, Work );
+		}
+	}
+
+	template <typename LOCK_TYPE>
+	void RunAllContentions( const char * Name, unsigned int MaxThreads, unsigned int Acquisitions, unsigned int Work )
+	{
+		for( unsigned int NbThreads = 2; NbThreads <= MaxThreads; NbThreads *= 2 )
+		{
+			RunContention<LOCK_TYPE>( Name, NbThreads, Acquisitions, Work );
+		}
+	}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+	unsigned int Acquisitions = 20000;
+	unsigned int MaxThreads = 64;
+	unsigned int Work = 100;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		if ( i+1 < argc && strcmp( argv[i], "-i" ) == 0 )
+		{
+			Acquisitions = (unsigned int)strtoul( argv[++i], NULL, 10 );
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-t" ) == 0 )
+		{
+			MaxThreads = (unsigned int)strtoul( argv[++i], NULL, 10 );
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-w" ) == 0 )
+		{
+			Work = (unsigned int)strtoul( argv[++i], NULL, 10 );
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [-i AcquisitionsPerThread] [-t MaxThreads] [-w CriticalSectionWork]\n", argv[0] );
+			return 2;
+		}
+	}
+
+	RunUncontended<NullLock>( "NullLock", Acquisitions * 100 );
+	RunUncontended<SpinLock>( "SpinLock", Acquisitions * 100 );
+	RunUncontended<Mutex>( "Mutex", Acquisitions * 100 );
+	RunUncontended<ReentrantMutex>( "ReentrantMutex", Acquisitions * 100 );
+	RunUncontended<AdaptiveMutex>( "AdaptiveMutex", Acquisitions * 100 );
+
+	RunAllContentions<Mutex>( "Mutex", MaxThreads, Acquisitions, Work );
+	RunAllContentions<ReentrantMutex>( "ReentrantMutex", MaxThreads, Acquisitions, Work );
+	RunAllContentions<AdaptiveMutex>( "AdaptiveMutex", MaxThreads, Acquisitions, Work );
+	RunAllContentions<ReadWriteMutex>( "ReadWriteMutex", MaxThreads, Acquisitions, Work );
+	RunAllContentions<SpinLock>( "SpinLock", MaxThreads, Acquisitions, Work );
+
+	RunAllReaders< Mutex, ExclusiveAccess<Mutex> >( "Mutex", MaxThreads, Acquisitions, Work );
+	RunAllReaders< ReadWriteMutex, SharedAccess >( "ReadWriteMutex", MaxThreads, Acquisitions, Work );
+
+	return 0;
+}
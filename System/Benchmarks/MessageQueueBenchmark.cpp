@@ -0,0 +1,156 @@
+/**
+ * @file System/Benchmarks/MessageQueueBenchmark.cpp
+ * @ingroup System
+ * @brief Throughput of the message queues of threads with many senders
+ *
+ * Usage: OmiscidMessageQueueBenchmark [-m MessagesPerProducer] [-p MaxProducers]
+ *
+ * For 1 to MaxProducers (default 32) producer threads, each producer adds
+ * MessagesPerProducer messages (default 200000) to the same queue while one
+ * consumer thread extracts them. The queues compared are the MutexedSimpleList
+ * used by Thread before (with a ReentrantMutex and with an AdaptiveMutex) and the
+ * lock free MpscQueue used now.
+ */
+
+#include <System/AdaptiveMutex.h>
+#include <System/ElapsedTime.h>
+#include <System/MpscQueue.h>
+#include <System/MutexedSimpleList.h>
+#include <System/ReentrantMutex.h>
+#include <System/Thread.h>
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Omiscid;
+
+namespace {
+
+	// Same calls as Thread::SendMessage and Thread::GetMessage with a mutexed list
+	template <typename LOCK_TYPE>
+	struct MutexedListQueue
+	{
+		void Push( const ThreadMessage& Message )
+		{
+			SmartLocker SL_Queue(Queue);
+			Queue.AddTail( Message );
+		}
+
+		bool Pop( ThreadMessage& Message )
+		{
+			SmartLocker SL_Queue(Queue);
+			if ( Queue.GetNumberOfElements() == 0 )
+			{
+				return false;
+			}
+			Message = Queue.ExtractFirst();
+			return true;
+		}
+
+		MutexedSimpleList<ThreadMessage, LOCK_TYPE> Queue;
+	};
+
+	template <typename QUEUE_TYPE>
+	void RunProducers( const char * Name, unsigned int NbProducers, unsigned int Messages )
+	{
+		QUEUE_TYPE Queue;
+		std::atomic<bool> Go( false );
+		std::vector<std::thread> Producers;
+
+		for( unsigned int t = 0; t < NbProducers; t++ )
+		{
+			Producers.push_back( std::thread( [&, t]()
+			{
+				while( Go.load() == false )
+				{
+					std::this_thread::yield();
+				}
+
+				for( unsigned int i = 0; i < Messages; i++ )
+				{
+					Queue.Push( ThreadMessage( (int)t, (void*)(size_t)(i+1) ) );
+				}
+			} ) );
+		}
+
+		// The consumer checks that the messages of each producer arrive in order
+		const unsigned long long NbMessages = (unsigned long long)NbProducers * Messages;
+		std::vector<size_t> LastReceived( NbProducers, 0 );
+		bool Ordered = true;
+
+		PerfElapsedTime Timer;
+		Go.store( true );
+
+		ThreadMessage Message;
+		for( unsigned long long Received = 0; Received < NbMessages; )
+		{
+			if ( Queue.Pop( Message ) == false )
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			const size_t Index = (size_t)Message.Param1;
+			if ( Index != LastReceived[Message.Code] + 1 )
+			{
+				Ordered = false;
+			}
+			LastReceived[Message.Code] = Index;
+			Received++;
+		}
+		const double Seconds = Timer.GetInSeconds();
+
+		for( unsigned int t = 0; t < NbProducers; t++ )
+		{
+			Producers[t].join();
+		}
+
+		printf( "%-28s %3u producers %12.0f messages/s%s\n", Name, NbProducers, (double)NbMessages / Seconds,
+			Ordered ? "" : "  ERROR: messages out of order" );
+		fflush( stdout );
+	}
+
+	template <typename QUEUE_TYPE>
+	void RunAllProducers( const char * Name, unsigned int MaxProducers, unsigned int Messages )
+	{
+		for( unsigned int NbProducers = 1; NbProducers <= MaxProducers; NbProducers *= 2 )
+		{
+			RunProducers<QUEUE_TYPE>( Name, NbProducers, Messages );
+		}
+	}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+	unsigned int Messages = 200000;
+	unsigned int MaxProducers = 32;
+
+	for( int i = 1; i < argc; i++ )
+	{
+		if ( i+1 < argc && strcmp( argv[i], "-m" ) == 0 )
+		{
+			Messages = (unsigned int)strtoul( argv[++i], NULL, 10 );
+		}
+		else if ( i+1 < argc && strcmp( argv[i], "-p" ) == 0 )
+		{
+			MaxProducers = (unsigned int)strtoul( argv[++i], NULL, 10 );
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [-m MessagesPerProducer] [-p MaxProducers]\n", argv[0] );
+			return 2;
+		}
+	}
+
+	RunAllProducers< MutexedListQueue<ReentrantMutex> >( "MutexedSimpleList (Reentrant)", MaxProducers, Messages );
+	RunAllProducers< MutexedListQueue<AdaptiveMutex> >( "MutexedSimpleList (Adaptive)", MaxProducers, Messages );
+	RunAllProducers< MpscQueue<ThreadMessage> >( "MpscQueue", MaxProducers, Messages );
+
+	return 0;
+}
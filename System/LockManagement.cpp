@@ -3,15 +3,60 @@
 //////////////////////////////////////////////////////////////////////
 
 #include <System/LockManagement.h>
+#include <System/LockProfiler.h>
 // #include <System/Thread.h>
 
 using namespace Omiscid;
 
+LockableObject::~LockableObject()
+{
+	delete pProfileHook;
+}
+
+bool LockableObject::EnableProfiling( const char * Name )
+{
+	OmiscidError( "LockableObject::EnableProfiling: this object can not be profiled ('%s').\n", Name );
+	return false;
+}
+
+bool LockableObject::CreateProfileHook( const char * Name )
+{
+	if ( pProfileHook != NULL )
+	{
+		// Already profiled
+		return true;
+	}
+
+	const int Id = LockProfiler::GetProfileId( Name );
+	if ( Id < 0 )
+	{
+		return false;
+	}
+	pProfileHook = new OMISCID_TLM LockProfileHook( (unsigned int)Id );
+	Profiled = true;
+	return true;
+}
+
+void LockableObject::ProfileAcquired()
+{
+	pProfileHook->Acquired();
+}
+
+void LockableObject::ProfileAcquiredAfterWait( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite )
+{
+	pProfileHook->AcquiredAfterWait( WaitStart, CallSite );
+}
+
+void LockableObject::ProfileReleased()
+{
+	pProfileHook->Released();
+}
+
 	/** @brief Constructor
 	 *
 	 */
 SmartLocker::SmartLocker( LockableObject& LockableObjectToManage, bool LockAtInit /* = true */ )
-	: ManagedLoackableObject(LockableObjectToManage)
+	: CallSite(OMISCID_RETURN_ADDRESS()), ManagedLoackableObject(LockableObjectToManage)
 {
 	// Initiate the LockCount
 	LockCount = 0;
@@ -27,7 +72,7 @@ SmartLocker::SmartLocker( LockableObject& LockableObjectToManage, bool LockAtIni
 	 *
 	 */
 SmartLocker::SmartLocker( const LockableObject& LockableObjectToManage, bool LockAtInit /* = true */ )
-	: ManagedLoackableObject((LockableObject&)LockableObjectToManage)
+	: CallSite(OMISCID_RETURN_ADDRESS()), ManagedLoackableObject((LockableObject&)LockableObjectToManage)
 {
 	// Initiate the LockCount
 	LockCount = 0;
@@ -61,7 +106,18 @@ SmartLocker::~SmartLocker()
 	 */
 bool SmartLocker::Lock(int wait_us /* = 0 */)
 {
-	bool res = ManagedLoackableObject.Lock(wait_us);
+	bool res;
+	if ( ManagedLoackableObject.IsProfiled() == false )
+	{
+		res = ManagedLoackableObject.Lock(wait_us);
+	}
+	else
+	{
+		// Waits are reported at the caller of the SmartLocker, not here
+		LockProfiler::PendingCallSite = CallSite;
+		res = ManagedLoackableObject.Lock(wait_us);
+		LockProfiler::PendingCallSite = NULL;
+	}
 	if ( res == true )
 	{
 		LockCount++;
@@ -0,0 +1,530 @@
+#include <System/LockProfiler.h>
+
+#include <atomic>
+#include <mutex>
+#include <list>
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+using namespace Omiscid;
+
+thread_local void * LockProfiler::PendingCallSite = NULL;
+
+namespace {
+
+	typedef unsigned long long Counter;
+
+	/** @brief Increment a counter only written by one thread, without a locked instruction */
+	inline void Add( std::atomic<Counter>& Value, Counter Increment )
+	{
+		Value.store( Value.load(std::memory_order_relaxed) + Increment, std::memory_order_relaxed );
+	}
+
+	unsigned int GetHistogramBucket( Counter DurationNs )
+	{
+		unsigned int Bucket = 0;
+		while( DurationNs > 1 && Bucket < LockProfiler::NbHistogramBuckets - 1 )
+		{
+			DurationNs >>= 1;
+			Bucket++;
+		}
+		return Bucket;
+	}
+
+	/** @brief Counters of one lock name in one thread */
+	struct ThreadCounters
+	{
+		ThreadCounters()
+		{
+			Acquisitions = 0;
+			ContendedAcquisitions = 0;
+			WaitTimeNs = 0;
+			SampledHolds = 0;
+			HoldTimeNs = 0;
+			for( unsigned int i = 0; i < LockProfiler::NbHistogramBuckets; i++ )
+			{
+				WaitHistogram[i] = 0;
+				HoldHistogram[i] = 0;
+			}
+		}
+
+		std::atomic<Counter> Acquisitions;
+		std::atomic<Counter> ContendedAcquisitions;
+		std::atomic<Counter> WaitTimeNs;
+		std::atomic<Counter> SampledHolds;
+		std::atomic<Counter> HoldTimeNs;
+		std::atomic<Counter> WaitHistogram[LockProfiler::NbHistogramBuckets];
+		std::atomic<Counter> HoldHistogram[LockProfiler::NbHistogramBuckets];
+	};
+
+	/** @brief Plain copy of counters, used to merge threads */
+	struct Totals
+	{
+		Totals()
+		{
+			memset( this, 0, sizeof(Totals) );
+		}
+
+		void Add( const ThreadCounters& Counters )
+		{
+			Acquisitions += Counters.Acquisitions.load(std::memory_order_relaxed);
+			ContendedAcquisitions += Counters.ContendedAcquisitions.load(std::memory_order_relaxed);
+			WaitTimeNs += Counters.WaitTimeNs.load(std::memory_order_relaxed);
+			SampledHolds += Counters.SampledHolds.load(std::memory_order_relaxed);
+			HoldTimeNs += Counters.HoldTimeNs.load(std::memory_order_relaxed);
+			for( unsigned int i = 0; i < LockProfiler::NbHistogramBuckets; i++ )
+			{
+				WaitHistogram[i] += Counters.WaitHistogram[i].load(std::memory_order_relaxed);
+				HoldHistogram[i] += Counters.HoldHistogram[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		Counter Acquisitions;
+		Counter ContendedAcquisitions;
+		Counter WaitTimeNs;
+		Counter SampledHolds;
+		Counter HoldTimeNs;
+		Counter WaitHistogram[LockProfiler::NbHistogramBuckets];
+		Counter HoldHistogram[LockProfiler::NbHistogramBuckets];
+	};
+
+	/** @brief Call site slot, shared by all threads (only used on contention) */
+	struct CallSiteSlot
+	{
+		CallSiteSlot() : Address(NULL), Waits(0), WaitTimeNs(0), BaselineWaits(0), BaselineWaitTimeNs(0) {}
+
+		std::atomic<void *> Address;
+		std::atomic<Counter> Waits;
+		std::atomic<Counter> WaitTimeNs;
+		Counter BaselineWaits;			// Protected by the registry mutex
+		Counter BaselineWaitTimeNs;
+	};
+
+	struct Profile
+	{
+		SimpleString Name;
+		Totals Retired;					// Counters of the threads that have exited
+		Totals Baseline;				// Counters at the last Reset
+		CallSiteSlot CallSites[LockProfiler::MaxCallSites];
+	};
+
+	class ThreadBuffer;
+
+	// Set when the buffer of the thread is destroyed, locks taken later by the thread are not counted
+	thread_local bool ThreadBufferDestroyed = false;
+
+	struct Registry
+	{
+		Registry() : NbProfiles(0), SamplingPeriod(LockProfiler::DefaultSamplingPeriod)
+		{
+			for( unsigned int i = 0; i < LockProfiler::MaxProfiles; i++ )
+			{
+				Profiles[i] = NULL;
+			}
+		}
+
+		std::mutex Lock;
+		Profile * Profiles[LockProfiler::MaxProfiles];
+		std::atomic<unsigned int> NbProfiles;
+		std::list<ThreadBuffer*> Buffers;
+		std::atomic<unsigned int> SamplingPeriod;
+	};
+
+	Registry& GetRegistry()
+	{
+		// Never destroyed, locks can still be used by static destructors
+		static Registry * pRegistry = new Registry;
+		return *pRegistry;
+	}
+
+	/** @brief Counters of one thread, merged in the registry when the thread exits */
+	class ThreadBuffer
+	{
+	public:
+		ThreadBuffer() : SampleCountdown(1)
+		{
+			for( unsigned int i = 0; i < LockProfiler::MaxProfiles; i++ )
+			{
+				Slots[i] = NULL;
+			}
+
+			Registry& TheRegistry = GetRegistry();
+			std::lock_guard<std::mutex> Guard(TheRegistry.Lock);
+			TheRegistry.Buffers.push_back( this );
+		}
+
+		~ThreadBuffer()
+		{
+			ThreadBufferDestroyed = true;
+
+			Registry& TheRegistry = GetRegistry();
+			std::lock_guard<std::mutex> Guard(TheRegistry.Lock);
+			for( unsigned int i = 0; i < LockProfiler::MaxProfiles; i++ )
+			{
+				ThreadCounters * pCounters = Slots[i].load(std::memory_order_relaxed);
+				if ( pCounters != NULL )
+				{
+					TheRegistry.Profiles[i]->Retired.Add( *pCounters );
+					delete pCounters;
+				}
+			}
+			TheRegistry.Buffers.remove( this );
+		}
+
+		ThreadCounters& Get( unsigned int Id )
+		{
+			ThreadCounters * pCounters = Slots[Id].load(std::memory_order_relaxed);
+			if ( pCounters == NULL )
+			{
+				pCounters = new OMISCID_TLM ThreadCounters;
+				Slots[Id].store( pCounters, std::memory_order_release );
+			}
+			return *pCounters;
+		}
+
+		/** @brief Return true once every sampling period */
+		bool Sample()
+		{
+			if ( --SampleCountdown != 0 )
+			{
+				return false;
+			}
+			SampleCountdown = GetRegistry().SamplingPeriod.load(std::memory_order_relaxed);
+			return true;
+		}
+
+		std::atomic<ThreadCounters*> Slots[LockProfiler::MaxProfiles];	// Read by reports
+		unsigned int SampleCountdown;
+	};
+
+	thread_local ThreadBuffer CurrentThreadBuffer;
+
+	ThreadBuffer * GetThreadBuffer()
+	{
+		if ( ThreadBufferDestroyed == true )
+		{
+			return NULL;
+		}
+		return &CurrentThreadBuffer;
+	}
+
+	void AddCallSite( Profile& ToProfile, void * Address, Counter WaitNs )
+	{
+		const unsigned int Start = (unsigned int)(((size_t)Address >> 4) % LockProfiler::MaxCallSites);
+		for( unsigned int i = 0; i < LockProfiler::MaxCallSites; i++ )
+		{
+			CallSiteSlot& Slot = ToProfile.CallSites[(Start + i) % LockProfiler::MaxCallSites];
+			void * SlotAddress = Slot.Address.load(std::memory_order_acquire);
+			if ( SlotAddress == NULL )
+			{
+				// Claim the slot, someone else may have taken it for another address
+				if ( Slot.Address.compare_exchange_strong(SlotAddress, Address) == false && SlotAddress != Address )
+				{
+					continue;
+				}
+				SlotAddress = Address;
+			}
+			if ( SlotAddress == Address )
+			{
+				Slot.Waits.fetch_add( 1, std::memory_order_relaxed );
+				Slot.WaitTimeNs.fetch_add( WaitNs, std::memory_order_relaxed );
+				return;
+			}
+		}
+		// Table full, the call site is not recorded
+	}
+
+	/** @brief Current counters of a profile, registry mutex locked */
+	Totals GetCurrentTotals( Registry& TheRegistry, unsigned int Id )
+	{
+		Totals Result = TheRegistry.Profiles[Id]->Retired;
+		for( std::list<ThreadBuffer*>::iterator it = TheRegistry.Buffers.begin(); it != TheRegistry.Buffers.end(); ++it )
+		{
+			ThreadCounters * pCounters = (*it)->Slots[Id].load(std::memory_order_acquire);
+			if ( pCounters != NULL )
+			{
+				Result.Add( *pCounters );
+			}
+		}
+		return Result;
+	}
+
+	bool CompareReports( const LockProfiler::LockReport& Left, const LockProfiler::LockReport& Right )
+	{
+		return Left.WaitTimeNs > Right.WaitTimeNs;
+	}
+
+	bool CompareCallSites( const LockProfiler::CallSiteReport& Left, const LockProfiler::CallSiteReport& Right )
+	{
+		return Left.WaitTimeNs > Right.WaitTimeNs;
+	}
+
+	SimpleString GetSymbol( void * Address )
+	{
+#ifdef __GLIBC__
+		char ** Symbols = backtrace_symbols( &Address, 1 );
+		if ( Symbols != NULL )
+		{
+			SimpleString Symbol( Symbols[0] );
+			free( Symbols );
+			return Symbol;
+		}
+#endif
+		return SimpleString::EmptyString;
+	}
+
+	void AppendHistogram( SimpleString& Report, const char * Title, const Counter * Histogram )
+	{
+		char Buffer[64];
+		Report.Append( Title );
+		for( unsigned int i = 0; i < LockProfiler::NbHistogramBuckets; i++ )
+		{
+			if ( Histogram[i] != 0 )
+			{
+				// Lower bound of the bucket
+				snprintf( Buffer, sizeof(Buffer), " %lluns:%llu", 1ULL << i, Histogram[i] );
+				Report.Append( Buffer );
+			}
+		}
+		Report.Append( "\n" );
+	}
+
+} // anonymous namespace
+
+void LockProfiler::SetSamplingPeriod( unsigned int Period )
+{
+	if ( Period == 0 )
+	{
+		Period = 1;
+	}
+	GetRegistry().SamplingPeriod.store( Period, std::memory_order_relaxed );
+}
+
+unsigned int LockProfiler::GetSamplingPeriod()
+{
+	return GetRegistry().SamplingPeriod.load(std::memory_order_relaxed);
+}
+
+int LockProfiler::GetProfileId( const char * Name )
+{
+	Registry& TheRegistry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(TheRegistry.Lock);
+
+	const unsigned int NbProfiles = TheRegistry.NbProfiles.load(std::memory_order_relaxed);
+	for( unsigned int i = 0; i < NbProfiles; i++ )
+	{
+		if ( TheRegistry.Profiles[i]->Name == Name )
+		{
+			return (int)i;
+		}
+	}
+
+	if ( NbProfiles == MaxProfiles )
+	{
+		OmiscidError( "LockProfiler::GetProfileId: too many lock names, '%s' is not profiled.\n", Name );
+		return -1;
+	}
+
+	Profile * pProfile = new OMISCID_TLM Profile;
+	pProfile->Name = Name;
+	TheRegistry.Profiles[NbProfiles] = pProfile;
+	TheRegistry.NbProfiles.store( NbProfiles + 1, std::memory_order_release );
+	return (int)NbProfiles;
+}
+
+void LockProfiler::GetReports( std::vector<LockReport>& Reports )
+{
+	Registry& TheRegistry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(TheRegistry.Lock);
+
+	const unsigned int NbProfiles = TheRegistry.NbProfiles.load(std::memory_order_relaxed);
+	Reports.clear();
+	Reports.resize( NbProfiles );
+	for( unsigned int Id = 0; Id < NbProfiles; Id++ )
+	{
+		const Profile& CurrentProfile = *TheRegistry.Profiles[Id];
+		const Totals Current = GetCurrentTotals( TheRegistry, Id );
+		const Totals& Baseline = CurrentProfile.Baseline;
+		LockReport& Report = Reports[Id];
+
+		Report.Name = CurrentProfile.Name;
+		Report.Acquisitions = Current.Acquisitions - Baseline.Acquisitions;
+		Report.ContendedAcquisitions = Current.ContendedAcquisitions - Baseline.ContendedAcquisitions;
+		Report.WaitTimeNs = Current.WaitTimeNs - Baseline.WaitTimeNs;
+		Report.SampledHolds = Current.SampledHolds - Baseline.SampledHolds;
+		Report.HoldTimeNs = Current.HoldTimeNs - Baseline.HoldTimeNs;
+		for( unsigned int i = 0; i < NbHistogramBuckets; i++ )
+		{
+			Report.WaitHistogram[i] = Current.WaitHistogram[i] - Baseline.WaitHistogram[i];
+			Report.HoldHistogram[i] = Current.HoldHistogram[i] - Baseline.HoldHistogram[i];
+		}
+
+		for( unsigned int i = 0; i < MaxCallSites; i++ )
+		{
+			const CallSiteSlot& Slot = CurrentProfile.CallSites[i];
+			void * Address = Slot.Address.load(std::memory_order_acquire);
+			const Counter Waits = Slot.Waits.load(std::memory_order_relaxed) - Slot.BaselineWaits;
+			if ( Address == NULL || Waits == 0 )
+			{
+				continue;
+			}
+
+			CallSiteReport Site;
+			Site.Address = Address;
+			Site.Waits = Waits;
+			Site.WaitTimeNs = Slot.WaitTimeNs.load(std::memory_order_relaxed) - Slot.BaselineWaitTimeNs;
+			Report.CallSites.push_back( Site );
+		}
+		std::sort( Report.CallSites.begin(), Report.CallSites.end(), CompareCallSites );
+	}
+
+	std::sort( Reports.begin(), Reports.end(), CompareReports );
+
+	// Symbols are only looked for the reported call sites
+	for( size_t i = 0; i < Reports.size(); i++ )
+	{
+		for( size_t j = 0; j < Reports[i].CallSites.size(); j++ )
+		{
+			Reports[i].CallSites[j].Symbol = GetSymbol( Reports[i].CallSites[j].Address );
+		}
+	}
+}
+
+SimpleString LockProfiler::GetTextReport()
+{
+	std::vector<LockReport> Reports;
+	GetReports( Reports );
+
+	SimpleString Report;
+	char Buffer[512];
+
+	snprintf( Buffer, sizeof(Buffer), "Lock profile, hold time sampled every %u acquisitions\n", GetSamplingPeriod() );
+	Report.Append( Buffer );
+
+	for( size_t i = 0; i < Reports.size(); i++ )
+	{
+		const LockReport& Current = Reports[i];
+
+		snprintf( Buffer, sizeof(Buffer), "%s: %llu acquisitions, %llu contended (%.2f%%), wait %.3f ms (mean %.3f us), hold mean %.3f us\n",
+			Current.Name.GetStr(), Current.Acquisitions, Current.ContendedAcquisitions,
+			Current.Acquisitions == 0 ? 0.0 : 100.0 * (double)Current.ContendedAcquisitions / (double)Current.Acquisitions,
+			(double)Current.WaitTimeNs / 1e6,
+			Current.ContendedAcquisitions == 0 ? 0.0 : (double)Current.WaitTimeNs / 1e3 / (double)Current.ContendedAcquisitions,
+			Current.SampledHolds == 0 ? 0.0 : (double)Current.HoldTimeNs / 1e3 / (double)Current.SampledHolds );
+		Report.Append( Buffer );
+
+		AppendHistogram( Report, "  wait histogram:", Current.WaitHistogram );
+		AppendHistogram( Report, "  hold histogram:", Current.HoldHistogram );
+
+		for( size_t j = 0; j < Current.CallSites.size(); j++ )
+		{
+			const CallSiteReport& Site = Current.CallSites[j];
+			snprintf( Buffer, sizeof(Buffer), "  %p %s: %llu waits, %.3f ms\n", Site.Address, Site.Symbol.GetStr(),
+				Site.Waits, (double)Site.WaitTimeNs / 1e6 );
+			Report.Append( Buffer );
+		}
+	}
+
+	return Report;
+}
+
+void LockProfiler::Reset()
+{
+	Registry& TheRegistry = GetRegistry();
+	std::lock_guard<std::mutex> Guard(TheRegistry.Lock);
+
+	// Counters are only written by their threads, keep the current values as the new origin
+	const unsigned int NbProfiles = TheRegistry.NbProfiles.load(std::memory_order_relaxed);
+	for( unsigned int Id = 0; Id < NbProfiles; Id++ )
+	{
+		Profile& CurrentProfile = *TheRegistry.Profiles[Id];
+		CurrentProfile.Baseline = GetCurrentTotals( TheRegistry, Id );
+		for( unsigned int i = 0; i < MaxCallSites; i++ )
+		{
+			CallSiteSlot& Slot = CurrentProfile.CallSites[i];
+			Slot.BaselineWaits = Slot.Waits.load(std::memory_order_relaxed);
+			Slot.BaselineWaitTimeNs = Slot.WaitTimeNs.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+LockProfileHook::LockProfileHook( unsigned int ProfileId )
+	: Id(ProfileId), Depth(0), HoldSampled(false)
+{
+}
+
+void LockProfileHook::StartHold( bool Sampled )
+{
+	HoldSampled = Sampled;
+	if ( HoldSampled == true )
+	{
+		HoldStart = std::chrono::steady_clock::now();
+	}
+}
+
+void LockProfileHook::Acquired()
+{
+	ThreadBuffer * pBuffer = GetThreadBuffer();
+	if ( Depth++ != 0 || pBuffer == NULL )
+	{
+		return;
+	}
+
+	Add( pBuffer->Get(Id).Acquisitions, 1 );
+	StartHold( pBuffer->Sample() );
+}
+
+void LockProfileHook::AcquiredAfterWait( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite )
+{
+	const Counter WaitNs = (Counter)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - WaitStart).count();
+
+	ThreadBuffer * pBuffer = GetThreadBuffer();
+	if ( Depth++ != 0 || pBuffer == NULL )
+	{
+		return;
+	}
+
+	ThreadCounters& Counters = pBuffer->Get(Id);
+	Add( Counters.Acquisitions, 1 );
+	Add( Counters.ContendedAcquisitions, 1 );
+	Add( Counters.WaitTimeNs, WaitNs );
+	Add( Counters.WaitHistogram[GetHistogramBucket(WaitNs)], 1 );
+
+	// Prefer the call site given by SmartLocker to the caller of Lock
+	if ( LockProfiler::PendingCallSite != NULL )
+	{
+		CallSite = LockProfiler::PendingCallSite;
+	}
+	AddCallSite( *GetRegistry().Profiles[Id], CallSite, WaitNs );
+
+	StartHold( pBuffer->Sample() );
+}
+
+void LockProfileHook::Released()
+{
+	if ( Depth == 0 || --Depth != 0 || HoldSampled == false )
+	{
+		return;
+	}
+
+	const Counter HoldNs = (Counter)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - HoldStart).count();
+	HoldSampled = false;
+
+	ThreadBuffer * pBuffer = GetThreadBuffer();
+	if ( pBuffer == NULL )
+	{
+		return;
+	}
+
+	ThreadCounters& Counters = pBuffer->Get(Id);
+	Add( Counters.SampledHolds, 1 );
+	Add( Counters.HoldTimeNs, HoldNs );
+	Add( Counters.HoldHistogram[GetHistogramBucket(HoldNs)], 1 );
+}
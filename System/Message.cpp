@@ -10,7 +10,12 @@ using namespace Omiscid;
 
 Message::Message(size_t size)
 {
+  buffer = (const char*)NULL;
+  len = 0;
   origine = UnknownOrigine;
+  pid = 0;
+  mid = 0;
+  flags = 0;
 
   if ( size > 0 )
   {
@@ -23,15 +28,23 @@ Message::Message(size_t size)
 
 Message::Message(const Message& ToCopy)
 {
-	size_t len = ToCopy.GetLength();
-	SetNewBufferSize(len);
+	// Copy from buffer/len, the data may not be owned by ToCopy
+	SetNewBufferSize(ToCopy.len);
+
+	if ( ToCopy.len > 0 )
+	{
+		memcpy((void*)MemoryBuffer::GetBuffer(), ToCopy.buffer, ToCopy.len);
+
+		// MemoryBuffer always allocates one more byte, keep data null terminated
+		((char*)MemoryBuffer::GetBuffer())[ToCopy.len] = '\0';
+	}
 
-	memcpy((void*)ToCopy.GetBuffer(), GetBuffer(), len);
 	buffer = MemoryBuffer::GetBuffer();
-	len = MemoryBuffer::GetLength();
-	origine = ToCopy.GetOrigine();
-	pid = ToCopy.GetPeerId();
-	mid = ToCopy.GetMsgId();
+	len = ToCopy.len;
+	origine = ToCopy.origine;
+	pid = ToCopy.pid;
+	mid = ToCopy.mid;
+	flags = ToCopy.flags;
 }
 
 const char * Message::GetBuffer() const
@@ -59,6 +72,11 @@ unsigned int Message::GetMsgId() const
 	return mid;
 }
 
+unsigned int Message::GetFlags() const
+{
+	return flags;
+}
+
   /** @brief ToString
    *
    * Generate a description of the message
@@ -71,8 +89,6 @@ SimpleString Message::ToString(unsigned int MaxBufferLenToWrite /* default = 20,
 	TmpMessage	 += mid;
 	TmpMessage	 += " (";
 
-	size_t len = GetLength();
-
 	if ( len < 1024 )	// less that 1 KB
 	{
 		TmpMessage += len;
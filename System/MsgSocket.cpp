@@ -0,0 +1,170 @@
+/**
+ * @file System/MsgSocket.cpp
+ * @ingroup System
+ * @brief Implementation of MsgSocket class
+ */
+
+#include <System/MsgSocket.h>
+#include <System/LockManagement.h>
+#include <System/SocketException.h>
+
+#include <string.h>
+
+using namespace Omiscid;
+
+MsgSocket::MsgSocket( Socket * pConnectedSocket, size_t ReceiveBufferSize /* = DefaultReceiveBufferSize */, size_t MaxMessageSize /* = DefaultMaxMessageSize */ )
+	: pSocket(pConnectedSocket), DataStart(0), DataEnd(0), MaxMessageLength(MaxMessageSize),
+	TerminatedBytePosition((char*)NULL), TerminatedByte('\0')
+{
+	if ( ReceiveBufferSize < HeaderSize )
+	{
+		ReceiveBufferSize = HeaderSize;
+	}
+
+	// +1 to be able to null terminate a frame at the end of the buffer
+	ReceiveBuffer.resize( ReceiveBufferSize + 1 );
+}
+
+MsgSocket::~MsgSocket()
+{
+}
+
+Socket * MsgSocket::GetSocket() const
+{
+	return pSocket;
+}
+
+void MsgSocket::Send( const char * Payload, size_t Length, unsigned int PeerId, unsigned int MsgId, unsigned int Flags /* = RawEncoding */ )
+{
+	if ( Length > 0xffffffff )
+	{
+		throw SocketException( "MsgSocket::Send: message too large" );
+	}
+
+	uint32_t Header[4];
+	Header[0] = htonl( (uint32_t)Length );
+	Header[1] = htonl( (uint32_t)PeerId );
+	Header[2] = htonl( (uint32_t)MsgId );
+	Header[3] = htonl( (uint32_t)Flags );
+
+	// Frames from several threads must not be interleaved
+	SmartLocker SL_SendLocker( SendLocker );
+
+	pSocket->Send( HeaderSize, (const char*)Header, Length, Payload );
+}
+
+void MsgSocket::Send( const SimpleString& Payload, unsigned int PeerId, unsigned int MsgId, unsigned int Flags /* = JsonEncoding */ )
+{
+	Send( Payload.GetStr(), Payload.GetLength(), PeerId, MsgId, Flags );
+}
+
+void MsgSocket::RestoreTerminatedByte()
+{
+	if ( TerminatedBytePosition != (char*)NULL )
+	{
+		*TerminatedBytePosition = TerminatedByte;
+		TerminatedBytePosition = (char*)NULL;
+	}
+}
+
+size_t MsgSocket::GetBufferedLength() const
+{
+	return DataEnd - DataStart;
+}
+
+bool MsgSocket::GetBufferedMessage( Message& Msg )
+{
+	RestoreTerminatedByte();
+
+	if ( DataEnd - DataStart < HeaderSize )
+	{
+		return false;
+	}
+
+	uint32_t Header[4];
+	memcpy( Header, &ReceiveBuffer[DataStart], HeaderSize );
+
+	const size_t Length = (size_t)ntohl( Header[0] );
+	if ( Length > MaxMessageLength )
+	{
+		throw SocketException( "MsgSocket::GetBufferedMessage: message too large" );
+	}
+
+	if ( DataEnd - DataStart < HeaderSize + Length )
+	{
+		// Frame not complete
+		return false;
+	}
+
+	char * Payload = &ReceiveBuffer[DataStart + HeaderSize];
+
+	// Null terminate in place, the overwritten byte (beginning of the next frame
+	// or spare byte at end of buffer) will be restored at next call
+	TerminatedBytePosition = Payload + Length;
+	TerminatedByte = *TerminatedBytePosition;
+	*TerminatedBytePosition = '\0';
+
+	Msg.buffer = Payload;
+	Msg.len = Length;
+	Msg.origine = FromTCP;
+	Msg.pid = (unsigned int)ntohl( Header[1] );
+	Msg.mid = (unsigned int)ntohl( Header[2] );
+	Msg.flags = (unsigned int)ntohl( Header[3] );
+
+	DataStart += HeaderSize + Length;
+	if ( DataStart == DataEnd )
+	{
+		// Nothing pending, next reception will start at the begining of the buffer
+		DataStart = DataEnd = 0;
+	}
+
+	return true;
+}
+
+void MsgSocket::PrepareReception()
+{
+	RestoreTerminatedByte();
+
+	// Move the partial frame at the begining of the buffer
+	if ( DataStart > 0 )
+	{
+		memmove( &ReceiveBuffer[0], &ReceiveBuffer[DataStart], DataEnd - DataStart );
+		DataEnd -= DataStart;
+		DataStart = 0;
+	}
+
+	// Grow buffer if the pending frame is larger than it
+	if ( DataEnd >= HeaderSize )
+	{
+		uint32_t FrameLength;
+		memcpy( &FrameLength, &ReceiveBuffer[0], sizeof(FrameLength) );
+
+		const size_t Needed = HeaderSize + (size_t)ntohl( FrameLength );
+		if ( Needed > ReceiveBuffer.size() - 1 )
+		{
+			ReceiveBuffer.resize( Needed + 1 );
+		}
+	}
+}
+
+bool MsgSocket::Receive( Message& Msg )
+{
+	for(;;)
+	{
+		if ( GetBufferedMessage( Msg ) == true )
+		{
+			return true;
+		}
+
+		PrepareReception();
+
+		// Read as much as possible, many frames may come at once
+		int res = pSocket->Recv( (ReceiveBuffer.size() - 1) - DataEnd, (unsigned char*)&ReceiveBuffer[DataEnd] );
+		if ( res <= 0 )
+		{
+			// Connection closed
+			return false;
+		}
+		DataEnd += (size_t)res;
+	}
+}
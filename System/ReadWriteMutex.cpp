@@ -0,0 +1,269 @@
+#include <System/ReadWriteMutex.h>
+
+#include <chrono>
+
+using namespace Omiscid;
+
+ReadWriteMutex::ReadWriteMutex( bool PreferWriters /* = true */ )
+	: State(0), NbWaitingReaders(0), NbWaitingWriters(0)
+{
+	if ( PreferWriters == true )
+	{
+		ReaderBlockingMask = WriterLocked | WritersWaiting;
+	}
+	else
+	{
+		ReaderBlockingMask = WriterLocked;
+	}
+}
+
+ReadWriteMutex::~ReadWriteMutex()
+{
+}
+
+bool ReadWriteMutex::TryReadLock()
+{
+	unsigned int Current = State.load(std::memory_order_relaxed);
+	while( (Current & ReaderBlockingMask) == 0 && (Current & ReadersMask) != ReadersMask )
+	{
+		if ( State.compare_exchange_weak(Current, Current + 1, std::memory_order_acquire, std::memory_order_relaxed) == true )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ReadWriteMutex::TryWriteLock()
+{
+	unsigned int Current = State.load(std::memory_order_relaxed);
+	while( (Current & (WriterLocked | ReadersMask)) == 0 )
+	{
+		if ( State.compare_exchange_weak(Current, Current | WriterLocked, std::memory_order_acquire, std::memory_order_relaxed) == true )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ReadWriteMutex::ReadLock(int wait_us /* = 0 */)
+{
+	if ( TryReadLock() == true )
+	{
+		return true;
+	}
+	return ReadLockContended( wait_us );
+}
+
+bool ReadWriteMutex::WriteLock(int wait_us /* = 0 */)
+{
+	if ( TryWriteLock() == true )
+	{
+		return true;
+	}
+	return WriteLockContended( wait_us );
+}
+
+bool ReadWriteMutex::ReadUnlock()
+{
+	if ( (State.load(std::memory_order_relaxed) & ReadersMask) == 0 )
+	{
+		OmiscidError( "ReadWriteMutex::ReadUnlock: the mutex is not read locked." );
+		return false;
+	}
+
+	const unsigned int PreviousState = State.fetch_sub(1, std::memory_order_release);
+	if ( (PreviousState & ReadersMask) == 1 )
+	{
+		// Last reader, a writer may be waiting
+		WakeWaiters( PreviousState );
+	}
+	return true;
+}
+
+bool ReadWriteMutex::WriteUnlock()
+{
+	if ( (State.load(std::memory_order_relaxed) & WriterLocked) == 0 )
+	{
+		OmiscidError( "ReadWriteMutex::WriteUnlock: the mutex is not write locked." );
+		return false;
+	}
+
+	const unsigned int PreviousState = State.fetch_and(~WriterLocked, std::memory_order_release);
+	WakeWaiters( PreviousState );
+	return true;
+}
+
+void ReadWriteMutex::WakeWaiters( unsigned int PreviousState )
+{
+	if ( (PreviousState & (ReadersWaiting | WritersWaiting)) == 0 )
+	{
+		return;
+	}
+
+	// Waiters check the state and block while holding WaitMutex, taking it here
+	// ensures none of them can miss this notification
+	std::lock_guard<std::mutex> Guard(WaitMutex);
+	WaitCondition.notify_all();
+}
+
+bool ReadWriteMutex::ReadLockContended( int wait_us )
+{
+	const std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(wait_us > 0 ? wait_us : 0);
+
+	std::unique_lock<std::mutex> Guard(WaitMutex);
+
+	// Set the flag before checking the state again, so a release either is seen
+	// by the check or sees the flag and notifies us
+	if ( NbWaitingReaders++ == 0 )
+	{
+		State.fetch_or( ReadersWaiting );
+	}
+
+	bool Acquired;
+	while( (Acquired = TryReadLock()) == false )
+	{
+		if ( wait_us <= 0 )
+		{
+			WaitCondition.wait( Guard );
+		}
+		else if ( WaitCondition.wait_until( Guard, Deadline ) == std::cv_status::timeout )
+		{
+			Acquired = TryReadLock();
+			break;
+		}
+	}
+
+	if ( --NbWaitingReaders == 0 )
+	{
+		State.fetch_and( ~ReadersWaiting );
+	}
+
+	return Acquired;
+}
+
+bool ReadWriteMutex::WriteLockContended( int wait_us )
+{
+	const std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(wait_us > 0 ? wait_us : 0);
+
+	std::unique_lock<std::mutex> Guard(WaitMutex);
+
+	// With writer preference, this flag also blocks new readers
+	if ( NbWaitingWriters++ == 0 )
+	{
+		State.fetch_or( WritersWaiting );
+	}
+
+	bool Acquired;
+	while( (Acquired = TryWriteLock()) == false )
+	{
+		if ( wait_us <= 0 )
+		{
+			WaitCondition.wait( Guard );
+		}
+		else if ( WaitCondition.wait_until( Guard, Deadline ) == std::cv_status::timeout )
+		{
+			Acquired = TryWriteLock();
+			break;
+		}
+	}
+
+	if ( --NbWaitingWriters == 0 )
+	{
+		State.fetch_and( ~WritersWaiting );
+		if ( Acquired == false && (ReaderBlockingMask & WritersWaiting) != 0 )
+		{
+			// We gave up: readers blocked only because we were waiting can enter now
+			WaitCondition.notify_all();
+		}
+	}
+
+	return Acquired;
+}
+
+SmartReadLocker::SmartReadLocker( ReadWriteMutex& MutexToManage, bool LockAtInit /* = true */ )
+	: LockCount(0), ManagedMutex(MutexToManage)
+{
+	if ( LockAtInit == true )
+	{
+		Lock();
+	}
+}
+
+SmartReadLocker::~SmartReadLocker()
+{
+	while( LockCount > 0 )
+	{
+		ManagedMutex.ReadUnlock();
+		LockCount--;
+	}
+}
+
+bool SmartReadLocker::Lock(int wait_us /* = 0 */)
+{
+	if ( ManagedMutex.ReadLock(wait_us) == false )
+	{
+		return false;
+	}
+	LockCount++;
+	return true;
+}
+
+bool SmartReadLocker::Unlock()
+{
+	if ( LockCount == 0 )
+	{
+		OmiscidError( "SmartReadLocker::Unlock : the object is not lock." );
+		return false;
+	}
+	if ( ManagedMutex.ReadUnlock() == true )
+	{
+		LockCount--;
+		return true;
+	}
+	return false;
+}
+
+SmartWriteLocker::SmartWriteLocker( ReadWriteMutex& MutexToManage, bool LockAtInit /* = true */ )
+	: LockCount(0), ManagedMutex(MutexToManage)
+{
+	if ( LockAtInit == true )
+	{
+		Lock();
+	}
+}
+
+SmartWriteLocker::~SmartWriteLocker()
+{
+	while( LockCount > 0 )
+	{
+		ManagedMutex.WriteUnlock();
+		LockCount--;
+	}
+}
+
+bool SmartWriteLocker::Lock(int wait_us /* = 0 */)
+{
+	if ( ManagedMutex.WriteLock(wait_us) == false )
+	{
+		return false;
+	}
+	LockCount++;
+	return true;
+}
+
+bool SmartWriteLocker::Unlock()
+{
+	if ( LockCount == 0 )
+	{
+		OmiscidError( "SmartWriteLocker::Unlock : the object is not lock." );
+		return false;
+	}
+	if ( ManagedMutex.WriteUnlock() == true )
+	{
+		LockCount--;
+		return true;
+	}
+	return false;
+}
@@ -1,6 +1,5 @@
 #include <System/ReentrantMutex.h>
-#include <System/ElapsedTime.h>
-#include <System/Thread.h>
+#include <System/LockProfiler.h>
 
 using namespace Omiscid;
 
@@ -11,26 +10,28 @@ using namespace Omiscid;
 	* @return false if an error occured
 	*/
 bool ReentrantMutex::Lock(int wait_us /* = 0*/ )
-{	
+{
+	if ( pProfileHook != NULL )
+	{
+		return ProfiledLock( wait_us, OMISCID_RETURN_ADDRESS() );
+	}
+	return WaitForLock( wait_us );
+}
+
+bool ReentrantMutex::WaitForLock(int wait_us)
+{
 	try
 	{
-		if ( wait_us == 0 )
+		if ( wait_us <= 0 )
 		{
-			while( InternalMutex.try_lock() == false )
-			{
-				Omiscid::Thread::Usleep(100);
-			}
+			// Wait in the kernel until the owner releases the mutex
+			InternalMutex.lock();
 		}
 		else
 		{
-			Omiscid::PerfElapsedTime Time;
-			while( InternalMutex.try_lock() == false )
+			if ( InternalMutex.try_lock_for( std::chrono::microseconds(wait_us) ) == false )
 			{
-				if ( Time.Get() >= wait_us )
-				{
-					return false;
-				}
-				Omiscid::Thread::Usleep(100);
+				return false;
 			}
 		}
 	}
@@ -38,5 +39,29 @@ bool ReentrantMutex::Lock(int wait_us /* = 0*/ )
 	{
 		return false;
 	}
+
+	return true;
+}
+
+bool ReentrantMutex::ProfiledLock(int wait_us, void * CallSite)
+{
+	// Contention is seen by a failed try_lock, waits are only timed when they happen
+	if ( InternalMutex.try_lock() == true )
+	{
+		ProfileAcquired();
+		return true;
+	}
+
+	const std::chrono::steady_clock::time_point WaitStart = std::chrono::steady_clock::now();
+	if ( WaitForLock( wait_us ) == false )
+	{
+		return false;
+	}
+	ProfileAcquiredAfterWait( WaitStart, CallSite );
 	return true;
 }
+
+bool ReentrantMutex::EnableProfiling( const char * Name )
+{
+	return CreateProfileHook( Name );
+}
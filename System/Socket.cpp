@@ -18,6 +18,8 @@
 
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <netdb.h>
 
 #include <errno.h>
@@ -505,6 +507,107 @@ int Socket::Send(size_t len, const char* buf)
 	return res;
 }
 
+int Socket::Send(size_t len1, const char* buf1, size_t len2, const char* buf2)
+{
+	if ( len1 == 0 || buf1 == (const char*)NULL )
+	{
+		return Send( len2, buf2 );
+	}
+	if ( len2 == 0 || buf2 == (const char*)NULL )
+	{
+		return Send( len1, buf1 );
+	}
+
+#ifdef OMISCID_ON_WINDOWS
+	WSABUF Parts[2];
+	DWORD SentLen = 0;
+
+	Parts[0].len = (ULONG)len1;
+	Parts[0].buf = (CHAR*)buf1;
+	Parts[1].len = (ULONG)len2;
+	Parts[1].buf = (CHAR*)buf2;
+
+	if ( socketType == TCP )
+	{
+		// Blocking WSASend returns when all data are sent
+		if ( WSASend(descriptor, Parts, 2, &SentLen, 0, NULL, NULL) == SOCKET_ERROR )
+		{
+			throw SocketException("send_sock_stream", Errno());
+		}
+	}
+	else
+	{
+		if ( WSASendTo(descriptor, Parts, 2, &SentLen, 0, (struct sockaddr*)&dest, sizeof(struct sockaddr), NULL, NULL) == SOCKET_ERROR )
+		{
+			throw SocketException("send_sock_dgram", Errno());
+		}
+	}
+	return (int)SentLen;
+#else
+	const int socket_send_flag = MSG_NOSIGNAL;
+	struct iovec Parts[2];
+	struct msghdr MsgHeader;
+
+	Parts[0].iov_base = (void*)buf1;
+	Parts[0].iov_len = len1;
+	Parts[1].iov_base = (void*)buf2;
+	Parts[1].iov_len = len2;
+
+	memset( &MsgHeader, 0, sizeof(MsgHeader) );
+	MsgHeader.msg_iov = Parts;
+	MsgHeader.msg_iovlen = 2;
+
+	if ( socketType != TCP )
+	{
+		MsgHeader.msg_name = (void*)&dest;
+		MsgHeader.msg_namelen = sizeof(struct sockaddr);
+
+		int res = (int)sendmsg(descriptor, &MsgHeader, socket_send_flag);
+		if ( res == SOCKET_ERROR )
+		{
+			throw SocketException("send_sock_dgram", Errno());
+		}
+		return res;
+	}
+
+	// Stream socket, sendmsg may send only a part of the data
+	size_t TotalLen = 0;
+	const size_t len = len1 + len2;
+	while( TotalLen < len )
+	{
+		int res = (int)sendmsg(descriptor, &MsgHeader, socket_send_flag);
+		if ( res == SOCKET_ERROR )
+		{
+			if ( Errno() == EINTR )
+			{
+				continue;
+			}
+			throw SocketException("send_sock_stream", Errno());
+		}
+		TotalLen += (size_t)res;
+
+		// Skip what was sent
+		size_t Sent = (size_t)res;
+		while( Sent > 0 && MsgHeader.msg_iovlen > 0 )
+		{
+			if ( Sent >= MsgHeader.msg_iov->iov_len )
+			{
+				Sent -= MsgHeader.msg_iov->iov_len;
+				MsgHeader.msg_iov++;
+				MsgHeader.msg_iovlen--;
+			}
+			else
+			{
+				MsgHeader.msg_iov->iov_base = (char*)MsgHeader.msg_iov->iov_base + Sent;
+				MsgHeader.msg_iov->iov_len -= Sent;
+				Sent = 0;
+			}
+		}
+	}
+	return (int)TotalLen;
+#endif
+}
+
 int Socket::SendTo(size_t len, const char* buf, struct sockaddr_in* adest)
 {
 	const int socket_send_flag = MSG_NOSIGNAL;
@@ -0,0 +1,121 @@
+/**
+ * @file System/AdaptiveMutex.h
+ * @ingroup System
+ * @brief Definition of AdaptiveMutex class
+ */
+
+#ifndef __ADAPTIVE_MUTEX_H__
+#define __ADAPTIVE_MUTEX_H__
+
+#include <System/ConfigSystem.h>
+#include <System/LockManagement.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#ifndef __linux__
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace Omiscid {
+
+/**
+ * @class AdaptiveMutex AdaptiveMutex.cpp System/AdaptiveMutex.h
+ * @brief Reentrant mutex for very short critical sections
+ *
+ * A thread finding the mutex locked first spins for a short time, with a pause
+ * instruction and an exponential backoff, and then parks itself: on a futex
+ * under Linux, on a condition variable elsewhere. Uncontended Lock and Unlock
+ * are a single atomic operation each. The mutex is reentrant, it can replace
+ * a ReentrantMutex (see MutexedSimpleList).
+ *
+ * Each mutex counts its acquisitions, the acquisitions that had to wait and
+ * the total waiting time, see AdaptiveMutex#GetStatistics.
+ */
+class AdaptiveMutex : public LockableObject
+{
+public:
+	/** @brief Default maximum number of spin rounds before parking */
+	static const unsigned int DefaultMaxSpins = 100;
+
+	/** @brief Statistics of a mutex */
+	struct Statistics
+	{
+		unsigned long long Acquisitions;			/*!< Number of times the mutex was taken (reentrant locks excluded) */
+		unsigned long long ContendedAcquisitions;	/*!< Number of acquisitions that found the mutex locked */
+		unsigned long long WaitTimeNs;				/*!< Total time spent waiting for the mutex, in nanoseconds */
+	};
+
+	/** @brief Constructor
+	 * @param MaxSpins [in] number of spin rounds before parking, spinning is disabled on single CPU hosts
+	 */
+	AdaptiveMutex( unsigned int MaxSpins = DefaultMaxSpins );
+
+	/** @brief Destructor */
+	virtual ~AdaptiveMutex();
+
+	/**
+	 * @brief Lock the mutex.
+	 *
+	 * Wait if the mutex is locked by another thread, until it is unlocked, and then locks the mutex.
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the mutex was not acquired within wait_us
+	 */
+	bool Lock(int wait_us = 0);
+
+	/**
+	 * @brief Unlock the mutex
+	 *
+	 * Wake up one parked thread, if any.
+	 */
+	bool Unlock();
+
+	/** @brief Get the statistics of this mutex, values are read without locking the mutex */
+	Statistics GetStatistics() const;
+
+	/** @brief Reset the statistics of this mutex */
+	void ResetStatistics();
+
+	/** @brief Record the contention of this mutex in the LockProfiler, see LockableObject#EnableProfiling */
+	virtual bool EnableProfiling( const char * Name );
+
+private:
+	// Copying a mutex makes no sense
+	AdaptiveMutex( const AdaptiveMutex& );
+	AdaptiveMutex& operator=( const AdaptiveMutex& );
+
+	/** @brief Spin and park until the mutex is taken or until wait_us (0 for ever) is elapsed */
+	bool LockContended( int wait_us, void * CallSite );
+
+	/** @brief Update the statistics after a wait, the mutex is taken */
+	void ContendedAcquisition( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite );
+
+	/** @brief Wake up one parked thread */
+	void WakeOne();
+
+	/** @brief Increment a statistic counter, only called by the owner of the mutex */
+	static void AddToCounter( std::atomic<unsigned long long>& Counter, unsigned long long Value )
+	{
+		Counter.store( Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed );
+	}
+
+	std::atomic<int> State;						/*!< 0: unlocked, 1: locked, 2: locked and threads may be parked */
+	std::atomic<std::thread::id> Owner;			/*!< Owner of the mutex, default id when unlocked */
+	unsigned int RecursionCount;				/*!< Number of reentrant locks, only used by the owner */
+	unsigned int SpinRounds;					/*!< Number of spin rounds before parking */
+
+	std::atomic<unsigned long long> Acquisitions;
+	std::atomic<unsigned long long> ContendedAcquisitions;
+	std::atomic<unsigned long long> WaitTimeNs;
+
+#ifndef __linux__
+	std::mutex ParkingMutex;					/*!< Protect parking on ParkingCondition */
+	std::condition_variable ParkingCondition;	/*!< Parked threads wait on it */
+#endif
+};
+
+} // namespace Omiscid
+
+#endif // __ADAPTIVE_MUTEX_H__
@@ -0,0 +1,68 @@
+/**
+ * @file System/System/AllocationCounter.h
+ * @ingroup System
+ * @brief Count memory allocations, to measure the cost of an operation
+ */
+
+#ifndef __ALLOCATION_COUNTER_H__
+#define __ALLOCATION_COUNTER_H__
+
+#include <System/ConfigSystem.h>
+
+#include <stdint.h>
+
+#if defined OMISCID_COUNT_ALLOCATIONS && defined TRACKING_MEMORY_LEAKS
+	#error "OMISCID_COUNT_ALLOCATIONS and TRACKING_MEMORY_LEAKS can not be used simultaneously"
+#endif
+
+namespace Omiscid {
+
+/**
+ * @class AllocationCounter AllocationCounter.cpp System/AllocationCounter.h
+ * @brief Global counters of the calls to operator new/delete.
+ *
+ * The counting operators are only compiled when OMISCID_COUNT_ALLOCATIONS
+ * is defined (for the whole Omiscid build), they forward to malloc/free.
+ * All the replaceable forms are counted: nothrow, sized delete (C++14) and
+ * aligned new/delete (C++17) when the compiler provides them.
+ * Otherwise IsEnabled returns false and all counters stay at 0.
+ * Counters are shared by all threads.
+ *
+ * @code
+ * AllocationCounter::Counts Before = AllocationCounter::GetCounts();
+ * Object.Serialize();
+ * AllocationCounter::Counts Cost = AllocationCounter::GetCounts() - Before;
+ * @endcode
+ */
+class AllocationCounter
+{
+public:
+	/** @brief Snapshot of the counters */
+	struct Counts
+	{
+		Counts() : Allocations(0), Frees(0), AllocatedBytes(0) {}
+
+		uint64_t Allocations;		/*!< number of calls to operator new/new[] */
+		uint64_t Frees;				/*!< number of calls to operator delete/delete[] with a non NULL pointer */
+		uint64_t AllocatedBytes;	/*!< total size requested to operator new/new[] */
+
+		Counts operator-( const Counts& Start ) const
+		{
+			Counts Result;
+			Result.Allocations = Allocations - Start.Allocations;
+			Result.Frees = Frees - Start.Frees;
+			Result.AllocatedBytes = AllocatedBytes - Start.AllocatedBytes;
+			return Result;
+		}
+	};
+
+	/** @brief Are allocations counted (OMISCID_COUNT_ALLOCATIONS defined at build time) */
+	static bool IsEnabled();
+
+	/** @brief Get the current values of the counters */
+	static Counts GetCounts();
+};
+
+} // namespace Omiscid
+
+#endif // __ALLOCATION_COUNTER_H__
@@ -9,8 +9,12 @@
 
 #include <System/ConfigSystem.h>
 
+#include <chrono>
+
 namespace Omiscid {
 
+class LockProfileHook;
+
 /**
  * @class LockableObject LockManagement.h System/LockManagement.h
  * @brief LockableObject are object that can be lock (Mutex, ReentrantMutex, MutexedSimpleList, ...).
@@ -23,12 +27,22 @@ public:
 	/** @brief Constructor
 	 *
 	 */
-	LockableObject() {};
+	LockableObject() : pProfileHook(NULL), Profiled(false) {};
 
-	/** @brief Constructor
+	/** @brief Copy constructor, the profiling state is not copied
+	 *
+	 */
+	LockableObject( const LockableObject& ) : pProfileHook(NULL), Profiled(false) {};
+
+	/** @brief Destructor
 	 *
 	 */
-	virtual ~LockableObject() {};
+	virtual ~LockableObject();
+
+	/** @brief Assignment, the profiling state is not copied
+	 *
+	 */
+	LockableObject& operator=( const LockableObject& ) { return *this; }
 
 	/** @brief Virtual function used to lock the object
 	 *
@@ -39,6 +53,36 @@ public:
 	 *
 	 */
 	virtual bool Unlock() = 0;
+
+	/** @brief Record the contention of this object in the LockProfiler under Name.
+	 * Must be called before the object is shared between threads.
+	 * @return false if this kind of object can not be profiled (default)
+	 */
+	virtual bool EnableProfiling( const char * Name );
+
+protected:
+	friend class SmartLocker;
+
+	/** @brief Is this object profiled, inline so that other locks only pay a test */
+	bool IsProfiled() const
+	{
+		return Profiled;
+	}
+
+	/** @brief Create the profiling state of a lock implementation supporting profiling */
+	bool CreateProfileHook( const char * Name );
+
+	/** @brief Tell the profiler the lock was taken without waiting */
+	void ProfileAcquired();
+
+	/** @brief Tell the profiler the lock was taken after waiting since WaitStart */
+	void ProfileAcquiredAfterWait( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite );
+
+	/** @brief Tell the profiler the lock is about to be released */
+	void ProfileReleased();
+
+	LockProfileHook * pProfileHook;	/*!< NULL when the lock is not profiled */
+	bool Profiled;					/*!< This object or the lock it uses is profiled, SmartLocker gives its call site */
 };
 
 /**
@@ -82,10 +126,108 @@ public:
 
 private:
 	unsigned int LockCount;	/*<! Number of lock done on the LockableObject */
+	void * CallSite;		/*<! Caller of the constructor, for the LockProfiler */
 
 	LockableObject& ManagedLoackableObject;
 };
 
+/**
+ * @class NullLock LockManagement.h System/LockManagement.h
+ * @brief Lock policy doing nothing, for objects only used by one thread.
+ *
+ * Locking compiles to nothing only when the type of the lock is known at the
+ * call: through SmartPolicyLocker<NullLock>, or as the member lock of a policy
+ * template (MutexedSimpleList...). Through SmartLocker or a LockableObject
+ * reference, it is still a virtual call.
+ */
+class NullLock final : public LockableObject
+{
+public:
+	/** @brief Does nothing */
+	bool Lock(int /*wait_us*/ = 0) { return true; }
+
+	/** @brief Does nothing */
+	bool Unlock() { return true; }
+};
+
+/**
+ * @class SmartPolicyLocker LockManagement.h System/LockManagement.h
+ * @brief SmartLocker for a lock whose type is known at compile time.
+ *
+ * LOCK_TYPE::Lock and LOCK_TYPE::Unlock are called directly, without virtual
+ * call, so they are inlined when they can be (NullLock, SpinLock). The lock is
+ * taken at most once and released when the locker is destroyed. This class is
+ * designed to operate in functions. It is not thread safe.
+ */
+template <typename LOCK_TYPE>
+class SmartPolicyLocker
+{
+public:
+	/** @brief Constructor
+	 * @param LockToManage a reference to the lock to manage
+	 * @param LockAtInit do we lock at init
+	 */
+	explicit SmartPolicyLocker( LOCK_TYPE& LockToManage, bool LockAtInit = true )
+		: ManagedLock(LockToManage), IsLocked(false)
+	{
+		if ( LockAtInit == true )
+		{
+			Lock();
+		}
+	}
+
+	/** @brief Constructor
+	 * @param LockToManage a reference to the lock to manage
+	 * @param LockAtInit do we lock at init
+	 */
+	explicit SmartPolicyLocker( const LOCK_TYPE& LockToManage, bool LockAtInit = true )
+		: ManagedLock((LOCK_TYPE&)LockToManage), IsLocked(false)
+	{
+		if ( LockAtInit == true )
+		{
+			Lock();
+		}
+	}
+
+	/** @brief Destructor, release the lock if it is held */
+	~SmartPolicyLocker()
+	{
+		if ( IsLocked == true )
+		{
+			ManagedLock.LOCK_TYPE::Unlock();
+		}
+	}
+
+	/** @brief Take the lock, return true at once if this locker already holds it */
+	bool Lock(int wait_us = 0)
+	{
+		if ( IsLocked == false )
+		{
+			IsLocked = ManagedLock.LOCK_TYPE::Lock(wait_us);
+		}
+		return IsLocked;
+	}
+
+	/** @brief Release the lock */
+	bool Unlock()
+	{
+		if ( IsLocked == false )
+		{
+			return false;
+		}
+		IsLocked = false;
+		return ManagedLock.LOCK_TYPE::Unlock();
+	}
+
+private:
+	// Not copyable
+	SmartPolicyLocker( const SmartPolicyLocker& );
+	SmartPolicyLocker& operator=( const SmartPolicyLocker& );
+
+	LOCK_TYPE& ManagedLock;
+	bool IsLocked;
+};
+
 } // namespace Omiscid
 
 #endif // __LOCK_MANAGEMENT_H__
@@ -0,0 +1,139 @@
+/**
+ * @file System/LockProfiler.h
+ * @ingroup System
+ * @brief Definition of LockProfiler and LockProfileHook classes
+ */
+
+#ifndef __LOCK_PROFILER_H__
+#define __LOCK_PROFILER_H__
+
+#include <System/ConfigSystem.h>
+#include <System/SimpleString.h>
+
+#include <chrono>
+#include <vector>
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+/** @brief Address the current function will return to, used to identify call sites */
+#if defined _MSC_VER
+#define OMISCID_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define OMISCID_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace Omiscid {
+
+/**
+ * @class LockProfiler LockProfiler.cpp System/LockProfiler.h
+ * @brief Contention statistics of named locks
+ *
+ * Profiling is enabled per lock with LockableObject#EnableProfiling (supported by
+ * Mutex, ReentrantMutex, AdaptiveMutex and the mutexed lists). Several locks can
+ * share a name, their statistics are merged. For each name, the profiler records:
+ * - the number of acquisitions and of contended acquisitions (the lock was taken),
+ * - the wait time of every contended acquisition, total and log2 histogram,
+ * - the hold time of one acquisition out of GetSamplingPeriod(), total and log2 histogram,
+ * - the call sites of contended acquisitions, with their wait time (the caller
+ *   of SmartLocker, or of Lock when the lock is taken directly).
+ *
+ * Counters are kept in per-thread buffers, a lock only touches shared memory
+ * when it is contended. GetReports/GetTextReport merge the buffers on demand,
+ * see also LockProfileReport in Messaging for a JSON report.
+ */
+class LockProfiler
+{
+public:
+	/** @brief Number of buckets of histograms, bucket i counts durations in [2^i, 2^(i+1)[ ns */
+	static const unsigned int NbHistogramBuckets = 32;
+
+	/** @brief Maximum number of lock names */
+	static const unsigned int MaxProfiles = 128;
+
+	/** @brief Maximum number of call sites recorded per lock name */
+	static const unsigned int MaxCallSites = 32;
+
+	/** @brief Default sampling period of hold times */
+	static const unsigned int DefaultSamplingPeriod = 16;
+
+	/** @brief Waits of a call site */
+	struct CallSiteReport
+	{
+		void * Address;					/*!< Return address of the call */
+		SimpleString Symbol;			/*!< Symbol of the address if it can be found, empty otherwise */
+		unsigned long long Waits;		/*!< Number of contended acquisitions */
+		unsigned long long WaitTimeNs;	/*!< Total wait time in nanoseconds */
+	};
+
+	/** @brief Statistics of a lock name */
+	struct LockReport
+	{
+		SimpleString Name;
+		unsigned long long Acquisitions;
+		unsigned long long ContendedAcquisitions;
+		unsigned long long WaitTimeNs;
+		unsigned long long SampledHolds;	/*!< Number of acquisitions whose hold time was measured */
+		unsigned long long HoldTimeNs;		/*!< Total of the measured hold times */
+		unsigned long long WaitHistogram[NbHistogramBuckets];
+		unsigned long long HoldHistogram[NbHistogramBuckets];
+		std::vector<CallSiteReport> CallSites;	/*!< Sorted by decreasing wait time */
+	};
+
+	/** @brief Measure the hold time of one acquisition out of Period (per thread), 1 measures all */
+	static void SetSamplingPeriod( unsigned int Period );
+
+	/** @brief Get the sampling period of hold times */
+	static unsigned int GetSamplingPeriod();
+
+	/** @brief Get the statistics of all lock names, sorted by decreasing wait time */
+	static void GetReports( std::vector<LockReport>& Reports );
+
+	/** @brief Get a human readable report */
+	static SimpleString GetTextReport();
+
+	/** @brief Restart all statistics from zero */
+	static void Reset();
+
+	/** @brief Get the identifier of a lock name, creating it if needed
+	 * @return the identifier, or -1 if there are already MaxProfiles names
+	 */
+	static int GetProfileId( const char * Name );
+
+	/** @brief Call site announced by SmartLocker to the lock it is about to take (per thread) */
+	static thread_local void * PendingCallSite;
+};
+
+/**
+ * @class LockProfileHook LockProfiler.cpp System/LockProfiler.h
+ * @brief Profiling state of one lock, used by the lock implementations.
+ *
+ * All methods are called by the thread owning the lock.
+ */
+class LockProfileHook
+{
+public:
+	LockProfileHook( unsigned int ProfileId );
+
+	/** @brief The lock was taken without waiting */
+	void Acquired();
+
+	/** @brief The lock was taken after waiting since WaitStart */
+	void AcquiredAfterWait( const std::chrono::steady_clock::time_point& WaitStart, void * CallSite );
+
+	/** @brief The lock is about to be released */
+	void Released();
+
+private:
+	void StartHold( bool Sampled );
+
+	unsigned int Id;
+	unsigned int Depth;			/*!< Reentrant acquisitions */
+	bool HoldSampled;
+	std::chrono::steady_clock::time_point HoldStart;
+};
+
+} // namespace Omiscid
+
+#endif // __LOCK_PROFILER_H__
@@ -52,6 +52,8 @@ public:
 
   /** @brief Copy constructor
    *
+   * The data are always copied in a buffer owned by the new message,
+   * even if ToCopy points to data owned by someone else (i.e. a MsgSocket).
    * @param ToCopy [in] the message to copy
    * container.
    */
@@ -69,6 +71,7 @@ public:
   MessageOrigine GetOrigine() const; /*!< The origine  of the Message (udp, tcp, shared memory, maybe other (??) in future work) */
   unsigned int GetPeerId() const; /*!< The PeerId who send this message */
   unsigned int GetMsgId() const; /*!< The unique message id comming from a Peer */
+  unsigned int GetFlags() const; /*!< The encoding flags of the message (see MsgSocket) */
   //@}
 
   /** @brief ToString
@@ -85,6 +88,7 @@ protected:
   MessageOrigine origine;
   unsigned int pid; /*!< peer id */
   unsigned int mid; /*!< message id */
+  unsigned int flags; /*!< encoding flags */
   //@}
 };
 
@@ -0,0 +1,224 @@
+/**
+ * @file System/MpscQueue.h
+ * @ingroup System
+ * @brief Definition of MpscQueue class
+ */
+
+#ifndef __MPSC_QUEUE_H__
+#define __MPSC_QUEUE_H__
+
+#include <System/ConfigSystem.h>
+
+#include <atomic>
+#include <utility>
+
+namespace Omiscid {
+
+/**
+ * @class MpscQueue MpscQueue.h System/MpscQueue.h
+ * @brief Lock free FIFO queue with many producers and a single consumer
+ *
+ * Implementation of the intrusive queue of Dmitry Vyukov: Push is one atomic
+ * exchange and one store, it never waits for other producers nor for the consumer.
+ * Pop and IsEmpty must only be called by one thread at a time (the consumer).
+ *
+ * The cells are recycled instead of being deleted: the consumer gives them back to
+ * a static list shared by all the queues of the same TYPE, a producer takes the whole
+ * list at once into a cache of its own thread. This way, no cell can be taken twice
+ * (no ABA problem) and a producer only touches the shared list when its cache is empty.
+ * The available cells can be deleted by calling the static method DeleteTheAvailableCells.
+ *
+ * A push is visible to the consumer once Push returns. While a producer is between
+ * its two steps, the messages pushed after its own by other producers are not visible yet.
+ */
+template <typename TYPE>
+class MpscQueue
+{
+public:
+	/** @brief Constructor */
+	MpscQueue();
+
+	/** @brief Destructor, no thread must use the queue anymore */
+	virtual ~MpscQueue();
+
+	/** @brief Add an element at the tail of the queue, can be called by any thread
+	 * @param Element [in] the element to add
+	 */
+	void Push( const TYPE& Element );
+
+	/** @brief Extract the element at the head of the queue (consumer only)
+	 * @param Element [out] the extracted element
+	 * @return false if the queue is empty
+	 */
+	bool Pop( TYPE& Element );
+
+	/** @brief Test if the queue is empty (consumer only) */
+	bool IsEmpty() const
+	{
+		return Tail->Next.load(std::memory_order_acquire) == NULL;
+	}
+
+	/** @brief Test if the queue is not empty (consumer only) */
+	bool IsNotEmpty() const
+	{
+		return IsEmpty() == false;
+	}
+
+	/** @brief Delete the cells available in the static list of TYPE.
+	 *
+	 * The cells cached by running threads are not deleted.
+	 */
+	static void DeleteTheAvailableCells();
+
+private:
+	// Copying a queue shared by several threads makes no sense
+	MpscQueue( const MpscQueue& );
+	MpscQueue& operator=( const MpscQueue& );
+
+	/** @brief Cell of the queue */
+	struct Cell
+	{
+		std::atomic<Cell*> Next;
+		TYPE Element;
+	};
+
+	/** @brief Cells taken by a thread from the static list */
+	struct CellCache
+	{
+		CellCache() : First(NULL) {}
+
+		/** @brief Give the cells back when the thread exits */
+		~CellCache()
+		{
+			if ( First != NULL )
+			{
+				Cell * Last = First;
+				while( Last->Next.load(std::memory_order_relaxed) != NULL )
+				{
+					Last = Last->Next.load(std::memory_order_relaxed);
+				}
+				AddAvailableCells( First, Last );
+
+				// A later thread_local destructor of this thread may still push
+				First = NULL;
+			}
+		}
+
+		Cell * First;
+	};
+
+	/** @brief Obtain a cell from the cache of the calling thread, or a new one */
+	static Cell * GetNewCell();
+
+	/** @brief Add the chain of cells from First to Last to the static list */
+	static void AddAvailableCells( Cell * First, Cell * Last );
+
+	std::atomic<Cell*> Head;	/*!< Last pushed cell, modified by the producers */
+	Cell * Tail;				/*!< Cell before the first element (already consumed), modified by the consumer */
+
+	/** @brief Begining of the static list of available cells */
+	static std::atomic<Cell*> AvailableCells;
+	/** @brief Cells reserved by the calling thread */
+	static thread_local CellCache ThreadCells;
+};
+
+template <typename TYPE>
+std::atomic<typename MpscQueue<TYPE>::Cell*> MpscQueue<TYPE>::AvailableCells( NULL );
+
+template <typename TYPE>
+thread_local typename MpscQueue<TYPE>::CellCache MpscQueue<TYPE>::ThreadCells;
+
+template <typename TYPE>
+MpscQueue<TYPE>::MpscQueue()
+{
+	// The queue always contains a consumed cell
+	Tail = GetNewCell();
+	Tail->Next.store( NULL, std::memory_order_relaxed );
+	Head.store( Tail, std::memory_order_release );
+}
+
+template <typename TYPE>
+MpscQueue<TYPE>::~MpscQueue()
+{
+	TYPE Element;
+	while( Pop(Element) == true )
+	{
+	}
+	AddAvailableCells( Tail, Tail );
+}
+
+template <typename TYPE>
+void MpscQueue<TYPE>::Push( const TYPE& Element )
+{
+	Cell * NewCell = GetNewCell();
+	NewCell->Element = Element;
+	NewCell->Next.store( NULL, std::memory_order_relaxed );
+
+	// Take the place of the last cell, then link the previous one to us
+	Cell * Previous = Head.exchange( NewCell, std::memory_order_acq_rel );
+	Previous->Next.store( NewCell, std::memory_order_release );
+}
+
+template <typename TYPE>
+bool MpscQueue<TYPE>::Pop( TYPE& Element )
+{
+	Cell * Consumed = Tail;
+	Cell * First = Consumed->Next.load(std::memory_order_acquire);
+	if ( First == NULL )
+	{
+		return false;
+	}
+
+	// First becomes the consumed cell
+	Element = std::move( First->Element );
+	Tail = First;
+
+	AddAvailableCells( Consumed, Consumed );
+	return true;
+}
+
+template <typename TYPE>
+typename MpscQueue<TYPE>::Cell * MpscQueue<TYPE>::GetNewCell()
+{
+	CellCache& Cache = ThreadCells;
+	if ( Cache.First == NULL )
+	{
+		// Take all the available cells
+		Cache.First = AvailableCells.exchange( NULL, std::memory_order_acquire );
+		if ( Cache.First == NULL )
+		{
+			return new OMISCID_TLM Cell;
+		}
+	}
+
+	Cell * NewCell = Cache.First;
+	Cache.First = NewCell->Next.load(std::memory_order_relaxed);
+	return NewCell;
+}
+
+template <typename TYPE>
+void MpscQueue<TYPE>::AddAvailableCells( Cell * First, Cell * Last )
+{
+	Cell * Available = AvailableCells.load(std::memory_order_relaxed);
+	do
+	{
+		Last->Next.store( Available, std::memory_order_relaxed );
+	}
+	while( AvailableCells.compare_exchange_weak(Available, First, std::memory_order_release, std::memory_order_relaxed) == false );
+}
+
+template <typename TYPE>
+void MpscQueue<TYPE>::DeleteTheAvailableCells()
+{
+	Cell * ToDelete = AvailableCells.exchange( NULL, std::memory_order_acquire );
+	while( ToDelete != NULL )
+	{
+		Cell * NextCell = ToDelete->Next.load(std::memory_order_relaxed);
+		delete ToDelete;
+		ToDelete = NextCell;
+	}
+}
+
+} // namespace Omiscid
+
+#endif // __MPSC_QUEUE_H__
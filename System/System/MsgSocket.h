@@ -0,0 +1,119 @@
+/**
+ * @file System/MsgSocket.h
+ * @ingroup System
+ * @brief Definition of MsgSocket class
+ */
+
+#ifndef __MSG_SOCKET_H__
+#define __MSG_SOCKET_H__
+
+#include <System/ConfigSystem.h>
+#include <System/Message.h>
+#include <System/Mutex.h>
+#include <System/SimpleString.h>
+#include <System/Socket.h>
+
+#include <vector>
+
+namespace Omiscid {
+
+/**
+ * @class MsgSocket MsgSocket.cpp System/MsgSocket.h
+ * @ingroup System
+ * @brief Length-prefixed message framing over a connected TCP Socket.
+ *
+ * Each frame is a fixed 16 bytes header followed by the payload. The header
+ * contains 4 unsigned 32 bits integers in network byte order: payload length,
+ * peer id, message id and encoding flags (see Message::GetPeerId, Message::GetMsgId
+ * and Message::GetFlags).
+ *
+ * Reception is buffered: one call to recv may bring many frames that are
+ * then delivered without any other system call. Received messages are not
+ * copied, the Message points directly to the reception buffer and its data
+ * are null terminated (ready to be parsed). The data remain valid until the
+ * next call to Receive or GetBufferedMessage, copy the Message to keep them longer.
+ *
+ * Sending is thread safe and uses a gather write of header and payload.
+ * Receiving must be done by a single thread.
+ */
+class MsgSocket
+{
+public:
+	/** @brief Size of the frame header */
+	enum { HeaderSize = 16 };
+
+	/** @brief Default sizes */
+	enum { DefaultReceiveBufferSize = TCP_BUFFER_SIZE, DefaultMaxMessageSize = 64*1024*1024 };
+
+	/** @brief Encoding flags, other values can be used by applications */
+	enum EncodingFlags { RawEncoding = 0x0, JsonEncoding = 0x1 };
+
+	/** @brief Constructor
+	 * @param pConnectedSocket [in] a connected TCP socket (not owned, must live longer than the MsgSocket)
+	 * @param ReceiveBufferSize [in] initial size of the reception buffer, grows for larger messages
+	 * @param MaxMessageSize [in] maximal accepted payload length
+	 */
+	MsgSocket( Socket * pConnectedSocket, size_t ReceiveBufferSize = DefaultReceiveBufferSize, size_t MaxMessageSize = DefaultMaxMessageSize );
+
+	/** @brief Destructor */
+	virtual ~MsgSocket();
+
+	/** @brief Send a frame
+	 * @param Payload [in] the data to send
+	 * @param Length [in] the length of the data
+	 * @param PeerId [in] the peer id to put in the header
+	 * @param MsgId [in] the message id to put in the header
+	 * @param Flags [in] the encoding flags to put in the header
+	 * @exception SocketException if an error occurs during sending
+	 */
+	void Send( const char * Payload, size_t Length, unsigned int PeerId, unsigned int MsgId, unsigned int Flags = RawEncoding );
+
+	/** @brief Send a frame containing a text (i.e. a serialized StructuredMessage)
+	 */
+	void Send( const SimpleString& Payload, unsigned int PeerId, unsigned int MsgId, unsigned int Flags = JsonEncoding );
+
+	/** @brief Wait for a complete frame
+	 *
+	 * Calls recv only if no complete frame is already buffered.
+	 * @param Msg [out] the received message, pointing to the reception buffer
+	 * @return false if the connection was closed by the peer
+	 * @exception SocketException if an error occurs or if the frame is too large
+	 */
+	bool Receive( Message& Msg );
+
+	/** @brief Get a frame already buffered without any system call
+	 * @param Msg [out] the received message, pointing to the reception buffer
+	 * @return false if no complete frame is buffered
+	 * @exception SocketException if the frame is too large
+	 */
+	bool GetBufferedMessage( Message& Msg );
+
+	/** @brief Length of received data not delivered yet (headers included)
+	 */
+	size_t GetBufferedLength() const;
+
+	/** @brief Access to the underlying socket */
+	Socket * GetSocket() const;
+
+private:
+	// Put back the byte overwritten by the null terminating the last delivered message
+	void RestoreTerminatedByte();
+
+	// Move pending data at the begining of the buffer and make room for a complete frame
+	void PrepareReception();
+
+	Socket * pSocket;
+	Mutex SendLocker;
+
+	std::vector<char> ReceiveBuffer;	/*!< one more byte than capacity to null terminate the last frame */
+	size_t DataStart;
+	size_t DataEnd;
+	size_t MaxMessageLength;
+
+	char * TerminatedBytePosition;
+	char TerminatedByte;
+};
+
+} // namespace Omiscid
+
+#endif // __MSG_SOCKET_H__
@@ -12,6 +12,7 @@
 
 
 #include <mutex>
+#include <chrono>
 
 namespace Omiscid {
 
@@ -27,7 +28,7 @@ namespace Omiscid {
 class Mutex : public LockableObject// , public std::mutex
 {
 protected:
-	std::mutex InternalMutex;
+	std::timed_mutex InternalMutex;
 
 public:
 	/** @brief Constructor */
@@ -39,8 +40,10 @@ public:
 	/**
 	 * @brief Lock the mutex.
 	 *
-	 * Wait if the mutex is already locked, until it is unlocked, and then locks the mutex
-	 * @return false if an error occured
+	 * Wait if the mutex is already locked, until it is unlocked, and then locks the mutex.
+	 * Waiting threads are blocked by the system, they do not poll the mutex.
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the mutex was not acquired within wait_us or if an error occured
 	 */
 	bool Lock(int wait_us = 0);
 
@@ -57,7 +60,15 @@ public:
 	 *
 	 * Enables other clients to use the critical section protected by this mutex.
 	 */
-	inline bool Unlock() { InternalMutex.unlock(); return true; }
+	inline bool Unlock()
+	{
+		if ( pProfileHook != NULL )
+		{
+			ProfileReleased();
+		}
+		InternalMutex.unlock();
+		return true;
+	}
 
 	/**
 	 * @brief Unlock the mutex. Deprecated, use Mutex#Unlock instead.
@@ -66,7 +77,15 @@ public:
 	 */
 	inline bool LeaveMutex() { return Unlock(); };
 
+	/** @brief Record the contention of this mutex in the LockProfiler, see LockableObject#EnableProfiling */
+	virtual bool EnableProfiling( const char * Name );
+
 private:
+	/** @brief Lock, waiting at most wait_us (0 for ever) */
+	bool WaitForLock(int wait_us);
+
+	/** @brief Lock recording the contention in the LockProfiler */
+	bool ProfiledLock(int wait_us, void * CallSite);
 
 #ifdef DEBUG_MUTEX_OWNER
 	unsigned int OwnerId;
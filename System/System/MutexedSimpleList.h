@@ -23,9 +23,15 @@ class ReentrantMutex;
 *
 * The mutex is used to lock and unlock the access to the simple list.
 * When the user want to lock an access, he can call Lock and Unlock method.
+* LOCK_TYPE is the lock policy: ReentrantMutex (default) or AdaptiveMutex, Mutex or
+* SpinLock for very short critical sections, NullLock for a list used by one thread.
+* The member lock has a known type, its Lock and Unlock are called without virtual call.
+* The list itself is still a LockableObject: lock it through SmartPolicyLocker<MutexedSimpleList<...> >
+* to avoid the virtual call on the list too (with NullLock, locking then compiles to nothing).
+* Mutex and SpinLock are not reentrant, a thread must not lock the list twice.
 * @author Dominique Vaufreydaz, Grenoble Alpes University, Inria
 */
-template <typename TYPE>
+template <typename TYPE, typename LOCK_TYPE = ReentrantMutex>
 class MutexedSimpleList : public SimpleList<TYPE>, public LockableObject
 {
 public:
@@ -190,7 +196,7 @@ public:
 	*
 	* Build a copy of the list.
 	*/
-	MutexedSimpleList<TYPE>& operator=(MutexedSimpleList<TYPE>& ToCopy)
+	MutexedSimpleList<TYPE, LOCK_TYPE>& operator=(MutexedSimpleList<TYPE, LOCK_TYPE>& ToCopy)
 	{
 		SmartLocker SL_ToCopy(ToCopy);
 		SmartLocker SL_Myself(*this);
@@ -211,7 +217,7 @@ public:
 	*
 	* Build a copy of the list.
 	*/
-	MutexedSimpleList<TYPE>& operator=(SimpleList<TYPE>& ToCopy)
+	MutexedSimpleList<TYPE, LOCK_TYPE>& operator=(SimpleList<TYPE>& ToCopy)
 	{
 		SmartLocker SL_Myself(*this);
 
@@ -241,12 +247,19 @@ public:
 	*/
 	bool Unlock();
 
+	/** @brief Record the contention of the list mutex in the LockProfiler, see LockableObject#EnableProfiling */
+	virtual bool EnableProfiling( const char * Name )
+	{
+		Profiled = mutex.EnableProfiling( Name );
+		return Profiled;
+	}
+
 private:
-	ReentrantMutex mutex; /*!< the mutex to protect access to the list*/
+	LOCK_TYPE mutex; /*!< the mutex to protect access to the list*/
 };
 
-template <typename TYPE>
-bool MutexedSimpleList<TYPE>::Lock(int wait_us /* = 0 */)
+template <typename TYPE, typename LOCK_TYPE>
+bool MutexedSimpleList<TYPE, LOCK_TYPE>::Lock(int wait_us /* = 0 */)
 {
 #ifdef DEBUG_MSL
 	// Only for MutexedSimpleList debugging
@@ -262,8 +275,8 @@ bool MutexedSimpleList<TYPE>::Lock(int wait_us /* = 0 */)
 #endif
 }
 
-template <typename TYPE>
-bool MutexedSimpleList<TYPE>::Unlock()
+template <typename TYPE, typename LOCK_TYPE>
+bool MutexedSimpleList<TYPE, LOCK_TYPE>::Unlock()
 {
 #ifdef DEBUG_MSL
 	if ( NbLocks == 0 )
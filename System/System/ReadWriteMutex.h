@@ -0,0 +1,164 @@
+/**
+ * @file System/ReadWriteMutex.h
+ * @ingroup System
+ * @brief Definition of ReadWriteMutex, SmartReadLocker and SmartWriteLocker classes
+ */
+
+#ifndef __READ_WRITE_MUTEX_H__
+#define __READ_WRITE_MUTEX_H__
+
+#include <System/ConfigSystem.h>
+#include <System/LockManagement.h>
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace Omiscid {
+
+/**
+ * @class ReadWriteMutex ReadWriteMutex.cpp System/ReadWriteMutex.h
+ * @brief Mutex with shared (read) and exclusive (write) modes
+ *
+ * Any number of threads can hold the read lock at the same time, the write lock
+ * is exclusive. Taking or releasing an uncontended lock is a single atomic operation
+ * on the state of the mutex, waiting threads are blocked on a condition variable.
+ *
+ * With writer preference (the default), new readers wait as soon as a writer is
+ * waiting, so a continuous flow of readers can not starve writers.
+ * The mutex is not reentrant: with writer preference, a thread taking the read
+ * lock twice can deadlock if a writer arrives in between.
+ *
+ * Lock and Unlock (LockableObject interface) take and release the write lock,
+ * a ReadWriteMutex can be used with SmartLocker.
+ */
+class ReadWriteMutex : public LockableObject
+{
+public:
+	/** @brief Constructor
+	 * @param PreferWriters [in] block new readers while a writer is waiting
+	 */
+	ReadWriteMutex( bool PreferWriters = true );
+
+	/** @brief Destructor */
+	virtual ~ReadWriteMutex();
+
+	/**
+	 * @brief Take the read (shared) lock
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the lock was not acquired within wait_us
+	 */
+	bool ReadLock(int wait_us = 0);
+
+	/** @brief Release the read lock */
+	bool ReadUnlock();
+
+	/**
+	 * @brief Take the write (exclusive) lock
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the lock was not acquired within wait_us
+	 */
+	bool WriteLock(int wait_us = 0);
+
+	/** @brief Release the write lock */
+	bool WriteUnlock();
+
+	/** @brief Take the write lock, see ReadWriteMutex#WriteLock */
+	bool Lock(int wait_us = 0) { return WriteLock(wait_us); }
+
+	/** @brief Release the write lock, see ReadWriteMutex#WriteUnlock */
+	bool Unlock() { return WriteUnlock(); }
+
+private:
+	// Copying a mutex makes no sense
+	ReadWriteMutex( const ReadWriteMutex& );
+	ReadWriteMutex& operator=( const ReadWriteMutex& );
+
+	// Layout of State
+	static const unsigned int WriterLocked   = 0x80000000u;
+	static const unsigned int WritersWaiting = 0x40000000u;
+	static const unsigned int ReadersWaiting = 0x20000000u;
+	static const unsigned int ReadersMask    = 0x1fffffffu;
+
+	/** @brief One attempt to take the read lock without waiting */
+	bool TryReadLock();
+
+	/** @brief One attempt to take the write lock without waiting */
+	bool TryWriteLock();
+
+	bool ReadLockContended( int wait_us );
+	bool WriteLockContended( int wait_us );
+
+	/** @brief Wake up waiting threads after a release */
+	void WakeWaiters( unsigned int PreviousState );
+
+	std::atomic<unsigned int> State;		/*!< Number of readers and flags */
+	unsigned int ReaderBlockingMask;		/*!< Flags preventing a new reader to enter */
+
+	std::mutex WaitMutex;					/*!< Protects the waiting counters */
+	std::condition_variable WaitCondition;	/*!< Waiting readers and writers are blocked on it */
+	unsigned int NbWaitingReaders;
+	unsigned int NbWaitingWriters;
+};
+
+/**
+ * @class SmartReadLocker ReadWriteMutex.cpp System/ReadWriteMutex.h
+ * @brief Take the read lock of a ReadWriteMutex and release it when destroyed,
+ * like SmartLocker. This class is designed to operate in functions. It is not thread safe.
+ */
+class SmartReadLocker
+{
+public:
+	/** @brief Constructor
+	 * @param MutexToManage a reference to the mutex to manage
+	 * @param LockAtInit do we lock at init
+	 */
+	SmartReadLocker( ReadWriteMutex& MutexToManage, bool LockAtInit = true );
+
+	/** @brief Destructor, release the read locks still held */
+	virtual ~SmartReadLocker();
+
+	/** @brief Take the read lock */
+	bool Lock(int wait_us = 0);
+
+	/** @brief Release the read lock */
+	bool Unlock();
+
+private:
+	unsigned int LockCount;	/*!< Number of read locks held */
+
+	ReadWriteMutex& ManagedMutex;
+};
+
+/**
+ * @class SmartWriteLocker ReadWriteMutex.cpp System/ReadWriteMutex.h
+ * @brief Take the write lock of a ReadWriteMutex and release it when destroyed,
+ * like SmartLocker. This class is designed to operate in functions. It is not thread safe.
+ */
+class SmartWriteLocker
+{
+public:
+	/** @brief Constructor
+	 * @param MutexToManage a reference to the mutex to manage
+	 * @param LockAtInit do we lock at init
+	 */
+	SmartWriteLocker( ReadWriteMutex& MutexToManage, bool LockAtInit = true );
+
+	/** @brief Destructor, release the write lock if still held */
+	virtual ~SmartWriteLocker();
+
+	/** @brief Take the write lock */
+	bool Lock(int wait_us = 0);
+
+	/** @brief Release the write lock */
+	bool Unlock();
+
+private:
+	unsigned int LockCount;	/*!< Number of write locks held */
+
+	ReadWriteMutex& ManagedMutex;
+};
+
+} // namespace Omiscid
+
+#endif // __READ_WRITE_MUTEX_H__
@@ -10,6 +10,8 @@
 #include <System/ConfigSystem.h>
 #include <System/SimpleList.h>
 #include <System/LockManagement.h>
+#include <System/ReentrantMutex.h>
+#include <System/AdaptiveMutex.h>
 
 namespace Omiscid {
 
@@ -94,15 +96,15 @@ class SimpleRecycleList : public SimpleList<TYPE>
 
 	/** @brief Begining of the list of available cells */
 	static SimpleListElement<TYPE>* availableCells;
-	/** @brief Protect the access to the list of available cells */
-	static ReentrantMutex mutexAvailable;
+	/** @brief Protect the access to the list of available cells (a few instructions) */
+	static AdaptiveMutex mutexAvailable;
 };
 
 template <typename TYPE>
 SimpleListElement<TYPE>* SimpleRecycleList<TYPE>::availableCells = NULL;
 
 template <typename TYPE>
-ReentrantMutex SimpleRecycleList<TYPE>::mutexAvailable;
+AdaptiveMutex SimpleRecycleList<TYPE>::mutexAvailable;
 
 template <typename TYPE>
 SimpleRecycleList<TYPE>::SimpleRecycleList(){}
@@ -129,8 +131,9 @@ SimpleListElement<TYPE>* SimpleRecycleList<TYPE>::GetNewSimpleListElement() cons
  *
  * The mutex is used to lock and unlock the access to the simple list.
  * When the user want to lock an access, he can call Lock and Unlock method.
+ * LOCK_TYPE is the lock policy, see MutexedSimpleList.
  */
-template <typename TYPE>
+template <typename TYPE, typename LOCK_TYPE = ReentrantMutex>
 class MutexedSimpleRecycleList : public SimpleRecycleList<TYPE>, public LockableObject
 {
 public:
@@ -142,7 +145,7 @@ public:
 	 * Wait until the mutex can be locked.
 	 * @return if the 'lock' on the mutex is successful
 		 */
-	bool Lock();
+	bool Lock(int wait_us = 0);
 
 	/** @brief Unlock the access to the list
 	 *
@@ -151,23 +154,30 @@ public:
 	 */
 	bool Unlock();
 
+	/** @brief Record the contention of the list mutex in the LockProfiler, see LockableObject#EnableProfiling */
+	virtual bool EnableProfiling( const char * Name )
+	{
+		Profiled = mutex.EnableProfiling( Name );
+		return Profiled;
+	}
+
 private:
-	ReentrantMutex mutex; /*!< the mutex to protect access to the list*/
+	LOCK_TYPE mutex; /*!< the mutex to protect access to the list*/
 };
 
-template <typename TYPE>
-MutexedSimpleRecycleList<TYPE>::~MutexedSimpleRecycleList()
+template <typename TYPE, typename LOCK_TYPE>
+MutexedSimpleRecycleList<TYPE, LOCK_TYPE>::~MutexedSimpleRecycleList()
 {
 }
 
-template <typename TYPE>
-bool MutexedSimpleRecycleList<TYPE>::Lock()
+template <typename TYPE, typename LOCK_TYPE>
+bool MutexedSimpleRecycleList<TYPE, LOCK_TYPE>::Lock(int wait_us /* = 0 */)
 {
-	return mutex.Lock();	// Add SL_ as comment in order to prevent false alarm in code checker on locks
+	return mutex.Lock(wait_us);	// Add SL_ as comment in order to prevent false alarm in code checker on locks
 }
 
-template <typename TYPE>
-bool MutexedSimpleRecycleList<TYPE>::Unlock()
+template <typename TYPE, typename LOCK_TYPE>
+bool MutexedSimpleRecycleList<TYPE, LOCK_TYPE>::Unlock()
 {
 	return mutex.Unlock();	// Add SL_ as comment in order to prevent false alarm in code checker on locks
 }
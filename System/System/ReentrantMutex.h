@@ -11,6 +11,7 @@
 #include <System/LockManagement.h>
 
 #include <mutex>
+#include <chrono>
 
 namespace Omiscid {
 
@@ -26,7 +27,7 @@ namespace Omiscid {
 class ReentrantMutex : public LockableObject 
 {
 protected:
-	std::recursive_mutex InternalMutex;
+	std::recursive_timed_mutex InternalMutex;
 
 public:
 	/** @brief Constructor */
@@ -38,8 +39,10 @@ public:
 	/**
 	 * @brief Lock the mutex.
 	 *
-	 * Wait if the mutex is already locked, until it is unlocked, and then locks the mutex
-	 * @return false if an error occured
+	 * Wait if the mutex is already locked, until it is unlocked, and then locks the mutex.
+	 * Waiting threads are blocked by the system, they do not poll the mutex.
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the mutex was not acquired within wait_us or if an error occured
 	 */
 	bool Lock(int wait_us = 0);
 
@@ -56,7 +59,15 @@ public:
 	 *
 	 * Enables other clients to use the critical section protected by this mutex.
 	 */
-	inline bool Unlock() { InternalMutex.unlock(); return true; }
+	inline bool Unlock()
+	{
+		if ( pProfileHook != NULL )
+		{
+			ProfileReleased();
+		}
+		InternalMutex.unlock();
+		return true;
+	}
 
 	/**
 	 * @brief Unlock the mutex. Deprecated, use ReentrantMutex#Unlock instead
@@ -64,6 +75,16 @@ public:
 	 * Enables other clients to use the critical section protected by this mutex.
 	 */
 	inline bool LeaveMutex() { return Unlock(); };
+
+	/** @brief Record the contention of this mutex in the LockProfiler, see LockableObject#EnableProfiling */
+	virtual bool EnableProfiling( const char * Name );
+
+private:
+	/** @brief Lock, waiting at most wait_us (0 for ever) */
+	bool WaitForLock(int wait_us);
+
+	/** @brief Lock recording the contention in the LockProfiler */
+	bool ProfiledLock(int wait_us, void * CallSite);
 };
 
 } // namespace Omiscid
@@ -127,6 +127,19 @@ public:
    */
   int Send(size_t len, const char* buf);
 
+  /** @brief Send two buffers of byte as a single message with a gather write
+   *
+   * Send the concatenation of buf1 and buf2 without copying them in a temporary
+   * buffer (i.e. a header and a payload) using sendmsg (WSASend on Windows).
+   * @param len1 [in] the length of the first buffer
+   * @param buf1 [in] the first buffer of byte to send
+   * @param len2 [in] the length of the second buffer
+   * @param buf2 [in] the second buffer of byte to send
+   * @return the number of send byte
+   * @exception raise SocketException if error during sending
+   */
+  int Send(size_t len1, const char* buf1, size_t len2, const char* buf2);
+
   /** @brief Send a buffer of byte to a destination (for datagram)
    * @param len [in] the length of the buffer
    * @param buf  [in] the buffer of byte to send
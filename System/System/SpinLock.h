@@ -0,0 +1,119 @@
+/**
+ * @file System/SpinLock.h
+ * @ingroup System
+ * @brief Definition of SpinLock class
+ */
+
+#ifndef __SPIN_LOCK_H__
+#define __SPIN_LOCK_H__
+
+#include <System/ConfigSystem.h>
+#include <System/LockManagement.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+#include <intrin.h>
+#endif
+
+namespace Omiscid {
+
+/** @brief Tell the CPU the calling thread is spinning (lets the sibling hyperthread run, saves power) */
+inline void OmiscidCpuPause()
+{
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+	_mm_pause();
+#elif defined __i386__ || defined __x86_64__
+	__builtin_ia32_pause();
+#elif defined __aarch64__ || defined __arm__
+	__asm__ __volatile__( "yield" );
+#endif
+}
+
+/**
+ * @class SpinLock SpinLock.h System/SpinLock.h
+ * @brief Non reentrant lock that never blocks in the system
+ *
+ * A waiting thread spins on the lock with a pause instruction and gives its
+ * time slice back regularly. Lock and Unlock are inline, uncontended they are
+ * a single atomic operation each: use it for critical sections of a few
+ * instructions, through SmartPolicyLocker or a policy template parameter
+ * (MutexedSimpleList...) to avoid virtual calls.
+ */
+class SpinLock final : public LockableObject
+{
+public:
+	/** @brief Constructor */
+	SpinLock() : Locked(false) {}
+
+	/** @brief Destructor */
+	virtual ~SpinLock() {}
+
+	/**
+	 * @brief Lock the spin lock.
+	 * @param wait_us [in] maximum time to wait in microseconds, 0 means wait forever
+	 * @return false if the lock was not acquired within wait_us
+	 */
+	bool Lock(int wait_us = 0)
+	{
+		if ( Locked.exchange(true, std::memory_order_acquire) == false )
+		{
+			return true;
+		}
+		return LockContended( wait_us );
+	}
+
+	/** @brief Try to lock the spin lock without waiting */
+	bool TryLock()
+	{
+		return Locked.load(std::memory_order_relaxed) == false && Locked.exchange(true, std::memory_order_acquire) == false;
+	}
+
+	/** @brief Unlock the spin lock */
+	bool Unlock()
+	{
+		Locked.store( false, std::memory_order_release );
+		return true;
+	}
+
+private:
+	// Copying a lock makes no sense
+	SpinLock( const SpinLock& );
+	SpinLock& operator=( const SpinLock& );
+
+	/** @brief Number of spins before giving the time slice back */
+	static const unsigned int SpinsBeforeYield = 64;
+
+	bool LockContended( int wait_us )
+	{
+		const std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(wait_us > 0 ? wait_us : 0);
+		while( true )
+		{
+			// Spin on a read to keep the cache line shared while the lock is taken
+			for( unsigned int Spin = 0; Spin < SpinsBeforeYield; Spin++ )
+			{
+				if ( TryLock() == true )
+				{
+					return true;
+				}
+				OmiscidCpuPause();
+			}
+
+			if ( wait_us > 0 && std::chrono::steady_clock::now() >= Deadline )
+			{
+				return TryLock();
+			}
+
+			// The owner may be preempted, let it run
+			std::this_thread::yield();
+		}
+	}
+
+	std::atomic<bool> Locked;
+};
+
+} // namespace Omiscid
+
+#endif // __SPIN_LOCK_H__
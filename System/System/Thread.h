@@ -11,13 +11,16 @@
 #include <System/Event.h>
 #include <System/Mutex.h>
 #include <System/MutexedSimpleList.h>
-
-#ifdef DEBUG
+#include <System/SpinLock.h>
+#include <System/MpscQueue.h>
 #include <System/SimpleString.h>
-#endif
 
 #include <thread>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
 
 namespace Omiscid {
 
@@ -162,13 +165,55 @@ public:
 	 */
 	static std::thread::id GetCallerThreadId();
 
+	/** @brief Scheduling policies, see SetScheduling */
+	enum SchedulingPolicy { NormalScheduling, RealTimeScheduling };
+
+	/** @brief Set the processors the thread can run on
+	 *
+	 * Like all thread settings, it is applied by the thread itself before calling Run,
+	 * or at once if the running thread calls it. Failures at start are reported with OmiscidError.
+	 * Called by another thread while the thread runs, the setting is only kept for the next start.
+	 * Not supported on Mac OS X. Under Windows, only the first 64 processors can be used.
+	 * @param Cpus [in] indexes of the processors, empty for all processors
+	 * @return false if the setting was applied at once and failed, is not supported, or can
+	 * not be applied because another thread than the running one calls it
+	 */
+	bool SetAffinity( const std::vector<unsigned int>& Cpus );
+
+	/** @brief Set the scheduling policy and priority of the thread
+	 *
+	 * See SetAffinity for when it is applied.
+	 * @param Policy [in] NormalScheduling (time sharing) or RealTimeScheduling (SCHED_FIFO, needs privileges)
+	 * @param Priority [in] for NormalScheduling, a nice value from -20 (highest) to 19 (lowest),
+	 * for RealTimeScheduling, a priority from 1 (lowest) to 99 (highest). Under Windows,
+	 * the values are mapped on the thread priority levels.
+	 * @return false if the setting was applied at once and failed, is not supported, or can not be applied (see SetAffinity)
+	 */
+	bool SetScheduling( SchedulingPolicy Policy, int Priority );
+
+	/** @brief Set the name of the thread shown by debuggers and system tools (top, perf...)
+	 *
+	 * See SetAffinity for when it is applied. Under Linux, names are truncated to 15 characters.
+	 * Not supported under Windows.
+	 * @param Name [in] name of the thread
+	 * @return false if the setting was applied at once and failed, is not supported, or can not be applied (see SetAffinity)
+	 */
+	bool SetName( const SimpleString& Name );
+
+	/** @brief Get the processor running the calling thread
+	 * @return the index of the processor, -1 if it is not supported
+	 */
+	static int GetCurrentCpu();
+
 protected:
 
 	enum TIMEOUTS { DEFAULT_THREAD_DESTRUCTOR_TIMEOUT = 1000, DEFAULT_MAX_THREAD_DESTRUCTOR_TIMEOUT = 10000, DEFAULT_MESSAGE_TIMEOUT = 100, DEFAULT_JOIN_TIMEOUT = 0, DEFAULT_START_THREAD_TIMEOUT = 0 }; // 1 second, 10 seconds, 100 ms, 0 second (infinite)
 
 	/** @brief Retrieve message for a thread with timeout
 	 *
-	 * Retrieve message for a thread
+	 * Retrieve message for a thread. The calling thread is blocked until a message
+	 * is sent or until TimeOut is elapsed, it does not poll the queue.
+	 * @param TimeOut [in] maximum time to wait in milliseconds, 0 means wait forever
 	 */
 	bool WaitAndGetMessage( ThreadMessage& MsgToSend, unsigned int TimeOut = (unsigned int)DEFAULT_MESSAGE_TIMEOUT );
 
@@ -178,6 +223,13 @@ protected:
 	 */
 	bool GetMessage( ThreadMessage& MsgToSend );
 
+	/** @brief Get all pending messages of a thread, in order
+	 *
+	 * The queue is locked once for all messages, they are added at the tail of Messages.
+	 * @return the number of messages added to Messages
+	 */
+	unsigned int DrainMessages( SimpleList<ThreadMessage>& Messages );
+
 	/** @brief Method executed in a thread.
 	 *
 	 * Overload this virtual function and provide your own
@@ -202,7 +254,32 @@ protected:
 
 	Event IsEnded;				/*!< To say I am ended */
 
-	MutexedSimpleList<ThreadMessage> MsgQueue;	/*!< To store message to me */
+	/** @brief Type of the message queue, senders never wait for each other nor for the receiver */
+	typedef MpscQueue<ThreadMessage> MessageQueue;
+
+	MessageQueue MsgQueue;	/*!< To store message to me, use SendMessage to wake up the waiting thread */
+	SpinLock MsgQueueConsumer;	/*!< MsgQueue has a single consumer, serialize the threads getting messages */
+
+	std::mutex MessageMutex;					/*!< Protect waits on MessageCondition */
+	std::condition_variable MessageCondition;	/*!< Signaled when a message is sent and someone waits */
+	std::atomic<unsigned int> NbMessageWaiters;	/*!< Number of threads in WaitAndGetMessage */
+
+	/** @brief Wake up the threads waiting in WaitAndGetMessage, if any */
+	void NotifyMessage();
+
+	std::atomic<std::thread::id> RunningThreadId;	/*!< Id of the thread running Run, MyThread is detached */
+
+	std::mutex SettingsMutex;			/*!< Protect the thread settings */
+	bool SettingsApplied;				/*!< The running thread has applied the settings, later changes must be applied by itself */
+	bool AffinityIsSet;
+	std::vector<unsigned int> AffinityCpus;
+	bool SchedulingIsSet;
+	SchedulingPolicy Scheduling;
+	int SchedulingPriority;
+	SimpleString OsName;				/*!< Name given to the system, empty if not set */
+
+	/** @brief Apply the settings to the calling thread, called before Run */
+	void ApplySettings();
 
 #ifdef OMISCID_ON_WINDOWS
 	std::unique_ptr<std::thread> MyThread;		/*!< To store created thread a thread */
@@ -0,0 +1,190 @@
+/**
+ * @file System/ThreadPool.h
+ * @ingroup System
+ * @brief Definition of ThreadPool class
+ */
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <System/ConfigSystem.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Omiscid {
+
+/**
+ * @class ThreadPool ThreadPool.cpp System/ThreadPool.h
+ * @brief Work stealing pool of threads executing tasks
+ *
+ * Each worker is a Thread with its own deque of tasks. A worker executes its
+ * last submitted task first (the data is still in cache) and, when its deque
+ * is empty, steals the oldest task of another worker. Tasks submitted by a
+ * worker of the pool go to its own deque, the others are dealt to the workers
+ * in turn. Idle workers sleep until a task is submitted, they never poll.
+ *
+ * Tasks are submitted with Submit (a future gives the result or the exception
+ * of the task) or Execute (the exceptions are reported with OmiscidError).
+ * ParallelFor splits an index range in chunks executed by the workers and by
+ * the calling thread, it can be called from a task.
+ *
+ * GetSharedPool returns a pool with one worker per core, shared by all the
+ * components (see SerializeBatch in Messaging).
+ */
+class ThreadPool
+{
+public:
+	enum TIMEOUTS { DEFAULT_STOP_TIMEOUT = 1000 }; // 1 second, like Thread::StopThread
+
+	/** @brief Statistics of a pool */
+	struct Statistics
+	{
+		unsigned int NbWorkers;				/*!< Number of worker threads */
+		unsigned long long QueuedTasks;		/*!< Number of tasks waiting to be executed */
+		unsigned long long ExecutedTasks;	/*!< Number of tasks executed since the creation of the pool */
+		unsigned long long Steals;			/*!< Number of tasks executed by another worker than the one they were given to */
+		unsigned long long IdleTimeNs;		/*!< Total time spent by the workers waiting for tasks, in nanoseconds */
+	};
+
+	/** @brief Constructor, start the workers
+	 * @param NbWorkers [in] number of worker threads, 0 for the number of cores
+	 */
+	ThreadPool( unsigned int NbWorkers = 0 );
+
+	/** @brief Destructor, stop the pool (see Stop)
+	 *
+	 * If a task does not end before the timeout of Stop, the destructor reports it
+	 * and waits for the end of the task: the workers and the pool can not be freed
+	 * while a task runs. A pool must not be destroyed by one of its tasks.
+	 */
+	virtual ~ThreadPool();
+
+	/** @brief Get the pool shared by all components, created at first call */
+	static ThreadPool& GetSharedPool();
+
+	/** @brief Execute a task in the pool
+	 *
+	 * Exceptions thrown by Task are caught and reported with OmiscidError.
+	 * @param Task [in] the task to execute
+	 * @throw SimpleException if the pool is stopped
+	 */
+	void Execute( std::function<void()> Task );
+
+	/** @brief Execute a callable object in the pool
+	 * @param Function [in] callable object without parameter
+	 * @return a future to get the result of Function, or the exception it has thrown
+	 * @throw SimpleException if the pool is stopped
+	 */
+	template <typename FUNCTION>
+	std::future<typename std::result_of<FUNCTION()>::type> Submit( FUNCTION Function )
+	{
+		typedef typename std::result_of<FUNCTION()>::type RESULT;
+
+		// std::function needs a copyable object, share the packaged task
+		std::shared_ptr< std::packaged_task<RESULT()> > Task = std::make_shared< std::packaged_task<RESULT()> >( std::move(Function) );
+		std::future<RESULT> Result = Task->get_future();
+		Execute( [Task]() { (*Task)(); } );
+		return Result;
+	}
+
+	/** @brief Call Body(Index) for all Index in [Begin, End[, in parallel
+	 *
+	 * The calling thread executes chunks too and returns when all of them are done.
+	 * If calls to Body throw, all other indexes are processed and one of the exceptions
+	 * is rethrown.
+	 * @param Begin [in] first index
+	 * @param End [in] index after the last one
+	 * @param Body [in] callable object with a size_t parameter
+	 * @param Grain [in] number of indexes per chunk, 0 to make 4 chunks per thread
+	 */
+	template <typename FUNCTION>
+	void ParallelFor( size_t Begin, size_t End, FUNCTION Body, size_t Grain = 0 )
+	{
+		ParallelForChunks( Begin, End, Grain, [&Body]( size_t ChunkBegin, size_t ChunkEnd )
+		{
+			// Go on with the chunk, keep the first exception for ParallelForChunks
+			std::exception_ptr FirstError;
+			for( size_t Index = ChunkBegin; Index < ChunkEnd; Index++ )
+			{
+				try
+				{
+					Body( Index );
+				}
+				catch( ... )
+				{
+					if ( !FirstError )
+					{
+						FirstError = std::current_exception();
+					}
+				}
+			}
+			if ( FirstError )
+			{
+				std::rethrow_exception( FirstError );
+			}
+		} );
+	}
+
+	/** @brief Stop the pool
+	 *
+	 * No task can be submitted anymore. The workers execute the tasks already
+	 * submitted and terminate, see Thread::StopThread.
+	 * @param wait_ms [in] maximum time to wait for each worker, 0 for DEFAULT_MAX_THREAD_DESTRUCTOR_TIMEOUT of Thread
+	 * @return false if a worker did not stop in time
+	 */
+	bool Stop( int wait_ms = DEFAULT_STOP_TIMEOUT );
+
+	/** @brief Get the number of worker threads */
+	unsigned int GetNumberOfWorkers() const;
+
+	/** @brief Get the statistics of the pool */
+	Statistics GetStatistics() const;
+
+private:
+	// Copying a pool makes no sense
+	ThreadPool( const ThreadPool& );
+	ThreadPool& operator=( const ThreadPool& );
+
+public:
+	/** @brief Thread of the pool, defined in ThreadPool.cpp */
+	class Worker;
+
+private:
+	/** @brief Split [Begin, End[ in chunks and call ChunkBody on each of them */
+	void ParallelForChunks( size_t Begin, size_t End, size_t Grain, const std::function<void(size_t, size_t)>& ChunkBody );
+
+	/** @brief Take a task from the deque of worker Index or steal one from another worker */
+	bool TakeTask( unsigned int Index, std::function<void()>& Task );
+
+	/** @brief Sleep until a task is submitted
+	 * @return false if the pool is stopped and there is no more task
+	 */
+	bool WaitForTask();
+
+	std::vector<Worker*> Workers;
+	std::atomic<unsigned int> NextWorker;		/*!< Worker receiving the next task submitted from outside */
+
+	std::atomic<long long> PendingTasks;		/*!< Tasks in the deques (may be negative for a short time) */
+	std::atomic<bool> Stopping;
+	std::atomic<unsigned int> NbSubmitters;		/*!< Threads in Execute, Stop waits for them */
+
+	std::mutex IdleMutex;						/*!< Protect waits on IdleCondition */
+	std::condition_variable IdleCondition;		/*!< Signaled when a task is submitted and a worker sleeps */
+	std::atomic<unsigned int> NbIdleWorkers;
+
+	std::atomic<unsigned long long> ExecutedTasks;
+	std::atomic<unsigned long long> Steals;
+	std::atomic<unsigned long long> IdleTimeNs;
+};
+
+} // namespace Omiscid
+
+#endif // __THREAD_POOL_H__
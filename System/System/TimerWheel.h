@@ -0,0 +1,157 @@
+/**
+ * @file System/TimerWheel.h
+ * @ingroup System
+ * @brief Definition of TimerWheel class
+ */
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <System/ConfigSystem.h>
+#include <System/Thread.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Omiscid {
+
+class ThreadPool;
+
+/**
+ * @class TimerWheel TimerWheel.cpp System/TimerWheel.h
+ * @brief Scheduler of one-shot and periodic timers running on a single thread
+ *
+ * Timers are stored in a hierarchical timing wheel: 4 levels of 256 slots, a
+ * level covering 256 times the range of the previous one. Scheduling and
+ * cancelling a timer are O(1), a timer moves down to the lower level when the
+ * lower level has turned (cascade). Time is counted in ticks of a monotonic
+ * clock since the creation of the wheel, a timer never fires before its delay
+ * and at most one tick after (plus the time taken by the callbacks when they
+ * run on the thread of the wheel).
+ *
+ * The thread of the wheel sleeps until the next non empty slot or the next
+ * cascade, it does not wake up at all when there is no timer. Callbacks run on the
+ * thread of the wheel or, if an executor is given, are posted to a ThreadPool.
+ * They must not block the thread of the wheel for long.
+ *
+ * Schedule and Cancel can be called from any thread, including from a callback.
+ */
+class TimerWheel : public Thread
+{
+public:
+	/** @brief Identifier of a timer, 0 is never used */
+	typedef unsigned long long TimerId;
+
+	/** @brief Constructor, start the thread of the wheel
+	 * @param TickInMilliseconds [in] resolution of the timers (default 1 ms)
+	 * @param Executor [in] pool executing the callbacks, NULL to run them on the thread of the wheel
+	 */
+	TimerWheel( unsigned int TickInMilliseconds = 1, ThreadPool * Executor = NULL );
+
+	/** @brief Destructor, stop the thread (the pending timers are cancelled) */
+	virtual ~TimerWheel();
+
+	/** @brief Call a function once after a delay
+	 * @param DelayInMilliseconds [in] delay before the call
+	 * @param Callback [in] the function to call
+	 * @return the identifier of the timer
+	 */
+	TimerId ScheduleOnce( unsigned int DelayInMilliseconds, std::function<void()> Callback );
+
+	/** @brief Call a function periodically
+	 *
+	 * Periods are counted from the scheduled times, not from the end of the callbacks,
+	 * so the timer does not drift. Calls missed because the wheel was late are skipped.
+	 * @param PeriodInMilliseconds [in] time between two calls
+	 * @param Callback [in] the function to call
+	 * @param FirstDelayInMilliseconds [in] delay before the first call, 0 to use the period
+	 * @return the identifier of the timer
+	 */
+	TimerId SchedulePeriodic( unsigned int PeriodInMilliseconds, std::function<void()> Callback, unsigned int FirstDelayInMilliseconds = 0 );
+
+	/** @brief Cancel a timer
+	 *
+	 * A callback already due may still be running or about to run.
+	 * @return false if the timer does not exist (one-shot timer already fired, already cancelled)
+	 */
+	bool Cancel( TimerId Id );
+
+	/** @brief Get the number of scheduled timers */
+	unsigned int GetNumberOfTimers();
+
+	/** @brief Stop the thread of the wheel, see Thread::StopThread */
+	virtual bool StopThread( int wait_ms = DEFAULT_THREAD_DESTRUCTOR_TIMEOUT, bool UNUSED = true );
+
+protected:
+	void FUNCTION_CALL_TYPE Run();
+
+private:
+	// Geometry of the wheel
+	static const unsigned int NbLevels = 4;
+	static const unsigned int SlotBits = 8;
+	static const unsigned int NbSlots = 1 << SlotBits;
+	static const unsigned int SlotMask = NbSlots - 1;
+
+	/** @brief A timer, stored in a slot of the wheel */
+	struct Timer
+	{
+		TimerId Id;
+		unsigned long long Expiry;		/*!< Tick of the next call */
+		unsigned long long Period;		/*!< In ticks, 0 for one-shot timers */
+		std::shared_ptr< std::function<void()> > Callback;	/*!< Shared with the pending calls */
+
+		Timer * Next;		/*!< Next timer in the slot */
+		Timer ** pPrevious;	/*!< Pointer that points to this timer in the slot */
+	};
+
+	/** @brief Schedule a new timer, Period in ticks (0 for one-shot timers) */
+	TimerId Schedule( std::chrono::steady_clock::duration Delay, unsigned long long Period, std::function<void()>&& Callback );
+
+	/** @brief Get the number of ticks elapsed since the creation of the wheel, rounded down */
+	unsigned long long GetCurrentTime() const;
+
+	/** @brief Convert a duration in milliseconds in ticks, at least one tick */
+	unsigned long long ToTicks( unsigned int Milliseconds ) const;
+
+	/** @brief Put a timer in the slot of its expiry */
+	void AddTimer( Timer * ToAdd );
+
+	/** @brief Remove a timer from its slot */
+	static void RemoveTimer( Timer * ToRemove );
+
+	/** @brief Move the timers of a slot of Level to the lower levels */
+	void Cascade( unsigned int Level, unsigned int Slot );
+
+	/** @brief Advance the wheel of one tick, add the due callbacks to Due.
+	 * Now is the current time: periodic timers are put back after it, even when the wheel catches up.
+	 */
+	void Tick( unsigned long long Now, std::vector< std::shared_ptr< std::function<void()> > >& Due );
+
+	/** @brief Tick where the thread must wake up: next non empty slot of level 0 or next cascade */
+	unsigned long long GetNextWakeTick() const;
+
+	/** @brief Call or post the callbacks */
+	void RunCallbacks( std::vector< std::shared_ptr< std::function<void()> > >& Due );
+
+	const std::chrono::steady_clock::time_point Origin;
+	const std::chrono::steady_clock::duration TickDuration;
+	ThreadPool * const Executor;
+
+	std::mutex WheelMutex;						/*!< Protect all the following members */
+	std::condition_variable WheelCondition;		/*!< Signaled when a timer expires before WakeTick, or to stop */
+	bool Stopping;
+	unsigned long long CurrentTick;				/*!< Last processed tick */
+	unsigned long long WakeTick;				/*!< Tick the thread sleeps until, 0 if it does not sleep */
+	TimerId LastId;
+	Timer * Slots[NbLevels][NbSlots];
+	std::unordered_map<TimerId, Timer*> Timers;
+};
+
+} // namespace Omiscid
+
+#endif // __TIMER_WHEEL_H__
@@ -11,8 +11,129 @@
 
 #include <errno.h>
 
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
 using namespace Omiscid;
 
+namespace {
+
+	// Thread settings are applied by the thread itself
+
+	bool ApplyAffinity( const std::vector<unsigned int>& Cpus )
+	{
+#ifdef OMISCID_ON_WINDOWS
+		DWORD_PTR Mask = 0;
+		for( size_t i = 0; i < Cpus.size(); i++ )
+		{
+			if ( Cpus[i] < sizeof(DWORD_PTR)*8 )
+			{
+				Mask |= ((DWORD_PTR)1) << Cpus[i];
+			}
+		}
+		if ( Cpus.empty() )
+		{
+			DWORD_PTR SystemMask;
+			if ( GetProcessAffinityMask( GetCurrentProcess(), &Mask, &SystemMask ) == 0 )
+			{
+				return false;
+			}
+		}
+		return Mask != 0 && SetThreadAffinityMask( GetCurrentThread(), Mask ) != 0;
+#elif defined __linux__
+		cpu_set_t CpuSet;
+		CPU_ZERO( &CpuSet );
+		if ( Cpus.empty() )
+		{
+			// The system ignores the processors that do not exist
+			for( unsigned int Cpu = 0; Cpu < CPU_SETSIZE; Cpu++ )
+			{
+				CPU_SET( Cpu, &CpuSet );
+			}
+		}
+		for( size_t i = 0; i < Cpus.size(); i++ )
+		{
+			if ( Cpus[i] < CPU_SETSIZE )
+			{
+				CPU_SET( Cpus[i], &CpuSet );
+			}
+		}
+		return pthread_setaffinity_np( pthread_self(), sizeof(CpuSet), &CpuSet ) == 0;
+#else
+		return false;
+#endif
+	}
+
+	bool ApplyScheduling( Thread::SchedulingPolicy Policy, int Priority )
+	{
+#ifdef OMISCID_ON_WINDOWS
+		int WindowsPriority;
+		if ( Policy == Thread::RealTimeScheduling )
+		{
+			WindowsPriority = THREAD_PRIORITY_TIME_CRITICAL;
+		}
+		else if ( Priority <= -10 )
+		{
+			WindowsPriority = THREAD_PRIORITY_HIGHEST;
+		}
+		else if ( Priority < 0 )
+		{
+			WindowsPriority = THREAD_PRIORITY_ABOVE_NORMAL;
+		}
+		else if ( Priority == 0 )
+		{
+			WindowsPriority = THREAD_PRIORITY_NORMAL;
+		}
+		else if ( Priority < 10 )
+		{
+			WindowsPriority = THREAD_PRIORITY_BELOW_NORMAL;
+		}
+		else
+		{
+			WindowsPriority = THREAD_PRIORITY_LOWEST;
+		}
+		return SetThreadPriority( GetCurrentThread(), WindowsPriority ) != 0;
+#else
+		struct sched_param Param;
+		if ( Policy == Thread::RealTimeScheduling )
+		{
+			const int MinPriority = sched_get_priority_min( SCHED_FIFO );
+			const int MaxPriority = sched_get_priority_max( SCHED_FIFO );
+			Param.sched_priority = Priority < MinPriority ? MinPriority : (Priority > MaxPriority ? MaxPriority : Priority);
+			return pthread_setschedparam( pthread_self(), SCHED_FIFO, &Param ) == 0;
+		}
+
+		Param.sched_priority = 0;
+		if ( pthread_setschedparam( pthread_self(), SCHED_OTHER, &Param ) != 0 )
+		{
+			return false;
+		}
+#ifdef __linux__
+		// Under Linux, the nice value is per thread
+		return setpriority( PRIO_PROCESS, (id_t)syscall(SYS_gettid), Priority ) == 0;
+#else
+		return Priority == 0;
+#endif
+#endif
+	}
+
+	bool ApplyName( const SimpleString& Name )
+	{
+#if defined __linux__
+		// 16 bytes with the final 0
+		return pthread_setname_np( pthread_self(), Name.substr(0, 15).c_str() ) == 0;
+#elif defined __APPLE__
+		return pthread_setname_np( Name.GetStr() ) == 0;
+#else
+		return false;
+#endif
+	}
+
+} // anonymous namespace
+
 	/** @brief Constructor
 	 *
 	 */
@@ -62,6 +183,16 @@ Thread::Thread()
 #endif
 	ThreadIsRunning = false;
 	StopWasAsked = false;
+	NbMessageWaiters = 0;
+	RunningThreadId = std::thread::id();
+	SettingsApplied = false;
+	AffinityIsSet = false;
+	SchedulingIsSet = false;
+	Scheduling = NormalScheduling;
+	SchedulingPriority = 0;
+#ifdef DEBUG_THREAD
+	OsName = Name;
+#endif
 }
 
 Thread::~Thread()
@@ -195,6 +326,9 @@ unsigned int FUNCTION_CALL_TYPE Thread::CallRun(void* ptr)
 	OmiscidTrace( "%s started\n", t->ThreadName.GetStr() );
 #endif
 
+	t->RunningThreadId = std::this_thread::get_id();
+	t->ApplySettings();
+
 	// Do my job
 	t->ThreadIsRunning = true;
 	try
@@ -215,6 +349,12 @@ unsigned int FUNCTION_CALL_TYPE Thread::CallRun(void* ptr)
 		fprintf( stderr, "Unknown exception in thread\n" );
 	}
 	t->ThreadIsRunning = false;
+	{
+		// Settings changed from now are applied at the next start
+		std::lock_guard<std::mutex> SL_SettingsMutex(t->SettingsMutex);
+		t->SettingsApplied = false;
+	}
+	t->RunningThreadId = std::thread::id();
 
 	// signal, my job is over
 	t->IsEnded.Signal();
@@ -255,11 +395,8 @@ void Thread::WaitForStop()
  */
 std::thread::id Thread::GetId()
 {
-	if ( MyThread.get() != nullptr )
-	{
-		return MyThread->get_id();
-	}
-	return std::thread::id();
+	// MyThread is detached, it does not know the id anymore
+	return RunningThreadId;
 }
 
 /** @brief return an Id for the calling Thread
@@ -270,6 +407,119 @@ std::thread::id Thread::GetCallerThreadId()
 	return std::this_thread::get_id();
 }
 
+	/** @brief Set the processors the thread can run on
+	 *
+	 */
+bool Thread::SetAffinity( const std::vector<unsigned int>& Cpus )
+{
+	std::lock_guard<std::mutex> SL_SettingsMutex(SettingsMutex);
+
+	AffinityIsSet = true;
+	AffinityCpus = Cpus;
+
+	if ( SettingsApplied == true )
+	{
+		if ( GetId() != GetCallerThreadId() )
+		{
+			// Only the running thread can apply it
+			return false;
+		}
+		return ApplyAffinity( AffinityCpus );
+	}
+#if defined OMISCID_ON_WINDOWS || defined __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+	/** @brief Set the scheduling policy and priority of the thread
+	 *
+	 */
+bool Thread::SetScheduling( SchedulingPolicy Policy, int Priority )
+{
+	std::lock_guard<std::mutex> SL_SettingsMutex(SettingsMutex);
+
+	SchedulingIsSet = true;
+	Scheduling = Policy;
+	SchedulingPriority = Priority;
+
+	if ( SettingsApplied == true )
+	{
+		if ( GetId() != GetCallerThreadId() )
+		{
+			// Only the running thread can apply it
+			return false;
+		}
+		return ApplyScheduling( Scheduling, SchedulingPriority );
+	}
+	return true;
+}
+
+	/** @brief Set the name of the thread shown by system tools
+	 *
+	 */
+bool Thread::SetName( const SimpleString& Name )
+{
+	std::lock_guard<std::mutex> SL_SettingsMutex(SettingsMutex);
+
+	OsName = Name;
+#ifdef DEBUG_THREAD
+	ThreadName = Name;
+#endif
+
+	if ( SettingsApplied == true )
+	{
+		if ( GetId() != GetCallerThreadId() )
+		{
+			// Only the running thread can apply it
+			return false;
+		}
+		return ApplyName( OsName );
+	}
+#if defined __linux__ || defined __APPLE__
+	return true;
+#else
+	return false;
+#endif
+}
+
+	/** @brief Get the processor running the calling thread
+	 *
+	 */
+int Thread::GetCurrentCpu()
+{
+#ifdef OMISCID_ON_WINDOWS
+	return (int)GetCurrentProcessorNumber();
+#elif defined __linux__
+	return sched_getcpu();
+#else
+	return -1;
+#endif
+}
+
+	/** @brief Apply the settings to the calling thread
+	 *
+	 */
+void Thread::ApplySettings()
+{
+	std::lock_guard<std::mutex> SL_SettingsMutex(SettingsMutex);
+
+	if ( OsName.empty() == false && ApplyName( OsName ) == false )
+	{
+		OmiscidError( "Thread::ApplySettings: can not set thread name to '%s'.\n", OsName.GetStr() );
+	}
+	if ( AffinityIsSet == true && ApplyAffinity( AffinityCpus ) == false )
+	{
+		OmiscidError( "Thread::ApplySettings: can not set thread affinity (%d processors).\n", (int)AffinityCpus.size() );
+	}
+	if ( SchedulingIsSet == true && ApplyScheduling( Scheduling, SchedulingPriority ) == false )
+	{
+		OmiscidError( "Thread::ApplySettings: can not set thread scheduling (policy %d, priority %d).\n", (int)Scheduling, SchedulingPriority );
+	}
+	SettingsApplied = true;
+}
+
 	/** @brief Send message to a Thread
 	 *
 	 * Send a message to a thread
@@ -278,9 +528,7 @@ void Thread::SendMessage( int Code, void * Param1, void* Param2 /* = (void*)NULL
 {
 	ThreadMessage MsgToSend( Code, Param1, Param2 );
 
-	SmartLocker SL_MsgQueue(MsgQueue);
-
-	MsgQueue.AddTail(MsgToSend);
+	SendMessage( MsgToSend );
 }
 
 /** @brief Send message to a Thread
@@ -289,9 +537,9 @@ void Thread::SendMessage( int Code, void * Param1, void* Param2 /* = (void*)NULL
 	*/
 void Thread::SendMessage( const ThreadMessage& MsgToSend )
 {
-	SmartLocker SL_MsgQueue(MsgQueue);
+	MsgQueue.Push(MsgToSend);
 
-	MsgQueue.AddTail(MsgToSend);
+	NotifyMessage();
 }
 
 	/** @brief Retrieve message for a thread with timeout
@@ -300,68 +548,77 @@ void Thread::SendMessage( const ThreadMessage& MsgToSend )
 	 */
 bool Thread::WaitAndGetMessage( ThreadMessage& MsgToGet, unsigned int DelayMax /* = (unsigned int)DEFAULT_MESSAGE_TIMEOUT */ )
 {
-	bool Done;
+	const std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DelayMax);
 
-	SmartLocker SL_MsgQueue(MsgQueue, false);
+	std::unique_lock<std::mutex> SL_MessageMutex(MessageMutex);
 
-	if ( DelayMax == 0 )
+	// Registered before looking at the queue: a message added after this check
+	// is seen by NotifyMessage, which can not notify before we wait
+	NbMessageWaiters++;
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+
+	bool Done = false;
+	while( true ) // was for(;;) but new version of MS compiler do no like it
 	{
-		// INFINITE wait
-		Done = false;
-		while( true ) // was for(;;) but new version of MS compiler do no like it
+		// Is there a message ?
+		if ( GetMessage( MsgToGet ) == true )
 		{
-			// Is there a message ?
-			SL_MsgQueue.Lock();
-			if ( MsgQueue.GetNumberOfElements() != 0 )
-			{
-				MsgToGet = MsgQueue.ExtractFirst();
-				Done = true;
-			}
-			SL_MsgQueue.Unlock();
-
-			if ( Done == true )
-			{
-				return true;
-			}
+			Done = true;
+			break;
+		}
 
-			// Wait
-			Sleep( 10 );
+		if ( DelayMax == 0 )
+		{
+			// INFINITE wait
+			MessageCondition.wait( SL_MessageMutex );
 		}
-		// never here
-		return true;
-	}
-	else
-	{
-		ElapsedTime CountWaitedTime;
-		Done = false;
-		while( true ) // was for(;;) but new version of MS compiler do no like it
+		else if ( MessageCondition.wait_until( SL_MessageMutex, Deadline ) == std::cv_status::timeout )
 		{
-			// Is there a message ?
-			SL_MsgQueue.Lock();
-			if ( MsgQueue.GetNumberOfElements() != 0 )
-			{
-				MsgToGet = MsgQueue.ExtractFirst();
-				Done = true;
-			}
-			SL_MsgQueue.Unlock();
+			Done = GetMessage( MsgToGet );
+			break;
+		}
+	}
 
-			if ( Done == true )
-			{
-				return true;
-			}
+	NbMessageWaiters--;
 
-			if ( Done == true || CountWaitedTime.Get() >= DelayMax )
-			{
-				return Done;
-			}
+	return Done;
+}
 
-			Sleep( 10 );
-		}
-		// never here
-		return true;
+	/** @brief Get all pending messages of a thread
+	 *
+	 * Get all pending messages of a thread
+	 */
+unsigned int Thread::DrainMessages( SimpleList<ThreadMessage>& Messages )
+{
+	SmartPolicyLocker<SpinLock> SL_MsgQueueConsumer(MsgQueueConsumer);
+
+	unsigned int NbMessages = 0;
+	ThreadMessage Message;
+	while( MsgQueue.Pop(Message) == true )
+	{
+		Messages.AddTail( Message );
+		NbMessages++;
 	}
+	return NbMessages;
+}
 
-	return false;
+	/** @brief Wake up the threads waiting for a message
+	 *
+	 * Must be called after the message is added to the queue
+	 */
+void Thread::NotifyMessage()
+{
+	// The message must be visible before we read NbMessageWaiters, pairs with
+	// the fence of WaitAndGetMessage between the registration and the queue check
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if ( NbMessageWaiters.load() == 0 )
+	{
+		// Nobody waits, the next WaitAndGetMessage will find the message
+		return;
+	}
+
+	std::lock_guard<std::mutex> SL_MessageMutex(MessageMutex);
+	MessageCondition.notify_all();
 }
 
 	/** @brief Get a message for a thread
@@ -370,16 +627,9 @@ bool Thread::WaitAndGetMessage( ThreadMessage& MsgToGet, unsigned int DelayMax /
 	 */
 bool Thread::GetMessage( ThreadMessage& MsgToSend )
 {
-	SmartLocker SL_MsgQueue(MsgQueue);
-
-	if ( MsgQueue.GetNumberOfElements() == 0 )
-	{
-		// No message
-		return false;
-	}
+	SmartPolicyLocker<SpinLock> SL_MsgQueueConsumer(MsgQueueConsumer);
 
-	// get first message
-	MsgToSend = MsgQueue.ExtractFirst();
-	return true;
+	// get first message if any
+	return MsgQueue.Pop(MsgToSend);
 }
-
+
@@ -0,0 +1,414 @@
+/**
+ * @file System/ThreadPool.cpp
+ * @ingroup System
+ * @brief Implementation of ThreadPool class
+ */
+
+#include <System/ThreadPool.h>
+#include <System/AdaptiveMutex.h>
+#include <System/SimpleException.h>
+#include <System/Thread.h>
+
+#include <chrono>
+#include <deque>
+#include <exception>
+
+using namespace Omiscid;
+
+/**
+ * @class ThreadPool::Worker
+ * @brief Thread executing the tasks of a pool
+ */
+class ThreadPool::Worker : public Thread
+{
+public:
+	Worker( ThreadPool& MyPool, unsigned int MyIndex )
+		: Pool(MyPool), Index(MyIndex)
+	{
+		// Room for any index, SetName truncates to the OS limit
+		char Name[32];
+		snprintf( Name, sizeof(Name), "OmiscidPool-%u", MyIndex );
+		SetName( Name );
+	}
+
+	virtual ~Worker()
+	{
+	}
+
+	/** @brief Add a task to the deque of this worker */
+	void Push( std::function<void()>&& Task )
+	{
+		SmartPolicyLocker<AdaptiveMutex> SL_TasksLock(TasksLock);
+		Tasks.push_back( std::move(Task) );
+	}
+
+	/** @brief Take the last task of the deque, used by the worker itself */
+	bool PopLast( std::function<void()>& Task )
+	{
+		SmartPolicyLocker<AdaptiveMutex> SL_TasksLock(TasksLock);
+		if ( Tasks.empty() )
+		{
+			return false;
+		}
+		Task = std::move( Tasks.back() );
+		Tasks.pop_back();
+		return true;
+	}
+
+	/** @brief Take the first task of the deque, used by the other workers */
+	bool PopFirst( std::function<void()>& Task )
+	{
+		SmartPolicyLocker<AdaptiveMutex> SL_TasksLock(TasksLock);
+		if ( Tasks.empty() )
+		{
+			return false;
+		}
+		Task = std::move( Tasks.front() );
+		Tasks.pop_front();
+		return true;
+	}
+
+	ThreadPool& Pool;
+	const unsigned int Index;
+
+protected:
+	void FUNCTION_CALL_TYPE Run();
+
+private:
+	AdaptiveMutex TasksLock;
+	std::deque< std::function<void()> > Tasks;
+};
+
+namespace {
+
+	// Worker running on the calling thread, if any
+	thread_local ThreadPool::Worker * CurrentWorker = NULL;
+
+	// State of a ParallelFor shared by the threads executing its chunks
+	struct ParallelForState
+	{
+		size_t Begin;
+		size_t End;
+		size_t Grain;
+		size_t NbChunks;
+		const std::function<void(size_t, size_t)> * pChunkBody;	/*!< Only valid while some chunks are not done */
+
+		std::atomic<size_t> NextChunk;
+		std::atomic<size_t> DoneChunks;
+
+		std::mutex DoneMutex;					/*!< Protect waits on DoneCondition and Error */
+		std::condition_variable DoneCondition;	/*!< Signaled when the last chunk is done */
+		std::exception_ptr Error;
+	};
+
+	// Execute chunks until there is no more to take
+	void RunChunks( ParallelForState& State )
+	{
+		while( true )
+		{
+			const size_t Chunk = State.NextChunk++;
+			if ( Chunk >= State.NbChunks )
+			{
+				return;
+			}
+
+			const size_t ChunkBegin = State.Begin + Chunk*State.Grain;
+			const size_t ChunkEnd = (State.End - ChunkBegin > State.Grain) ? ChunkBegin + State.Grain : State.End;
+			try
+			{
+				(*State.pChunkBody)( ChunkBegin, ChunkEnd );
+			}
+			catch( ... )
+			{
+				std::lock_guard<std::mutex> SL_DoneMutex(State.DoneMutex);
+				if ( !State.Error )
+				{
+					State.Error = std::current_exception();
+				}
+			}
+
+			if ( ++State.DoneChunks == State.NbChunks )
+			{
+				std::lock_guard<std::mutex> SL_DoneMutex(State.DoneMutex);
+				State.DoneCondition.notify_all();
+			}
+		}
+	}
+
+	unsigned long long ElapsedNs( const std::chrono::steady_clock::time_point& Start )
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+} // anonymous namespace
+
+void FUNCTION_CALL_TYPE ThreadPool::Worker::Run()
+{
+	CurrentWorker = this;
+
+	std::function<void()> Task;
+	while( true )
+	{
+		if ( Pool.TakeTask( Index, Task ) == false )
+		{
+			if ( Pool.WaitForTask() == false )
+			{
+				break;
+			}
+			continue;
+		}
+
+		try
+		{
+			Task();
+		}
+		catch( Omiscid::SimpleException &e )
+		{
+			OmiscidError( "ThreadPool: Omiscid::SimpleException in task: %s\n", e.msg.GetStr() );
+		}
+		catch( std::exception &e )
+		{
+			OmiscidError( "ThreadPool: std::exception in task: %s\n", e.what() );
+		}
+		catch( ... )
+		{
+			OmiscidError( "ThreadPool: Unknown exception in task\n" );
+		}
+
+		// Release what the task holds before waiting for the next one
+		Task = nullptr;
+		Pool.ExecutedTasks++;
+	}
+
+	CurrentWorker = NULL;
+}
+
+ThreadPool::ThreadPool( unsigned int NbWorkers /* = 0 */ )
+	: NextWorker(0), PendingTasks(0), Stopping(false), NbSubmitters(0), NbIdleWorkers(0), ExecutedTasks(0), Steals(0), IdleTimeNs(0)
+{
+	if ( NbWorkers == 0 )
+	{
+		NbWorkers = std::thread::hardware_concurrency();
+		if ( NbWorkers == 0 )
+		{
+			// Unknown value
+			NbWorkers = 1;
+		}
+	}
+
+	Workers.reserve( NbWorkers );
+	for( unsigned int Index = 0; Index < NbWorkers; Index++ )
+	{
+		Workers.push_back( new OMISCID_TLM Worker( *this, Index ) );
+		Workers[Index]->StartThread();
+	}
+
+	// A worker must be running to be stopped
+	for( unsigned int Index = 0; Index < NbWorkers; Index++ )
+	{
+		while( Workers[Index]->IsRunning() == false )
+		{
+			Thread::Usleep(100);
+		}
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	if ( Stop( 0 ) == false )
+	{
+		// A worker still executes a task, it uses the pool until it ends
+		OmiscidError( "ThreadPool::~ThreadPool: tasks do not end before timeout, waiting for them.\n" );
+		for( size_t Index = 0; Index < Workers.size(); Index++ )
+		{
+			Workers[Index]->Join();
+		}
+	}
+
+	for( size_t Index = 0; Index < Workers.size(); Index++ )
+	{
+		delete Workers[Index];
+	}
+}
+
+ThreadPool& ThreadPool::GetSharedPool()
+{
+	static ThreadPool SharedPool;
+	return SharedPool;
+}
+
+void ThreadPool::Execute( std::function<void()> Task )
+{
+	// Registered before checking Stopping: Stop waits for us if we saw it false
+	NbSubmitters++;
+	if ( Stopping.load() == true )
+	{
+		NbSubmitters--;
+		throw SimpleException( "ThreadPool::Execute: the pool is stopped" );
+	}
+
+	Worker * Target;
+	if ( CurrentWorker != NULL && &CurrentWorker->Pool == this )
+	{
+		// Submitted by a task, keep it on this worker
+		Target = CurrentWorker;
+	}
+	else
+	{
+		Target = Workers[NextWorker++ % Workers.size()];
+	}
+	Target->Push( std::move(Task) );
+
+	// Same protocol as Thread::SendMessage: the task is visible before we look for idle workers
+	PendingTasks++;
+	if ( NbIdleWorkers.load() > 0 )
+	{
+		std::lock_guard<std::mutex> SL_IdleMutex(IdleMutex);
+		IdleCondition.notify_one();
+	}
+
+	NbSubmitters--;
+}
+
+bool ThreadPool::TakeTask( unsigned int Index, std::function<void()>& Task )
+{
+	if ( Workers[Index]->PopLast( Task ) == true )
+	{
+		PendingTasks--;
+		return true;
+	}
+
+	// Steal the oldest task of another worker
+	const size_t NbWorkers = Workers.size();
+	for( size_t i = 1; i < NbWorkers; i++ )
+	{
+		if ( Workers[(Index+i) % NbWorkers]->PopFirst( Task ) == true )
+		{
+			PendingTasks--;
+			Steals++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ThreadPool::WaitForTask()
+{
+	std::unique_lock<std::mutex> SL_IdleMutex(IdleMutex);
+
+	// Registered before checking PendingTasks, see Execute
+	NbIdleWorkers++;
+
+	const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	while( PendingTasks.load() <= 0 && Stopping.load() == false )
+	{
+		IdleCondition.wait( SL_IdleMutex );
+	}
+	IdleTimeNs += ElapsedNs( Start );
+
+	NbIdleWorkers--;
+
+	// When stopping, the pending tasks are executed first
+	return PendingTasks.load() > 0 || Stopping.load() == false;
+}
+
+void ThreadPool::ParallelForChunks( size_t Begin, size_t End, size_t Grain, const std::function<void(size_t, size_t)>& ChunkBody )
+{
+	if ( End <= Begin )
+	{
+		return;
+	}
+
+	const size_t NbIndexes = End - Begin;
+	if ( Grain == 0 )
+	{
+		const size_t NbWantedChunks = 4*(Workers.size()+1);
+		Grain = (NbIndexes + NbWantedChunks - 1)/NbWantedChunks;
+	}
+
+	std::shared_ptr<ParallelForState> State = std::make_shared<ParallelForState>();
+	State->Begin = Begin;
+	State->End = End;
+	State->Grain = Grain;
+	State->NbChunks = (NbIndexes + Grain - 1)/Grain;
+	State->pChunkBody = &ChunkBody;
+	State->NextChunk = 0;
+	State->DoneChunks = 0;
+
+	// Helpers arriving after the last chunk was taken leave without using ChunkBody
+	size_t NbHelpers = State->NbChunks - 1;
+	if ( NbHelpers > Workers.size() )
+	{
+		NbHelpers = Workers.size();
+	}
+	for( size_t i = 0; i < NbHelpers; i++ )
+	{
+		try
+		{
+			Execute( [State]() { RunChunks( *State ); } );
+		}
+		catch( SimpleException& )
+		{
+			// Pool stopped, the calling thread does the remaining work
+			break;
+		}
+	}
+
+	RunChunks( *State );
+
+	std::unique_lock<std::mutex> SL_DoneMutex(State->DoneMutex);
+	while( State->DoneChunks.load() < State->NbChunks )
+	{
+		State->DoneCondition.wait( SL_DoneMutex );
+	}
+
+	if ( State->Error )
+	{
+		std::rethrow_exception( State->Error );
+	}
+}
+
+bool ThreadPool::Stop( int wait_ms /* = DEFAULT_STOP_TIMEOUT */ )
+{
+	Stopping = true;
+
+	// Tasks submitted before they saw Stopping must be in the deques before the workers leave
+	while( NbSubmitters.load() > 0 )
+	{
+		Thread::Yield();
+	}
+
+	{
+		std::lock_guard<std::mutex> SL_IdleMutex(IdleMutex);
+		IdleCondition.notify_all();
+	}
+
+	bool AllStopped = true;
+	for( size_t Index = 0; Index < Workers.size(); Index++ )
+	{
+		if ( Workers[Index]->StopThread( wait_ms ) == false )
+		{
+			AllStopped = false;
+		}
+	}
+	return AllStopped;
+}
+
+unsigned int ThreadPool::GetNumberOfWorkers() const
+{
+	return (unsigned int)Workers.size();
+}
+
+ThreadPool::Statistics ThreadPool::GetStatistics() const
+{
+	Statistics Stats;
+	const long long Pending = PendingTasks.load();
+
+	Stats.NbWorkers = (unsigned int)Workers.size();
+	Stats.QueuedTasks = Pending > 0 ? (unsigned long long)Pending : 0;
+	Stats.ExecutedTasks = ExecutedTasks.load();
+	Stats.Steals = Steals.load();
+	Stats.IdleTimeNs = IdleTimeNs.load();
+	return Stats;
+}
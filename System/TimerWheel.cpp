@@ -0,0 +1,330 @@
+/**
+ * @file System/TimerWheel.cpp
+ * @ingroup System
+ * @brief Implementation of TimerWheel class
+ */
+
+#include <System/TimerWheel.h>
+#include <System/SimpleException.h>
+#include <System/ThreadPool.h>
+
+#include <exception>
+#include <limits>
+
+using namespace Omiscid;
+
+TimerWheel::TimerWheel( unsigned int TickInMilliseconds /* = 1 */, ThreadPool * cExecutor /* = NULL */ )
+	: Origin(std::chrono::steady_clock::now()),
+	TickDuration(std::chrono::milliseconds(TickInMilliseconds > 0 ? TickInMilliseconds : 1)),
+	Executor(cExecutor)
+{
+	Stopping = false;
+	CurrentTick = 0;
+	WakeTick = 0;
+	LastId = 0;
+	for( unsigned int Level = 0; Level < NbLevels; Level++ )
+	{
+		for( unsigned int Slot = 0; Slot < NbSlots; Slot++ )
+		{
+			Slots[Level][Slot] = NULL;
+		}
+	}
+
+	SetName( "OmiscidTimers" );
+	StartThread();
+
+	// The thread must be running to be stopped
+	while( IsRunning() == false )
+	{
+		Thread::Usleep(100);
+	}
+}
+
+TimerWheel::~TimerWheel()
+{
+	// Thread::~Thread can not call our StopThread
+	StopThread();
+
+	for( std::unordered_map<TimerId, Timer*>::iterator It = Timers.begin(); It != Timers.end(); ++It )
+	{
+		delete It->second;
+	}
+}
+
+bool TimerWheel::StopThread( int wait_ms /* = DEFAULT_THREAD_DESTRUCTOR_TIMEOUT */, bool UNUSED /* = true */ )
+{
+	{
+		std::lock_guard<std::mutex> SL_WheelMutex(WheelMutex);
+		Stopping = true;
+		WheelCondition.notify_all();
+	}
+	return Thread::StopThread( wait_ms, UNUSED );
+}
+
+TimerWheel::TimerId TimerWheel::ScheduleOnce( unsigned int DelayInMilliseconds, std::function<void()> Callback )
+{
+	return Schedule( std::chrono::milliseconds(DelayInMilliseconds), 0, std::move(Callback) );
+}
+
+TimerWheel::TimerId TimerWheel::SchedulePeriodic( unsigned int PeriodInMilliseconds, std::function<void()> Callback, unsigned int FirstDelayInMilliseconds /* = 0 */ )
+{
+	if ( FirstDelayInMilliseconds == 0 )
+	{
+		FirstDelayInMilliseconds = PeriodInMilliseconds;
+	}
+	return Schedule( std::chrono::milliseconds(FirstDelayInMilliseconds), ToTicks(PeriodInMilliseconds), std::move(Callback) );
+}
+
+TimerWheel::TimerId TimerWheel::Schedule( std::chrono::steady_clock::duration Delay, unsigned long long Period, std::function<void()>&& Callback )
+{
+	if ( !Callback )
+	{
+		throw SimpleException( "TimerWheel::Schedule: empty callback" );
+	}
+
+	Timer * NewTimer = new OMISCID_TLM Timer;
+	NewTimer->Period = Period;
+	NewTimer->Callback = std::make_shared< std::function<void()> >( std::move(Callback) );
+
+	// Round up, a timer must not fire before its delay
+	const std::chrono::steady_clock::duration FromOrigin = std::chrono::steady_clock::now() - Origin + Delay;
+	const unsigned long long Expiry = (unsigned long long)((FromOrigin + TickDuration - std::chrono::steady_clock::duration(1)) / TickDuration);
+
+	std::lock_guard<std::mutex> SL_WheelMutex(WheelMutex);
+
+	NewTimer->Id = ++LastId;
+	NewTimer->Expiry = Expiry > CurrentTick ? Expiry : CurrentTick + 1;
+	Timers[NewTimer->Id] = NewTimer;
+	AddTimer( NewTimer );
+
+	if ( NewTimer->Expiry < WakeTick )
+	{
+		// The thread sleeps for too long
+		WheelCondition.notify_one();
+	}
+
+	return NewTimer->Id;
+}
+
+bool TimerWheel::Cancel( TimerId Id )
+{
+	std::lock_guard<std::mutex> SL_WheelMutex(WheelMutex);
+
+	std::unordered_map<TimerId, Timer*>::iterator It = Timers.find( Id );
+	if ( It == Timers.end() )
+	{
+		return false;
+	}
+
+	RemoveTimer( It->second );
+	delete It->second;
+	Timers.erase( It );
+
+	// The thread may wake up for nothing, no need to notify it
+	return true;
+}
+
+unsigned int TimerWheel::GetNumberOfTimers()
+{
+	std::lock_guard<std::mutex> SL_WheelMutex(WheelMutex);
+	return (unsigned int)Timers.size();
+}
+
+unsigned long long TimerWheel::GetCurrentTime() const
+{
+	return (unsigned long long)((std::chrono::steady_clock::now() - Origin) / TickDuration);
+}
+
+unsigned long long TimerWheel::ToTicks( unsigned int Milliseconds ) const
+{
+	const std::chrono::steady_clock::duration Duration = std::chrono::milliseconds(Milliseconds);
+	const unsigned long long Ticks = (unsigned long long)((Duration + TickDuration - std::chrono::steady_clock::duration(1)) / TickDuration);
+	return Ticks > 0 ? Ticks : 1;
+}
+
+void TimerWheel::AddTimer( Timer * ToAdd )
+{
+	// Timers expiring at CurrentTick go to the slot being processed (cascade)
+	const unsigned long long Delta = ToAdd->Expiry - CurrentTick;
+
+	unsigned int Level;
+	unsigned long long Expiry = ToAdd->Expiry;
+	if ( Delta < (1ULL << SlotBits) )
+	{
+		Level = 0;
+	}
+	else if ( Delta < (1ULL << (2*SlotBits)) )
+	{
+		Level = 1;
+	}
+	else if ( Delta < (1ULL << (3*SlotBits)) )
+	{
+		Level = 2;
+	}
+	else
+	{
+		Level = 3;
+		if ( Delta >= (1ULL << (4*SlotBits)) )
+		{
+			// Beyond the range of the wheel, cascades will put it back at the right place
+			Expiry = CurrentTick + (1ULL << (4*SlotBits)) - 1;
+		}
+	}
+
+	Timer *& Head = Slots[Level][(Expiry >> (Level*SlotBits)) & SlotMask];
+	ToAdd->Next = Head;
+	ToAdd->pPrevious = &Head;
+	if ( Head != NULL )
+	{
+		Head->pPrevious = &ToAdd->Next;
+	}
+	Head = ToAdd;
+}
+
+void TimerWheel::RemoveTimer( Timer * ToRemove )
+{
+	*ToRemove->pPrevious = ToRemove->Next;
+	if ( ToRemove->Next != NULL )
+	{
+		ToRemove->Next->pPrevious = ToRemove->pPrevious;
+	}
+}
+
+void TimerWheel::Cascade( unsigned int Level, unsigned int Slot )
+{
+	Timer * ToMove = Slots[Level][Slot];
+	Slots[Level][Slot] = NULL;
+
+	while( ToMove != NULL )
+	{
+		Timer * NextToMove = ToMove->Next;
+		AddTimer( ToMove );
+		ToMove = NextToMove;
+	}
+}
+
+void TimerWheel::Tick( unsigned long long Now, std::vector< std::shared_ptr< std::function<void()> > >& Due )
+{
+	CurrentTick++;
+
+	// When a level has turned, bring down the timers of the next slot of the upper level
+	for( unsigned int Level = 1; Level < NbLevels; Level++ )
+	{
+		if ( ((CurrentTick >> ((Level-1)*SlotBits)) & SlotMask) != 0 )
+		{
+			break;
+		}
+		Cascade( Level, (unsigned int)((CurrentTick >> (Level*SlotBits)) & SlotMask) );
+	}
+
+	Timer * Expired = Slots[0][CurrentTick & SlotMask];
+	Slots[0][CurrentTick & SlotMask] = NULL;
+
+	while( Expired != NULL )
+	{
+		Timer * NextExpired = Expired->Next;
+
+		Due.push_back( Expired->Callback );
+		if ( Expired->Period != 0 )
+		{
+			// Keep the phase of the timer, skip the calls missed up to now
+			Expired->Expiry += Expired->Period;
+			if ( Expired->Expiry <= Now )
+			{
+				Expired->Expiry += ((Now - Expired->Expiry)/Expired->Period + 1) * Expired->Period;
+			}
+			AddTimer( Expired );
+		}
+		else
+		{
+			Timers.erase( Expired->Id );
+			delete Expired;
+		}
+
+		Expired = NextExpired;
+	}
+}
+
+unsigned long long TimerWheel::GetNextWakeTick() const
+{
+	unsigned long long NextTick = CurrentTick + 1;
+	while( (NextTick & SlotMask) != 0 && Slots[0][NextTick & SlotMask] == NULL )
+	{
+		NextTick++;
+	}
+	return NextTick;
+}
+
+void TimerWheel::RunCallbacks( std::vector< std::shared_ptr< std::function<void()> > >& Due )
+{
+	for( size_t i = 0; i < Due.size(); i++ )
+	{
+		if ( Executor != NULL )
+		{
+			try
+			{
+				std::shared_ptr< std::function<void()> > Callback = Due[i];
+				Executor->Execute( [Callback]() { (*Callback)(); } );
+				continue;
+			}
+			catch( SimpleException& )
+			{
+				// Executor stopped, call it here
+			}
+		}
+
+		try
+		{
+			(*Due[i])();
+		}
+		catch( Omiscid::SimpleException &e )
+		{
+			OmiscidError( "TimerWheel: Omiscid::SimpleException in callback: %s\n", e.msg.GetStr() );
+		}
+		catch( std::exception &e )
+		{
+			OmiscidError( "TimerWheel: std::exception in callback: %s\n", e.what() );
+		}
+		catch( ... )
+		{
+			OmiscidError( "TimerWheel: Unknown exception in callback\n" );
+		}
+	}
+	Due.clear();
+}
+
+void FUNCTION_CALL_TYPE TimerWheel::Run()
+{
+	std::vector< std::shared_ptr< std::function<void()> > > Due;
+
+	std::unique_lock<std::mutex> SL_WheelMutex(WheelMutex);
+	while( Stopping == false && StopPending() == false )
+	{
+		const unsigned long long Now = GetCurrentTime();
+		while( CurrentTick < Now )
+		{
+			Tick( Now, Due );
+		}
+
+		if ( Due.empty() == false )
+		{
+			// Callbacks can schedule or cancel timers
+			SL_WheelMutex.unlock();
+			RunCallbacks( Due );
+			SL_WheelMutex.lock();
+			continue;
+		}
+
+		if ( Timers.empty() )
+		{
+			WakeTick = std::numeric_limits<unsigned long long>::max();
+			WheelCondition.wait( SL_WheelMutex );
+		}
+		else
+		{
+			WakeTick = GetNextWakeTick();
+			WheelCondition.wait_until( SL_WheelMutex, Origin + TickDuration*WakeTick );
+		}
+		WakeTick = 0;
+	}
+}